@@ -0,0 +1,257 @@
+#include "asyncdatabase.h"
+#include "database.h"
+#include "sqlitebackend.h"
+#include <QtConcurrent>
+#include <QStringList>
+#include <QDebug>
+
+static QString idList(const QList<int> &ids)
+{
+    QStringList values;
+    values.reserve(ids.size());
+    for (int id : ids) {
+        values.append(QString::number(id));
+    }
+    return values.join(',');
+}
+
+AsyncDatabase::AsyncDatabase(QObject *parent)
+    : QObject(parent)
+    , m_writeSerial(0)
+{
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+}
+
+AsyncDatabase::~AsyncDatabase()
+{
+    cancelAll();
+    // 连接只能在创建它的线程上关闭；线程池只有一个线程，关闭连接时之前的请求都已执行完
+    QFuture<void> closed = QtConcurrent::run(&m_pool, [this]() { closeConnection(); });
+    closed.waitForFinished();
+    m_pool.waitForDone();
+}
+
+template <typename T>
+QFuture<T> AsyncDatabase::read(ReadKind kind, const QString &signature, const std::function<T(StorageBackend *)> &work)
+{
+    auto it = m_reads.find(kind);
+    if (it != m_reads.end() && !it->future.isFinished() && !it->future.isCanceled()) {
+        // 提交之后没有写请求时，相同的请求结果也相同
+        if (it->signature == signature && it->writeSerial == m_writeSerial) {
+            return QFutureInterface<T>(it->future).future();
+        }
+        // 被新请求取代；统计读取的结果各有用途（标签栏记录数、预读、表单选择对话框），只合并不取代，
+        // 旧请求照常完成，只是不再参与合并
+        if (kind != StatsRead) {
+            it->future.cancel();
+        }
+    }
+
+    QFutureInterface<T> future;
+    future.reportStarted();
+    PendingRead pending;
+    pending.signature = signature;
+    pending.writeSerial = m_writeSerial;
+    pending.future = future;
+    m_reads.insert(kind, pending);
+
+    QFuture<void> task = QtConcurrent::run(&m_pool, [this, future, work]() mutable {
+        // 排队期间被取代的请求不再执行，执行期间被取代的结果直接丢弃
+        if (!future.isCanceled()) {
+            StorageBackend *storage = backend();
+            T result = storage ? work(storage) : T();
+            if (!future.isCanceled()) {
+                future.reportResult(result);
+            }
+        }
+        future.reportFinished();
+    });
+    Q_UNUSED(task);
+    return future.future();
+}
+
+template <typename T>
+QFuture<T> AsyncDatabase::write(const std::function<T(StorageBackend *)> &work, const T &failed)
+{
+    ++m_writeSerial;
+
+    QFutureInterface<T> future;
+    future.reportStarted();
+    QFuture<void> task = QtConcurrent::run(&m_pool, [this, future, work, failed]() mutable {
+        StorageBackend *storage = backend();
+        future.reportResult(storage ? work(storage) : failed);
+        future.reportFinished();
+    });
+    Q_UNUSED(task);
+    return future.future();
+}
+
+QFuture<QList<PasswordEntry>> AsyncDatabase::getPasswordsAfter(int form_id, int afterId, int limit)
+{
+    return read<QList<PasswordEntry>>(PageRead, QString("%1|%2|%3").arg(form_id).arg(afterId).arg(limit),
+                                      [form_id, afterId, limit](StorageBackend *storage) {
+        return storage->getPasswordsAfter(form_id, afterId, limit);
+    });
+}
+
+QFuture<QList<PasswordEntry>> AsyncDatabase::searchPasswords(const QString &keyword, const QList<int> &form_ids)
+{
+    return read<QList<PasswordEntry>>(SearchRead, idList(form_ids) + "|" + keyword,
+                                      [keyword, form_ids](StorageBackend *storage) {
+        return storage->searchPasswords(keyword, form_ids);
+    });
+}
+
+QFuture<QList<PasswordEntry>> AsyncDatabase::getPasswordsByIds(const QList<int> &ids)
+{
+    return read<QList<PasswordEntry>>(IdsRead, idList(ids), [ids](StorageBackend *storage) {
+        return storage->getPasswordsByIds(ids);
+    });
+}
+
+QFuture<QHash<int, FormStats>> AsyncDatabase::getFormStats()
+{
+    return read<QHash<int, FormStats>>(StatsRead, QString(), [](StorageBackend *storage) {
+        return storage->getFormStats();
+    });
+}
+
+void AsyncDatabase::cancel(ReadKind kind)
+{
+    auto it = m_reads.find(kind);
+    if (it != m_reads.end()) {
+        it->future.cancel();
+        m_reads.erase(it);
+    }
+}
+
+void AsyncDatabase::cancelAll()
+{
+    for (auto it = m_reads.begin(); it != m_reads.end(); ++it) {
+        it->future.cancel();
+    }
+    m_reads.clear();
+}
+
+QFuture<FormEntry> AsyncDatabase::addForm(const QString &name)
+{
+    FormEntry failed;
+    failed.id = -1;
+    return write<FormEntry>([name, failed](StorageBackend *storage) {
+        if (!storage->addForm(name)) {
+            return failed;
+        }
+        Database::instance().invalidateFormCache();
+        // 新表单的ID也在数据库线程上读取，界面线程不需要再查询
+        for (const auto &form : storage->getAllForms()) {
+            if (form.name == name) {
+                return form;
+            }
+        }
+        return failed;
+    }, failed);
+}
+
+QFuture<bool> AsyncDatabase::updateForm(int id, const QString &name)
+{
+    return write<bool>([id, name](StorageBackend *storage) {
+        if (!storage->updateForm(id, name)) {
+            return false;
+        }
+        Database::instance().invalidateFormCache();
+        return true;
+    }, false);
+}
+
+QFuture<bool> AsyncDatabase::deleteForm(int id)
+{
+    return write<bool>([id](StorageBackend *storage) {
+        // Database::getAllForms缓存未命中时读取默认连接，不能在数据库线程上调用，直接用这里的引擎检查
+        if (storage->getAllForms().size() <= 1) {
+            qDebug() << "不能删除最后一个表单";
+            return false;
+        }
+        if (!storage->deleteForm(id)) {
+            return false;
+        }
+        Database::instance().invalidateFormCache();
+        return true;
+    }, false);
+}
+
+QFuture<bool> AsyncDatabase::addPassword(int form_id, const QString &website, const QString &username,
+                                         const QString &account, const QString &password, const QString &notes)
+{
+    return write<bool>([=](StorageBackend *storage) {
+        return storage->addPassword(form_id, website, username, account, password, notes);
+    }, false);
+}
+
+QFuture<bool> AsyncDatabase::updatePassword(int id, int form_id, const QString &website,
+                                            const QString &username, const QString &account,
+                                            const QString &password, const QString &notes)
+{
+    return write<bool>([=](StorageBackend *storage) {
+        return storage->updatePassword(id, form_id, website, username, account, password, notes);
+    }, false);
+}
+
+QFuture<AsyncDatabase::FieldUpdate> AsyncDatabase::updateField(int id, StorageBackend::EntryField field,
+                                                               const QString &value)
+{
+    return write<FieldUpdate>([id, field, value](StorageBackend *storage) {
+        FieldUpdate result;
+        result.ok = storage->updateField(id, field, value, &result.conflict);
+        return result;
+    }, FieldUpdate());
+}
+
+QFuture<bool> AsyncDatabase::deletePassword(int id)
+{
+    return write<bool>([id](StorageBackend *storage) {
+        return storage->deletePassword(id);
+    }, false);
+}
+
+QFuture<int> AsyncDatabase::deletePasswords(const QList<int> &ids)
+{
+    return write<int>([ids](StorageBackend *storage) {
+        return storage->deletePasswords(ids);
+    }, -1);
+}
+
+QFuture<AsyncDatabase::TransferResult> AsyncDatabase::transferPasswords(const QList<int> &ids, int targetFormId,
+                                                                        StorageBackend::ConflictPolicy policy,
+                                                                        bool copy)
+{
+    return write<TransferResult>([=](StorageBackend *storage) {
+        TransferResult result;
+        result.count = storage->transferPasswords(ids, targetFormId, policy, copy, &result.conflictCount);
+        return result;
+    }, TransferResult());
+}
+
+StorageBackend *AsyncDatabase::backend()
+{
+    Database &database = Database::instance();
+    if (!database.isPersistent()) {
+        return database.storage();  // 内存引擎的每个方法都加锁，可以在任何线程上使用
+    }
+
+    if (!m_sqlite) {
+        m_connectionName = database.openThreadConnection("async");
+        if (m_connectionName.isEmpty()) {
+            return nullptr;
+        }
+        m_sqlite.reset(new SqliteBackend(QSqlDatabase::database(m_connectionName, false)));
+    }
+    return m_sqlite.data();
+}
+
+void AsyncDatabase::closeConnection()
+{
+    m_sqlite.reset();  // 先释放引擎持有的连接对象
+    Database::closeThreadConnection(m_connectionName);
+    m_connectionName.clear();
+}
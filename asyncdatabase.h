@@ -0,0 +1,107 @@
+#ifndef ASYNCDATABASE_H
+#define ASYNCDATABASE_H
+
+#include <QObject>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QScopedPointer>
+#include <QHash>
+#include <QString>
+#include <functional>
+#include "storagebackend.h"
+
+class SqliteBackend;
+
+// Database的异步接口：请求按提交顺序在专用的数据库线程上执行，结果通过QFuture返回，界面线程不等待SQLite
+// 数据库线程使用自己的SQLite连接（内存密码库直接使用Database当前的内存引擎），表结构需要先由Database::init()创建
+// 读请求按用途分类：同类中参数相同、还没完成、且之后没有提交过写请求的请求合并为同一个future；
+// 参数不同的新请求取代旧请求，旧请求的future被取消，还没开始的不再执行，正在执行的结果被丢弃；
+// 统计读取（StatsRead）例外：只合并，不取代，每个调用者都会得到结果
+// 写请求不会被合并或取消；修改表单后使Database的表单缓存失效
+class AsyncDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ReadKind { PageRead, SearchRead, IdsRead, StatsRead };
+
+    struct FieldUpdate {
+        bool ok = false;
+        bool conflict = false;  // 与同表单中已有记录的网站、用户名和账号组合冲突
+    };
+
+    struct TransferResult {
+        int count = -1;  // 移动/复制的条数，失败为-1（全部回滚）
+        int conflictCount = 0;
+    };
+
+    explicit AsyncDatabase(QObject *parent = nullptr);
+    ~AsyncDatabase();  // 取消尚未开始的读请求，等待其余请求执行完后关闭数据库线程的连接
+
+    // 读请求
+    QFuture<QList<PasswordEntry>> getPasswordsAfter(int form_id, int afterId, int limit);
+    QFuture<QList<PasswordEntry>> searchPasswords(const QString &keyword, const QList<int> &form_ids = QList<int>());
+    QFuture<QList<PasswordEntry>> getPasswordsByIds(const QList<int> &ids);
+    QFuture<QHash<int, FormStats>> getFormStats();
+    void cancel(ReadKind kind);  // 取消这一类尚未完成的读请求
+    void cancelAll();
+
+    // 写请求，含义与Database的同名方法相同
+    QFuture<FormEntry> addForm(const QString &name);  // 结果为新建的表单，失败时id为-1
+    QFuture<bool> updateForm(int id, const QString &name);
+    QFuture<bool> deleteForm(int id);  // 不能删除最后一个表单
+    QFuture<bool> addPassword(int form_id, const QString &website, const QString &username,
+                              const QString &account, const QString &password, const QString &notes);
+    QFuture<bool> updatePassword(int id, int form_id, const QString &website,
+                                 const QString &username, const QString &account,
+                                 const QString &password, const QString &notes);
+    QFuture<FieldUpdate> updateField(int id, StorageBackend::EntryField field, const QString &value);
+    QFuture<bool> deletePassword(int id);
+    QFuture<int> deletePasswords(const QList<int> &ids);
+    QFuture<TransferResult> transferPasswords(const QList<int> &ids, int targetFormId,
+                                              StorageBackend::ConflictPolicy policy, bool copy);
+
+    // 请求完成后在context所在的线程上调用handler(结果)；请求被取消（被新请求取代）或context已销毁时不调用
+    template <typename T, typename Handler>
+    static void onFinished(const QFuture<T> &future, QObject *context, Handler handler);
+
+private:
+    struct PendingRead {
+        QString signature;  // 请求参数，相同时合并
+        int writeSerial;    // 提交时的写请求序号，之后有写请求时不再合并
+        QFutureInterfaceBase future;
+    };
+
+    template <typename T>
+    QFuture<T> read(ReadKind kind, const QString &signature, const std::function<T(StorageBackend *)> &work);
+    template <typename T>
+    QFuture<T> write(const std::function<T(StorageBackend *)> &work, const T &failed);
+
+    StorageBackend *backend();  // 只在数据库线程上调用
+    void closeConnection();
+
+    QThreadPool m_pool;  // 只有一个线程，并且不会过期，数据库连接始终属于同一个线程
+    QHash<int, PendingRead> m_reads;  // 只在界面线程访问
+    int m_writeSerial;
+
+    // 以下只在数据库线程上访问
+    QString m_connectionName;
+    QScopedPointer<SqliteBackend> m_sqlite;
+};
+
+template <typename T, typename Handler>
+void AsyncDatabase::onFinished(const QFuture<T> &future, QObject *context, Handler handler)
+{
+    QFutureWatcher<T> *watcher = new QFutureWatcher<T>(context);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, context, [watcher, handler]() {
+        watcher->deleteLater();
+        if (!watcher->isCanceled() && watcher->future().resultCount() > 0) {
+            handler(watcher->result());
+        }
+    });
+    watcher->setFuture(future);
+}
+
+#endif // ASYNCDATABASE_H
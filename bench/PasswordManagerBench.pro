@@ -0,0 +1,23 @@
+# 性能基准测试：Database、Encryption和CSV解析在1k/100k/1M条记录下的耗时
+# 运行：./PasswordManagerBench -o results.csv,csv（或 -o results.xml,xml），结果可以跨提交比较
+# 环境变量 PM_BENCH_ROWS=1000,100000 调整数据量，PM_BENCH_DIR 指定测试库目录以便复用
+# 用 qmake CONFIG+=system_sqlite 构建时，*QtSql 项与对应项的差值即SQLite C API读取路径节省的时间
+QT += core sql concurrent testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = PasswordManagerBench
+TEMPLATE = app
+
+include(../core.pri)
+
+INCLUDEPATH += ../tools
+
+SOURCES += \
+    benchmark.cpp \
+    ../tools/vaultgenerator.cpp
+
+HEADERS += \
+    ../tools/vaultgenerator.h
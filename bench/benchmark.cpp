@@ -0,0 +1,353 @@
+#include <QtTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include "database.h"
+#include "encryption.h"
+#include "csvutils.h"
+#include "vaultgenerator.h"
+#include "memorybackend.h"
+
+// Database、Encryption和CSV解析热点路径的基准测试
+// 每个测试按记录数（默认1k、100k、1M）分别运行，测试库在首次用到时生成并复用
+// 结果用QtTest自带的输出格式保存，便于跨提交比较：
+//   ./PasswordManagerBench -o results.csv,csv
+//   ./PasswordManagerBench -o results.xml,xml
+class PasswordManagerBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void searchPasswords_data() { addRowCounts(); }
+    void searchPasswords();
+    void getAllPasswords_data() { addRowCounts(); }
+    void getAllPasswords();
+    void getFormPasswords_data() { addRowCounts(); }
+    void getFormPasswords();
+    // 与上面两项相同，但强制走QSqlQuery路径，用来对比SQLite C API读取路径（PM_HAVE_SQLITE3_API）
+    void searchPasswordsQtSql_data() { addRowCounts(); }
+    void searchPasswordsQtSql();
+    void getAllPasswordsQtSql_data() { addRowCounts(); }
+    void getAllPasswordsQtSql();
+    // 同样的数据载入内存存储引擎后的耗时，不含磁盘I/O和SQL
+    void searchPasswordsMemory_data() { addRowCounts(); }
+    void searchPasswordsMemory();
+    void getAllPasswordsMemory_data() { addRowCounts(); }
+    void getAllPasswordsMemory();
+    void addPasswordMemory_data() { addRowCounts(); }
+    void addPasswordMemory();
+    void addPassword_data() { addRowCounts(); }
+    void addPassword();
+    void decrypt_data() { addRowCounts(); }
+    void decrypt();
+    void parseCSVLine_data() { addRowCounts(); }
+    void parseCSVLine();
+
+private:
+    void addRowCounts();
+    bool useVault(int rows);
+    MemoryBackend *useMemoryVault(int rows);
+    bool generateVault(int rows);
+    static QString csvLine(int index);
+
+    QList<int> m_rowCounts;
+    QTemporaryDir m_tempDir;
+    QString m_vaultDir;
+    int m_currentRows;  // 当前默认连接打开的测试库记录数
+    QScopedPointer<MemoryBackend> m_memory;  // 载入内存的测试库，同一时间只保留一份
+    int m_memoryRows;
+};
+
+static const int FORM_COUNT = 20;
+
+// 基准测试期间丢弃调试输出：Encryption等每次调用都会qDebug，格式化开销仍计入耗时，只是不刷屏
+static void quietMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    Q_UNUSED(context);
+    if (type != QtDebugMsg && type != QtInfoMsg) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+    }
+}
+
+void PasswordManagerBench::initTestCase()
+{
+    qInfo() << "读取路径:" << (Database::nativeReadsEnabled() ? "SQLite C API" : "QSqlQuery");
+    qInstallMessageHandler(quietMessageHandler);
+    m_currentRows = -1;
+    m_memoryRows = -1;
+
+    // PM_BENCH_ROWS=1000,100000 调整数据量；PM_BENCH_DIR 指定目录后生成的测试库可以跨次运行复用
+    QString rows = qEnvironmentVariable("PM_BENCH_ROWS", "1000,100000,1000000");
+    for (const QString &value : rows.split(',', Qt::SkipEmptyParts)) {
+        int count = value.trimmed().toInt();
+        if (count > 0) {
+            m_rowCounts.append(count);
+        }
+    }
+    QVERIFY(!m_rowCounts.isEmpty());
+
+    m_vaultDir = qEnvironmentVariable("PM_BENCH_DIR");
+    if (m_vaultDir.isEmpty()) {
+        QVERIFY(m_tempDir.isValid());
+        m_vaultDir = m_tempDir.path();
+    }
+    QDir().mkpath(m_vaultDir);
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(":memory:");
+    QVERIFY(db.open());
+}
+
+void PasswordManagerBench::cleanupTestCase()
+{
+    m_memory.reset();
+    qInstallMessageHandler(nullptr);
+}
+
+void PasswordManagerBench::addRowCounts()
+{
+    QTest::addColumn<int>("rows");
+    for (int rows : m_rowCounts) {
+        QTest::newRow(QByteArray::number(rows).constData()) << rows;
+    }
+}
+
+// 切换默认连接（Database单例使用的连接）到对应记录数的测试库
+bool PasswordManagerBench::useVault(int rows)
+{
+    if (rows == m_currentRows) {
+        return true;
+    }
+
+    QString path = QString("%1/bench_%2.db").arg(m_vaultDir).arg(rows);
+    QSqlDatabase db = QSqlDatabase::database();
+    db.close();
+    db.setDatabaseName(path);
+    if (!db.open() || !Database::instance().init()) {
+        return false;
+    }
+
+    if (Database::instance().countPasswords() != rows) {
+        db.close();
+        QFile::remove(path);
+        if (!db.open() || !Database::instance().init() || !generateVault(rows)) {
+            return false;
+        }
+    }
+
+    m_currentRows = rows;
+    return true;
+}
+
+// 把对应记录数的测试库载入内存存储引擎，数据与SQLite测试库完全相同
+MemoryBackend *PasswordManagerBench::useMemoryVault(int rows)
+{
+    if (rows == m_memoryRows) {
+        return m_memory.data();
+    }
+
+    m_memory.reset();
+    m_memoryRows = -1;
+    if (!useVault(rows)) {
+        return nullptr;
+    }
+
+    m_memory.reset(new MemoryBackend);
+    if (!m_memory->loadFrom(*Database::instance().storage())) {
+        m_memory.reset();
+        return nullptr;
+    }
+    m_memoryRows = rows;
+    return m_memory.data();
+}
+
+// 用合成密码库生成器和固定种子生成测试库，保证不同提交之间的数据完全相同
+bool PasswordManagerBench::generateVault(int rows)
+{
+    VaultGeneratorOptions options = VaultGenerator::defaultOptions(rows);
+    options.forms = FORM_COUNT;
+    options.seed = 20240601;
+
+    QString error;
+    if (!VaultGenerator(options).generate(QSqlDatabase::database(), VaultGenerator::ProgressCallback(), &error)) {
+        qWarning() << "生成测试库失败:" << error;
+        return false;
+    }
+    Database::instance().invalidateFormCache();  // 生成器直接重写了forms表
+    return true;
+}
+
+QString PasswordManagerBench::csvLine(int index)
+{
+    return QString("site%1.example.com,user%1,\"account%1@example.com\",\"P@ss,\"\"%1\"\"\",备注 %1")
+        .arg(index);
+}
+
+void PasswordManagerBench::searchPasswords()
+{
+    QFETCH(int, rows);
+    QVERIFY(useVault(rows));
+
+    QList<PasswordEntry> result;
+    QBENCHMARK {
+        result = Database::instance().searchPasswords("github");
+    }
+    QVERIFY(!result.isEmpty());
+}
+
+void PasswordManagerBench::getAllPasswords()
+{
+    QFETCH(int, rows);
+    QVERIFY(useVault(rows));
+
+    QList<PasswordEntry> result;
+    QBENCHMARK {
+        result = Database::instance().getAllPasswords();
+    }
+    QCOMPARE(result.size(), rows);
+}
+
+void PasswordManagerBench::getFormPasswords()
+{
+    QFETCH(int, rows);
+    QVERIFY(useVault(rows));
+
+    QList<PasswordEntry> result;
+    QBENCHMARK {
+        result = Database::instance().getAllPasswords(1);
+    }
+    QVERIFY(!result.isEmpty());
+}
+
+void PasswordManagerBench::searchPasswordsQtSql()
+{
+    QFETCH(int, rows);
+    QVERIFY(useVault(rows));
+
+    Database::setNativeReads(false);
+    QList<PasswordEntry> result;
+    QBENCHMARK {
+        result = Database::instance().searchPasswords("github");
+    }
+    Database::setNativeReads(true);
+    QVERIFY(!result.isEmpty());
+}
+
+void PasswordManagerBench::getAllPasswordsQtSql()
+{
+    QFETCH(int, rows);
+    QVERIFY(useVault(rows));
+
+    Database::setNativeReads(false);
+    QList<PasswordEntry> result;
+    QBENCHMARK {
+        result = Database::instance().getAllPasswords();
+    }
+    Database::setNativeReads(true);
+    QCOMPARE(result.size(), rows);
+}
+
+void PasswordManagerBench::searchPasswordsMemory()
+{
+    QFETCH(int, rows);
+    MemoryBackend *memory = useMemoryVault(rows);
+    QVERIFY(memory);
+
+    QList<PasswordEntry> result;
+    QBENCHMARK {
+        result = memory->searchPasswords("github");
+    }
+    QVERIFY(!result.isEmpty());
+}
+
+void PasswordManagerBench::getAllPasswordsMemory()
+{
+    QFETCH(int, rows);
+    MemoryBackend *memory = useMemoryVault(rows);
+    QVERIFY(memory);
+
+    QList<PasswordEntry> result;
+    QBENCHMARK {
+        result = memory->getAllPasswords();
+    }
+    QCOMPARE(result.size(), rows);
+}
+
+void PasswordManagerBench::addPasswordMemory()
+{
+    QFETCH(int, rows);
+    MemoryBackend *memory = useMemoryVault(rows);
+    QVERIFY(memory);
+
+    // 与SQLite的addPassword相同：在事务中插入，结束后回滚
+    Database::Transaction transaction(memory);
+    QVERIFY(transaction.isActive());
+    int counter = 0;
+    QBENCHMARK {
+        memory->addPassword(1, "bench.example.com", QString("bench%1").arg(counter++),
+                            Encryption::encrypt("account"), Encryption::encrypt("password"), "");
+    }
+    transaction.rollback();
+}
+
+void PasswordManagerBench::addPassword()
+{
+    QFETCH(int, rows);
+    QVERIFY(useVault(rows));
+
+    // 在事务中插入，结束后回滚，测试库保持不变
+    Database::Transaction transaction;
+    QVERIFY(transaction.isActive());
+    int counter = 0;
+    QBENCHMARK {
+        Database::instance().addPassword(1, "bench.example.com", QString("bench%1").arg(counter++),
+                                         Encryption::encrypt("account"), Encryption::encrypt("password"), "");
+    }
+    transaction.rollback();
+}
+
+void PasswordManagerBench::decrypt()
+{
+    QFETCH(int, rows);
+
+    QStringList values;
+    values.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        values.append(Encryption::encrypt(QString("account%1@example.com").arg(i)));
+    }
+
+    int length = 0;
+    QBENCHMARK {
+        for (const QString &value : values) {
+            length += Encryption::decrypt(value).size();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+void PasswordManagerBench::parseCSVLine()
+{
+    QFETCH(int, rows);
+
+    QStringList lines;
+    lines.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        lines.append(csvLine(i));
+    }
+
+    int fieldCount = 0;
+    QBENCHMARK {
+        for (const QString &line : lines) {
+            fieldCount += ::parseCSVLine(line).size();
+        }
+    }
+    QVERIFY(fieldCount > 0);
+}
+
+QTEST_GUILESS_MAIN(PasswordManagerBench)
+
+#include "benchmark.moc"
@@ -0,0 +1,271 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QTextStream>
+#include <QDebug>
+#include "database.h"
+#include "encryption.h"
+#include "importexportworker.h"
+
+// 退出码
+enum ExitCode {
+    ExitSuccess = 0,
+    ExitFailure = 1,        // 操作失败
+    ExitUsage = 2,          // 参数错误
+    ExitDatabaseError = 3   // 数据库无法打开
+};
+
+static QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+static QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+// 命令行工具默认不输出调试信息，--verbose时保留
+static bool g_verbose = false;
+
+static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    Q_UNUSED(context);
+    if (type == QtDebugMsg && !g_verbose) {
+        return;
+    }
+    err() << message << Qt::endl;
+}
+
+// 表单参数可以是ID或名称，找不到时返回-2
+static int resolveForm(const QString &value)
+{
+    if (value.isEmpty()) {
+        return -1;
+    }
+    bool isNumber;
+    int id = value.toInt(&isNumber);
+    for (const auto &form : Database::instance().getAllForms()) {
+        if ((isNumber && form.id == id) || form.name == value) {
+            return form.id;
+        }
+    }
+    return -2;
+}
+
+// 用工作器在当前线程同步执行导入/导出，进度输出到stderr
+static bool runWorker(ImportExportWorker &worker, bool quiet)
+{
+    bool success = false;
+    QObject::connect(&worker, &ImportExportWorker::progressChanged, [quiet](int percent, const QString &message) {
+        if (!quiet) {
+            err() << QString("\r[%1%] %2").arg(percent, 3).arg(message) << Qt::flush;
+        }
+    });
+    QObject::connect(&worker, &ImportExportWorker::errorOccurred, [](const QString &error) {
+        err() << Qt::endl << "错误: " << error << Qt::endl;
+    });
+    QObject::connect(&worker, &ImportExportWorker::operationFinished, [&success, quiet](bool ok, const QString &message) {
+        success = ok;
+        if (!quiet) {
+            err() << Qt::endl;
+        }
+        out() << message << Qt::endl;
+    });
+
+    worker.startOperation();
+    return success;
+}
+
+static int runImport(const QStringList &args, const QCommandLineParser &parser, bool quiet)
+{
+    if (args.size() != 1) {
+        err() << "用法: pm-cli import <文件> [--form <ID或名称>] [--passphrase-env <变量名>]" << Qt::endl;
+        return ExitUsage;
+    }
+
+    int formId = resolveForm(parser.value("form"));
+    if (formId == -2) {
+        err() << "找不到表单: " << parser.value("form") << Qt::endl;
+        return ExitUsage;
+    }
+
+    ImportExportWorker worker;
+    worker.setOperationType(ImportExportWorker::ImportOperation);
+    worker.setFilename(args.first());
+    worker.setFormId(formId);
+    if (parser.isSet("passphrase-env")) {
+        worker.setPassphrase(qEnvironmentVariable(parser.value("passphrase-env").toLocal8Bit().constData()));
+    }
+    return runWorker(worker, quiet) ? ExitSuccess : ExitFailure;
+}
+
+static int runExport(const QStringList &args, const QCommandLineParser &parser, bool quiet)
+{
+    if (args.size() != 1) {
+        err() << "用法: pm-cli export <文件> [--form <ID或名称>] [--encrypted] [--passphrase-env <变量名>]" << Qt::endl;
+        return ExitUsage;
+    }
+
+    int formId = resolveForm(parser.value("form"));
+    if (formId == -2) {
+        err() << "找不到表单: " << parser.value("form") << Qt::endl;
+        return ExitUsage;
+    }
+
+    ImportExportWorker worker;
+    worker.setOperationType(ImportExportWorker::ExportOperation);
+    worker.setFilename(args.first());
+    worker.setFormId(formId);
+    worker.setExportEncrypted(parser.isSet("encrypted"));
+    if (parser.isSet("passphrase-env")) {
+        worker.setPassphrase(qEnvironmentVariable(parser.value("passphrase-env").toLocal8Bit().constData()));
+    }
+    return runWorker(worker, quiet) ? ExitSuccess : ExitFailure;
+}
+
+static int runSearch(const QStringList &args, const QCommandLineParser &parser)
+{
+    if (args.size() != 1) {
+        err() << "用法: pm-cli search <关键字> [--form <ID或名称>] [--show-secrets]" << Qt::endl;
+        return ExitUsage;
+    }
+
+    QList<int> formIds;
+    if (parser.isSet("form")) {
+        int formId = resolveForm(parser.value("form"));
+        if (formId < 0) {
+            err() << "找不到表单: " << parser.value("form") << Qt::endl;
+            return ExitUsage;
+        }
+        formIds.append(formId);
+    }
+
+    QHash<int, QString> formNames;
+    for (const auto &form : Database::instance().getAllForms()) {
+        formNames.insert(form.id, form.name);
+    }
+
+    // 以制表符分隔输出，便于脚本处理；密码默认不显示
+    bool showSecrets = parser.isSet("show-secrets");
+    auto entries = Database::instance().searchPasswords(args.first(), formIds);
+    out() << "id\tform\twebsite\tusername\taccount\tpassword" << Qt::endl;
+    for (const auto &entry : entries) {
+        out() << entry.id << '\t' << formNames.value(entry.form_id) << '\t' << entry.website << '\t'
+              << entry.username << '\t' << Encryption::decrypt(entry.account) << '\t'
+              << (showSecrets ? Encryption::decrypt(entry.password) : QString("******")) << Qt::endl;
+    }
+    err() << QString("共找到 %1 条记录").arg(entries.size()) << Qt::endl;
+    return ExitSuccess;
+}
+
+static int runStats(const QStringList &args)
+{
+    if (!args.isEmpty()) {
+        err() << "用法: pm-cli stats" << Qt::endl;
+        return ExitUsage;
+    }
+
+    // 每个表单的记录数来自触发器维护的form_stats，不逐个COUNT
+    auto forms = Database::instance().getAllForms();
+    auto stats = Database::instance().getFormStats();
+    out() << "form_id\tform\tpasswords\tlast_modified" << Qt::endl;
+    for (const auto &form : forms) {
+        out() << form.id << '\t' << form.name << '\t' << stats.value(form.id).entryCount << '\t'
+              << stats.value(form.id).lastModified << Qt::endl;
+    }
+    out() << "total\t" << forms.size() << " forms\t" << Database::instance().countPasswords() << Qt::endl;
+    out() << "database\t" << Database::instance().databasePath() << '\t'
+          << QFileInfo(Database::instance().databasePath()).size() << " bytes" << Qt::endl;
+    return ExitSuccess;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // 与图形界面程序相同，默认使用同一个数据库文件
+    app.setApplicationName("Password Manager");
+    app.setOrganizationName("QtCourse");
+    qInstallMessageHandler(messageHandler);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("密码管理器命令行工具\n\n"
+                                     "子命令:\n"
+                                     "  import <文件>    导入CSV/JSON Lines/KeePass XML/Bitwarden JSON（可压缩或加密）\n"
+                                     "  export <文件>    按扩展名导出CSV或JSON Lines（.gz/.zst压缩）\n"
+                                     "  search <关键字>  搜索记录\n"
+                                     "  stats            表单和记录数统计");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "子命令: import、export、search、stats");
+    parser.addOptions({
+        { "db", "数据库文件（默认与图形界面相同）", "FILE" },
+        { "form", "表单ID或名称", "FORM" },
+        { "encrypted", "导出保密版" },
+        { "passphrase-env", "从环境变量读取加密导出文件的口令", "NAME" },
+        { "show-secrets", "搜索结果中显示密码" },
+        { "timing", "在stderr输出各阶段耗时（毫秒）" },
+        { "quiet", "不输出进度" },
+        { "verbose", "输出调试信息" },
+    });
+    parser.process(app);
+
+    g_verbose = parser.isSet("verbose");
+    bool quiet = parser.isSet("quiet");
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        parser.showHelp(ExitUsage);
+    }
+    QString command = args.takeFirst();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 打开数据库：--db 指定文件，否则使用图形界面的默认位置
+    QString dbPath = parser.value("db");
+    if (dbPath.isEmpty()) {
+        dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dbPath);
+        dbPath += "/passwords.db";
+    }
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(dbPath);
+    if (!db.open() || !Database::instance().init()) {
+        err() << "无法打开数据库: " << dbPath << " " << db.lastError().text() << Qt::endl;
+        return ExitDatabaseError;
+    }
+    qint64 openTime = timer.nsecsElapsed();
+
+    int exitCode;
+    if (command == "import") {
+        exitCode = runImport(args, parser, quiet);
+    } else if (command == "export") {
+        exitCode = runExport(args, parser, quiet);
+    } else if (command == "search") {
+        exitCode = runSearch(args, parser);
+    } else if (command == "stats") {
+        exitCode = runStats(args);
+    } else {
+        err() << "未知的子命令: " << command << Qt::endl;
+        exitCode = ExitUsage;
+    }
+
+    if (parser.isSet("timing")) {
+        // 一行key=value，便于脚本收集
+        qint64 totalTime = timer.nsecsElapsed();
+        err() << QString("timing command=%1 open_ms=%2 operation_ms=%3 total_ms=%4 exit=%5")
+                     .arg(command)
+                     .arg(openTime / 1e6, 0, 'f', 3)
+                     .arg((totalTime - openTime) / 1e6, 0, 'f', 3)
+                     .arg(totalTime / 1e6, 0, 'f', 3)
+                     .arg(exitCode)
+              << Qt::endl;
+    }
+    return exitCode;
+}
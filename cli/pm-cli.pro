@@ -0,0 +1,15 @@
+# 命令行前端：不需要图形界面，在服务器上批量导入、导出、搜索和统计，并可输出各阶段耗时
+# 例：./pm-cli --db passwords.db --timing export all.csv.gz
+QT += core sql concurrent
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = pm-cli
+TEMPLATE = app
+
+include(../core.pri)
+
+SOURCES += \
+    main.cpp
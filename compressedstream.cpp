@@ -0,0 +1,523 @@
+#include "compressedstream.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QDebug>
+#include <memory>
+#ifdef PM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef PM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const int CHUNK_SIZE = 256 * 1024;  // 流水线中每个数据块的大小
+static const int MAX_QUEUED_CHUNKS = 8;    // 队列中最多缓存的数据块数
+static const int OUTPUT_SIZE = 64 * 1024;  // 单次压缩/解压的输出缓冲区大小
+
+// 压缩/解压编解码器的统一接口
+class StreamCodec
+{
+public:
+    virtual ~StreamCodec() {}
+    virtual bool init(bool compress) = 0;
+    // 处理一段输入并把结果追加到out；finish为true表示输入结束
+    virtual bool process(const QByteArray &in, QByteArray &out, bool finish) = 0;
+};
+
+#ifdef PM_HAVE_ZLIB
+// gzip格式，基于zlib的deflate/inflate
+class GzipCodec : public StreamCodec
+{
+public:
+    GzipCodec() : m_compress(false), m_initialized(false), m_inMember(false) {}
+
+    ~GzipCodec() override
+    {
+        if (m_initialized) {
+            if (m_compress) {
+                deflateEnd(&m_stream);
+            } else {
+                inflateEnd(&m_stream);
+            }
+        }
+    }
+
+    bool init(bool compress) override
+    {
+        m_compress = compress;
+        m_stream = z_stream();
+        int ret;
+        if (compress) {
+            // windowBits + 16 输出gzip头而不是zlib头
+            ret = deflateInit2(&m_stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        } else {
+            // windowBits + 32 自动识别gzip和zlib头
+            ret = inflateInit2(&m_stream, 15 + 32);
+        }
+        m_initialized = (ret == Z_OK);
+        return m_initialized;
+    }
+
+    bool process(const QByteArray &in, QByteArray &out, bool finish) override
+    {
+        return m_compress ? deflateChunk(in, out, finish) : inflateChunk(in, out, finish);
+    }
+
+private:
+    bool deflateChunk(const QByteArray &in, QByteArray &out, bool finish)
+    {
+        char buffer[OUTPUT_SIZE];
+        m_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.constData()));
+        m_stream.avail_in = static_cast<uInt>(in.size());
+
+        while (true) {
+            m_stream.next_out = reinterpret_cast<Bytef *>(buffer);
+            m_stream.avail_out = OUTPUT_SIZE;
+            int ret = deflate(&m_stream, finish ? Z_FINISH : Z_NO_FLUSH);
+            if (ret == Z_STREAM_ERROR) {
+                return false;
+            }
+            out.append(buffer, OUTPUT_SIZE - static_cast<int>(m_stream.avail_out));
+
+            if (finish) {
+                if (ret == Z_STREAM_END) {
+                    return true;
+                }
+            } else if (m_stream.avail_in == 0 && m_stream.avail_out != 0) {
+                return true;
+            }
+        }
+    }
+
+    bool inflateChunk(const QByteArray &in, QByteArray &out, bool finish)
+    {
+        char buffer[OUTPUT_SIZE];
+        m_stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.constData()));
+        m_stream.avail_in = static_cast<uInt>(in.size());
+
+        // 输出缓冲区写满时解压器内部可能还有数据，需要继续调用直到取完
+        bool outputFull = false;
+        while (m_stream.avail_in > 0 || outputFull) {
+            if (m_stream.avail_in > 0) {
+                m_inMember = true;
+            }
+            m_stream.next_out = reinterpret_cast<Bytef *>(buffer);
+            m_stream.avail_out = OUTPUT_SIZE;
+            int ret = inflate(&m_stream, Z_NO_FLUSH);
+            out.append(buffer, OUTPUT_SIZE - static_cast<int>(m_stream.avail_out));
+            outputFull = (m_stream.avail_out == 0);
+
+            if (ret == Z_STREAM_END) {
+                // gzip允许多个成员首尾相接（例如cat a.gz b.gz），重置后继续解压
+                m_inMember = false;
+                inflateReset(&m_stream);
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                return false;
+            }
+        }
+
+        // 输入结束时仍停留在某个成员中间，说明文件被截断
+        return !(finish && m_inMember);
+    }
+
+    z_stream m_stream;
+    bool m_compress;
+    bool m_initialized;
+    bool m_inMember;
+};
+#endif
+
+#ifdef PM_HAVE_ZSTD
+// zstd格式，基于libzstd的流式接口
+class ZstdCodec : public StreamCodec
+{
+public:
+    ZstdCodec() : m_cctx(nullptr), m_dctx(nullptr), m_lastResult(0) {}
+
+    ~ZstdCodec() override
+    {
+        ZSTD_freeCCtx(m_cctx);
+        ZSTD_freeDCtx(m_dctx);
+    }
+
+    bool init(bool compress) override
+    {
+        if (compress) {
+            m_cctx = ZSTD_createCCtx();
+            return m_cctx && !ZSTD_isError(ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_compressionLevel, 3));
+        }
+        m_dctx = ZSTD_createDCtx();
+        return m_dctx != nullptr;
+    }
+
+    bool process(const QByteArray &in, QByteArray &out, bool finish) override
+    {
+        char buffer[OUTPUT_SIZE];
+        ZSTD_inBuffer input = { in.constData(), static_cast<size_t>(in.size()), 0 };
+
+        if (m_cctx) {
+            ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+            while (true) {
+                ZSTD_outBuffer output = { buffer, OUTPUT_SIZE, 0 };
+                size_t remaining = ZSTD_compressStream2(m_cctx, &output, &input, mode);
+                if (ZSTD_isError(remaining)) {
+                    return false;
+                }
+                out.append(buffer, static_cast<int>(output.pos));
+                if (finish ? remaining == 0 : input.pos == input.size) {
+                    return true;
+                }
+            }
+        }
+
+        bool outputFull = false;
+        while (input.pos < input.size || outputFull) {
+            ZSTD_outBuffer output = { buffer, OUTPUT_SIZE, 0 };
+            m_lastResult = ZSTD_decompressStream(m_dctx, &output, &input);
+            if (ZSTD_isError(m_lastResult)) {
+                return false;
+            }
+            out.append(buffer, static_cast<int>(output.pos));
+            outputFull = (output.pos == output.size);
+        }
+
+        // 返回值不为0表示当前帧还未结束，输入结束时说明文件被截断
+        return !(finish && m_lastResult != 0);
+    }
+
+private:
+    ZSTD_CCtx *m_cctx;
+    ZSTD_DCtx *m_dctx;
+    size_t m_lastResult;
+};
+#endif
+
+static StreamCodec *createCodec(CompressedStream::Format format)
+{
+    switch (format) {
+#ifdef PM_HAVE_ZLIB
+    case CompressedStream::GzipFormat:
+        return new GzipCodec();
+#endif
+#ifdef PM_HAVE_ZSTD
+    case CompressedStream::ZstdFormat:
+        return new ZstdCodec();
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+CompressedStream::CompressedStream(const QString &filename, Format format, QObject *parent)
+    : QIODevice(parent)
+    , m_filename(filename)
+    , m_format(format)
+    , m_file(filename)
+    , m_pipeline(nullptr)
+    , m_producerDone(false)
+    , m_consumerDone(false)
+    , m_error(false)
+    , m_bufferPos(0)
+    , m_compressedSize(0)
+    , m_compressedPos(0)
+{
+}
+
+CompressedStream::~CompressedStream()
+{
+    if (isOpen()) {
+        close();
+    }
+}
+
+CompressedStream::Format CompressedStream::formatFromFileName(const QString &filename)
+{
+    QString lower = filename.toLower();
+    if (lower.endsWith(".gz")) {
+        return GzipFormat;
+    }
+    if (lower.endsWith(".zst")) {
+        return ZstdFormat;
+    }
+    return PlainFormat;
+}
+
+CompressedStream::Format CompressedStream::detectFormat(const QString &filename)
+{
+    QFile file(filename);
+    if (file.open(QIODevice::ReadOnly)) {
+        QByteArray magic = file.read(4);
+        if (magic.startsWith("\x1f\x8b")) {
+            return GzipFormat;
+        }
+        if (magic == QByteArray("\x28\xb5\x2f\xfd", 4)) {
+            return ZstdFormat;
+        }
+        return PlainFormat;
+    }
+    return formatFromFileName(filename);
+}
+
+bool CompressedStream::isFormatSupported(Format format)
+{
+    switch (format) {
+    case GzipFormat:
+#ifdef PM_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case ZstdFormat:
+#ifdef PM_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+bool CompressedStream::open(OpenMode mode)
+{
+    bool reading = mode.testFlag(QIODevice::ReadOnly);
+    bool writing = mode.testFlag(QIODevice::WriteOnly);
+    if (reading == writing) {
+        setErrorString("压缩流只支持只读或只写");
+        return false;
+    }
+
+    if (!isFormatSupported(m_format)) {
+        setErrorString("不支持的压缩格式（zstd需要在编译时启用）");
+        return false;
+    }
+
+    if (!m_file.open(reading ? QIODevice::ReadOnly : (QIODevice::WriteOnly | QIODevice::Truncate))) {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+
+    m_queue.clear();
+    m_producerDone = false;
+    m_consumerDone = false;
+    m_error = false;
+    m_pipelineError.clear();
+    m_buffer.clear();
+    m_bufferPos = 0;
+    m_compressedSize = reading ? m_file.size() : 0;
+    m_compressedPos.storeRelease(0);
+
+    QIODevice::open(mode);
+
+    m_pipeline = QThread::create([this, reading]() {
+        if (reading) {
+            runReader();
+        } else {
+            runWriter();
+        }
+    });
+    m_pipeline->setObjectName("CompressedStreamPipeline");
+    m_pipeline->start();
+    return true;
+}
+
+void CompressedStream::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    if (openMode().testFlag(QIODevice::WriteOnly)) {
+        // 把剩余数据交给流水线，然后通知输入结束
+        if (!m_buffer.isEmpty()) {
+            enqueue(m_buffer);
+            m_buffer.clear();
+        }
+        QMutexLocker locker(&m_mutex);
+        m_producerDone = true;
+        m_notEmpty.wakeAll();
+    } else {
+        // 读取方提前关闭，让流水线线程不再等待队列空位
+        QMutexLocker locker(&m_mutex);
+        m_consumerDone = true;
+        m_notFull.wakeAll();
+    }
+
+    if (m_pipeline) {
+        m_pipeline->wait();
+        delete m_pipeline;
+        m_pipeline = nullptr;
+    }
+
+    m_file.close();
+    m_queue.clear();
+    m_buffer.clear();
+    m_bufferPos = 0;
+
+    // QIODevice::close()会清空错误信息，流水线的错误要在之后设置
+    QIODevice::close();
+
+    if (hasError()) {
+        setErrorString(m_pipelineError);
+        qDebug() << "压缩流错误:" << m_filename << m_pipelineError;
+    }
+}
+
+bool CompressedStream::hasError() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_error;
+}
+
+qint64 CompressedStream::bytesAvailable() const
+{
+    qint64 available = QIODevice::bytesAvailable() + (m_buffer.size() - m_bufferPos);
+    if (!openMode().testFlag(QIODevice::ReadOnly) || available > 0) {
+        return available;
+    }
+
+    // 当前没有已解压的数据时，等待流水线给出下一块或者结束，这样atEnd()才是准确的
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.isEmpty() && !m_producerDone) {
+        m_notEmpty.wait(&m_mutex);
+    }
+    return m_queue.isEmpty() ? 0 : m_queue.head().size();
+}
+
+qint64 CompressedStream::readData(char *data, qint64 maxSize)
+{
+    if (m_bufferPos >= m_buffer.size()) {
+        m_buffer.clear();
+        m_bufferPos = 0;
+        if (!dequeue(m_buffer)) {
+            return hasError() ? -1 : 0;
+        }
+    }
+
+    qint64 count = qMin(maxSize, static_cast<qint64>(m_buffer.size() - m_bufferPos));
+    memcpy(data, m_buffer.constData() + m_bufferPos, static_cast<size_t>(count));
+    m_bufferPos += static_cast<int>(count);
+    return count;
+}
+
+qint64 CompressedStream::writeData(const char *data, qint64 maxSize)
+{
+    m_buffer.append(data, static_cast<int>(maxSize));
+    while (m_buffer.size() >= CHUNK_SIZE) {
+        if (!enqueue(m_buffer.left(CHUNK_SIZE))) {
+            setErrorString(m_pipelineError);
+            return -1;
+        }
+        m_buffer.remove(0, CHUNK_SIZE);
+    }
+    return maxSize;
+}
+
+bool CompressedStream::enqueue(const QByteArray &chunk)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.size() >= MAX_QUEUED_CHUNKS && !m_consumerDone) {
+        m_notFull.wait(&m_mutex);
+    }
+    if (m_consumerDone) {
+        return false;
+    }
+    m_queue.enqueue(chunk);
+    m_notEmpty.wakeAll();
+    return true;
+}
+
+bool CompressedStream::dequeue(QByteArray &chunk)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queue.isEmpty() && !m_producerDone) {
+        m_notEmpty.wait(&m_mutex);
+    }
+    if (m_queue.isEmpty()) {
+        return false;
+    }
+    chunk = m_queue.dequeue();
+    m_notFull.wakeAll();
+    return true;
+}
+
+void CompressedStream::setPipelineError(const QString &error)
+{
+    QMutexLocker locker(&m_mutex);
+    m_error = true;
+    m_pipelineError = error;
+}
+
+void CompressedStream::runWriter()
+{
+    std::unique_ptr<StreamCodec> codec(createCodec(m_format));
+    bool ok = codec && codec->init(true);
+    if (!ok) {
+        setPipelineError("初始化压缩器失败");
+    }
+
+    QByteArray chunk;
+    QByteArray out;
+    while (ok && dequeue(chunk)) {
+        out.clear();
+        if (!codec->process(chunk, out, false)) {
+            setPipelineError("压缩数据失败");
+            ok = false;
+        } else if (m_file.write(out) != out.size()) {
+            setPipelineError(m_file.errorString());
+            ok = false;
+        }
+        m_compressedPos.fetchAndAddRelease(out.size());
+    }
+
+    if (ok) {
+        out.clear();
+        if (!codec->process(QByteArray(), out, true)) {
+            setPipelineError("压缩数据失败");
+        } else if (m_file.write(out) != out.size() || !m_file.flush()) {
+            setPipelineError(m_file.errorString());
+        }
+        m_compressedPos.fetchAndAddRelease(out.size());
+    }
+
+    // 出错后通知写入方停止，避免它在已满的队列上一直等待
+    QMutexLocker locker(&m_mutex);
+    m_consumerDone = true;
+    m_notFull.wakeAll();
+}
+
+void CompressedStream::runReader()
+{
+    std::unique_ptr<StreamCodec> codec(createCodec(m_format));
+    bool ok = codec && codec->init(false);
+    if (!ok) {
+        setPipelineError("初始化解压器失败");
+    }
+
+    QByteArray out;
+    while (ok) {
+        QByteArray raw = m_file.read(CHUNK_SIZE);
+        bool finish = raw.isEmpty();
+        if (finish && m_file.error() != QFileDevice::NoError) {
+            setPipelineError(m_file.errorString());
+            break;
+        }
+
+        m_compressedPos.fetchAndAddRelease(raw.size());
+        out.clear();
+        if (!codec->process(raw, out, finish)) {
+            setPipelineError(finish ? "压缩文件不完整" : "解压数据失败，文件可能已损坏");
+            break;
+        }
+        if (!out.isEmpty() && !enqueue(out)) {
+            break;  // 读取方已关闭
+        }
+        if (finish) {
+            break;
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_producerDone = true;
+    m_notEmpty.wakeAll();
+}
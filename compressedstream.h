@@ -0,0 +1,74 @@
+#ifndef COMPRESSEDSTREAM_H
+#define COMPRESSEDSTREAM_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QByteArray>
+#include <QAtomicInteger>
+
+// 压缩文件流：读写时在独立的流水线线程中完成压缩/解压和磁盘IO
+// 调用方看到的是普通的顺序设备，可以直接配合QTextStream使用
+// 两个线程之间只保留有限个数据块，内存占用与文件大小无关
+class CompressedStream : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        PlainFormat,
+        GzipFormat,
+        ZstdFormat
+    };
+
+    CompressedStream(const QString &filename, Format format, QObject *parent = nullptr);
+    ~CompressedStream() override;
+
+    static Format formatFromFileName(const QString &filename);  // 按扩展名判断（.gz / .zst）
+    static Format detectFormat(const QString &filename);  // 先看文件头魔数，再看扩展名
+    static bool isFormatSupported(Format format);
+
+    bool open(OpenMode mode) override;  // 只支持ReadOnly或WriteOnly
+    void close() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+    qint64 compressedPos() const { return m_compressedPos.loadAcquire(); }  // 已处理的压缩字节数，用于显示进度
+    qint64 compressedSize() const { return m_compressedSize; }
+    bool hasError() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    void runReader();
+    void runWriter();
+    bool enqueue(const QByteArray &chunk);
+    bool dequeue(QByteArray &chunk);
+    void setPipelineError(const QString &error);
+
+    QString m_filename;
+    Format m_format;
+    QFile m_file;
+    QThread *m_pipeline;
+
+    mutable QMutex m_mutex;
+    mutable QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<QByteArray> m_queue;
+    bool m_producerDone;  // 生产方（写入时为调用方，读取时为流水线线程）已结束
+    bool m_consumerDone;  // 消费方已停止，生产方不必再等待队列空位
+    bool m_error;
+    QString m_pipelineError;
+
+    QByteArray m_buffer;  // 写入时为待压缩的数据，读取时为当前已解压的数据块
+    int m_bufferPos;
+    qint64 m_compressedSize;
+    QAtomicInteger<qint64> m_compressedPos;
+};
+
+#endif // COMPRESSEDSTREAM_H
@@ -0,0 +1,57 @@
+# 核心代码：数据库、加密、导入导出和文件格式，不依赖界面
+# 由 PasswordManager.pro、bench/PasswordManagerBench.pro 等工程共同包含
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/database.cpp \
+    $$PWD/sqlitebackend.cpp \
+    $$PWD/memorybackend.cpp \
+    $$PWD/asyncdatabase.cpp \
+    $$PWD/encryption.cpp \
+    $$PWD/csvutils.cpp \
+    $$PWD/importexportworker.cpp \
+    $$PWD/compressedstream.cpp \
+    $$PWD/vaultbackup.cpp \
+    $$PWD/encryptedstream.cpp \
+    $$PWD/jsonstreamreader.cpp \
+    $$PWD/importreaders.cpp
+
+HEADERS += \
+    $$PWD/database.h \
+    $$PWD/storagebackend.h \
+    $$PWD/sqlitebackend.h \
+    $$PWD/memorybackend.h \
+    $$PWD/asyncdatabase.h \
+    $$PWD/encryption.h \
+    $$PWD/csvutils.h \
+    $$PWD/importexportworker.h \
+    $$PWD/compressedstream.h \
+    $$PWD/vaultbackup.h \
+    $$PWD/encryptedstream.h \
+    $$PWD/jsonstreamreader.h \
+    $$PWD/importreaders.h
+
+# 压缩导入导出：gzip依赖zlib（Unix默认启用，Windows需要 qmake CONFIG+=zlib 并提供zlib），
+# 没有zlib时不支持gzip，备份校验使用内置的CRC32；zstd可选（qmake CONFIG+=zstd 启用，需要libzstd）
+unix|zlib {
+    DEFINES += PM_HAVE_ZLIB
+    LIBS += -lz
+}
+zstd {
+    DEFINES += PM_HAVE_ZSTD
+    LIBS += -lzstd
+}
+
+# 直接使用SQLite C API（在线热备份、密码记录的读取路径），需要Qt的QSQLITE驱动同样使用系统SQLite（qmake CONFIG+=system_sqlite）
+system_sqlite {
+    DEFINES += PM_HAVE_SQLITE3_API
+    LIBS += -lsqlite3
+}
+
+# 保密版加密导出文件（AES-256-GCM），需要OpenSSL（qmake CONFIG+=openssl 启用），未启用时保密版仍导出Base64密文CSV
+openssl {
+    DEFINES += PM_HAVE_OPENSSL
+    LIBS += -lcrypto
+}
+
@@ -0,0 +1,53 @@
+#include "csvutils.h"
+
+QString escapeCSVField(const QString &field)
+{
+    QString escaped = field;
+
+    // 检查是否需要引号（包含逗号、双引号或换行符）
+    bool needsQuotes = escaped.contains(',') ||
+                       escaped.contains('"') ||
+                       escaped.contains('\n') ||
+                       escaped.contains('\r');
+
+    // 转义双引号
+    escaped.replace("\"", "\"\"");
+
+    // 如果需要引号，则添加引号
+    if (needsQuotes || escaped.startsWith(' ') || escaped.endsWith(' ')) {
+        escaped = "\"" + escaped + "\"";
+    }
+
+    return escaped;
+}
+
+QStringList parseCSVLine(const QString &line)
+{
+    QStringList fields;
+    QString field;
+    bool inQuotes = false;
+
+    for (int i = 0; i < line.length(); ++i) {
+        QChar ch = line[i];
+
+        if (ch == '"') {
+            if (i + 1 < line.length() && line[i + 1] == '"') {
+                // 双引号转义
+                field.append('"');
+                i++; // 跳过下一个引号
+            } else {
+                inQuotes = !inQuotes;
+            }
+        } else if (ch == ',' && !inQuotes) {
+            fields.append(field);
+            field.clear();
+        } else {
+            field.append(ch);
+        }
+    }
+
+    // 添加最后一个字段
+    fields.append(field);
+
+    return fields;
+}
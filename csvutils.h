@@ -0,0 +1,12 @@
+#ifndef CSVUTILS_H
+#define CSVUTILS_H
+
+#include <QString>
+#include <QStringList>
+
+// CSV字段转义函数（包含逗号、双引号、换行符或首尾空格时加引号）
+QString escapeCSVField(const QString &field);
+// CSV行解析函数，支持引号内的逗号和双引号转义
+QStringList parseCSVLine(const QString &line);
+
+#endif // CSVUTILS_H
@@ -1,623 +1,864 @@
-#include "database.h"
-#include "encryption.h"
-#include <QFile>
-#include <QTextStream>
-#include <QDebug>
-#include <QDir>
-#include <QSqlError>
-#include <QFileInfo>
-#include <QStandardPaths>
-
-              // CSV字段转义函数
-              static QString escapeCSVField(const QString &field)
-{
-    QString escaped = field;
-
-    // 检查是否需要引号（包含逗号、双引号或换行符）
-    bool needsQuotes = escaped.contains(',') ||
-                       escaped.contains('"') ||
-                       escaped.contains('\n') ||
-                       escaped.contains('\r');
-
-    // 转义双引号
-    escaped.replace("\"", "\"\"");
-
-    // 如果需要引号，则添加引号
-    if (needsQuotes || escaped.startsWith(' ') || escaped.endsWith(' ')) {
-        escaped = "\"" + escaped + "\"";
-    }
-
-    return escaped;
-}
-
-// CSV行解析函数
-static QStringList parseCSVLine(const QString &line)
-{
-    QStringList fields;
-    QString field;
-    bool inQuotes = false;
-
-    for (int i = 0; i < line.length(); ++i) {
-        QChar ch = line[i];
-
-        if (ch == '"') {
-            if (i + 1 < line.length() && line[i + 1] == '"') {
-                // 双引号转义
-                field.append('"');
-                i++; // 跳过下一个引号
-            } else {
-                inQuotes = !inQuotes;
-            }
-        } else if (ch == ',' && !inQuotes) {
-            fields.append(field);
-            field.clear();
-        } else {
-            field.append(ch);
-        }
-    }
-
-    // 添加最后一个字段
-    fields.append(field);
-
-    return fields;
-}
-
-Database::Database()
-{
-    // 获取默认数据库连接
-    db = QSqlDatabase::database(); // 使用main.cpp中已经打开的连接
-
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开，尝试重新连接";
-        QString dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/passwords.db";
-        db = QSqlDatabase::addDatabase("QSQLITE");
-        db.setDatabaseName(dbPath);
-
-        if (!db.open()) {
-            qDebug() << "仍然无法打开数据库:" << db.lastError().text();
-        } else {
-            qDebug() << "数据库重新连接成功";
-        }
-    }
-}
-
-Database::~Database()
-{
-    if (db.isOpen()) {
-        db.close();
-    }
-    // 移除数据库连接
-    QSqlDatabase::removeDatabase(db.connectionName());
-}
-
-Database& Database::instance()
-{
-    static Database instance;
-    return instance;
-}
-
-bool Database::init()
-{
-    // 检查SQLite驱动是否可用
-    if (!QSqlDatabase::isDriverAvailable("QSQLITE")) {
-        qDebug() << "SQLite驱动不可用";
-        return false;
-    }
-
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开，尝试重新连接";
-        QString dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/passwords.db";
-        db = QSqlDatabase::addDatabase("QSQLITE");
-        db.setDatabaseName(dbPath);
-
-        if (!db.open()) {
-            qDebug() << "无法打开数据库:" << db.lastError().text();
-            return false;
-        }
-    }
-
-    qDebug() << "数据库已成功打开";
-    return createTables();
-}
-
-bool Database::createTables()
-{
-    QSqlQuery query(db);
-
-    // 创建表单表
-    QString sql = "CREATE TABLE IF NOT EXISTS forms ("
-                  "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                  "name TEXT NOT NULL, "
-                  "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                  "UNIQUE(name))";
-
-    if (!query.exec(sql)) {
-        qDebug() << "创建表单表失败:" << query.lastError().text();
-        return false;
-    }
-
-    // 创建密码表，增加account字段和form_id字段
-    sql = "CREATE TABLE IF NOT EXISTS passwords ("
-          "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-          "form_id INTEGER NOT NULL, "
-          "website TEXT NOT NULL, "
-          "username TEXT NOT NULL, "
-          "account TEXT, "  // 新增：账号字段
-          "password TEXT NOT NULL, "
-          "notes TEXT, "
-          "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-          "FOREIGN KEY(form_id) REFERENCES forms(id) ON DELETE CASCADE, "
-          "UNIQUE(form_id, website, username, account))";  // 修改：将form_id加入唯一约束
-
-    if (!query.exec(sql)) {
-        qDebug() << "创建密码表失败:" << query.lastError().text();
-        return false;
-    }
-
-    // 创建索引以提高搜索性能
-    query.exec("CREATE INDEX IF NOT EXISTS idx_passwords_form_id ON passwords(form_id)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_passwords_website ON passwords(website)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_passwords_username ON passwords(username)");
-    query.exec("CREATE INDEX IF NOT EXISTS idx_passwords_account ON passwords(account)");
-
-    // 检查是否有表单，如果没有则创建一个默认表单
-    query.exec("SELECT COUNT(*) FROM forms");
-    if (query.next() && query.value(0).toInt() == 0) {
-        query.exec("INSERT INTO forms (name) VALUES ('默认表单')");
-        qDebug() << "创建默认表单";
-    }
-
-    // 确保至少有一个表单ID为1的默认表单
-    query.exec("SELECT id FROM forms WHERE name = '默认表单'");
-    if (!query.next()) {
-        query.exec("INSERT INTO forms (name) VALUES ('默认表单')");
-    }
-
-    return true;
-}
-
-// 表单相关方法
-bool Database::addForm(const QString &name)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    QSqlQuery query(db);
-    query.prepare("INSERT OR IGNORE INTO forms (name) VALUES (:name)");
-    query.bindValue(":name", name);
-
-    if (!query.exec()) {
-        qDebug() << "添加表单失败:" << query.lastError().text();
-        return false;
-    }
-
-    return query.numRowsAffected() > 0;
-}
-
-bool Database::updateForm(int id, const QString &name)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    QSqlQuery query(db);
-    query.prepare("UPDATE forms SET name = :name WHERE id = :id");
-    query.bindValue(":name", name);
-    query.bindValue(":id", id);
-
-    if (!query.exec()) {
-        qDebug() << "更新表单失败:" << query.lastError().text();
-        return false;
-    }
-
-    return query.numRowsAffected() > 0;
-}
-
-bool Database::deleteForm(int id)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    // 首先检查是否有其他表单，不能删除最后一个表单
-    QSqlQuery checkQuery(db);
-    checkQuery.exec("SELECT COUNT(*) FROM forms");
-    if (checkQuery.next() && checkQuery.value(0).toInt() <= 1) {
-        qDebug() << "不能删除最后一个表单";
-        return false;
-    }
-
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM forms WHERE id = :id");
-    query.bindValue(":id", id);
-
-    if (!query.exec()) {
-        qDebug() << "删除表单失败:" << query.lastError().text();
-        return false;
-    }
-
-    return query.numRowsAffected() > 0;
-}
-
-QList<FormEntry> Database::getAllForms()
-{
-    QList<FormEntry> forms;
-
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return forms;
-    }
-
-    QSqlQuery query(db);
-    if (!query.exec("SELECT id, name, created_at FROM forms ORDER BY name")) {
-        qDebug() << "查询表单失败:" << query.lastError().text();
-        return forms;
-    }
-
-    while (query.next()) {
-        FormEntry form;
-        form.id = query.value(0).toInt();
-        form.name = query.value(1).toString();
-        form.created_at = query.value(2).toString();
-        forms.append(form);
-    }
-
-    // 如果没有表单，创建一个默认表单
-    if (forms.isEmpty()) {
-        addForm("默认表单");
-        return getAllForms(); // 递归调用，现在应该有表单了
-    }
-
-    return forms;
-}
-
-FormEntry Database::getFormById(int id)
-{
-    FormEntry form;
-    form.id = -1;
-
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return form;
-    }
-
-    QSqlQuery query(db);
-    query.prepare("SELECT id, name, created_at FROM forms WHERE id = :id");
-    query.bindValue(":id", id);
-
-    if (!query.exec()) {
-        qDebug() << "查询表单失败:" << query.lastError().text();
-        return form;
-    }
-
-    if (query.next()) {
-        form.id = query.value(0).toInt();
-        form.name = query.value(1).toString();
-        form.created_at = query.value(2).toString();
-    }
-
-    return form;
-}
-
-// 密码相关方法
-bool Database::addPassword(int form_id, const QString &website, const QString &username,
-                           const QString &account, const QString &password,
-                           const QString &notes)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    // 如果form_id为-1，使用第一个表单
-    if (form_id <= 0) {
-        auto forms = getAllForms();
-        if (!forms.isEmpty()) {
-            form_id = forms.first().id;
-        } else {
-            qDebug() << "没有可用的表单";
-            return false;
-        }
-    }
-
-    QSqlQuery query(db);
-    query.prepare("INSERT OR IGNORE INTO passwords (form_id, website, username, account, password, notes) "
-                  "VALUES (:form_id, :website, :username, :account, :password, :notes)");
-    query.bindValue(":form_id", form_id);
-    query.bindValue(":website", website);
-    query.bindValue(":username", username);
-    query.bindValue(":account", account);  // 新增：绑定账号
-    query.bindValue(":password", password);
-    query.bindValue(":notes", notes);
-
-    if (!query.exec()) {
-        qDebug() << "添加密码失败:" << query.lastError().text();
-        return false;
-    }
-
-    return query.numRowsAffected() > 0;
-}
-
-bool Database::updatePassword(int id, int form_id, const QString &website,
-                              const QString &username, const QString &account,
-                              const QString &password, const QString &notes)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    QSqlQuery query(db);
-
-    // 首先检查新的form_id、website、username和account组合是否已存在（排除自身）
-    query.prepare("SELECT id FROM passwords WHERE form_id = :form_id AND website = :website AND username = :username AND account = :account AND id != :id");
-    query.bindValue(":form_id", form_id);
-    query.bindValue(":website", website);
-    query.bindValue(":username", username);
-    query.bindValue(":account", account);  // 新增：账号条件
-    query.bindValue(":id", id);
-
-    if (query.exec() && query.next()) {
-        qDebug() << "新的表单、网站、用户名和账号组合已存在";
-        return false;
-    }
-
-    // 如果新的组合不存在，则更新记录
-    query.prepare("UPDATE passwords SET form_id = :form_id, website = :website, username = :username, "
-                  "account = :account, password = :password, notes = :notes WHERE id = :id");
-    query.bindValue(":form_id", form_id);
-    query.bindValue(":website", website);
-    query.bindValue(":username", username);
-    query.bindValue(":account", account);  // 新增：更新账号
-    query.bindValue(":password", password);
-    query.bindValue(":notes", notes);
-    query.bindValue(":id", id);
-
-    if (!query.exec()) {
-        qDebug() << "更新密码失败:" << query.lastError().text();
-        return false;
-    }
-
-    return query.numRowsAffected() > 0;
-}
-
-bool Database::deletePassword(int id)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM passwords WHERE id = :id");
-    query.bindValue(":id", id);
-
-    if (!query.exec()) {
-        qDebug() << "删除密码失败:" << query.lastError().text();
-        return false;
-    }
-
-    return query.numRowsAffected() > 0;
-}
-
-bool Database::deletePasswordByWebsite(const QString &website)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM passwords WHERE website = :website");
-    query.bindValue(":website", website);
-
-    if (!query.exec()) {
-        qDebug() << "删除密码失败:" << query.lastError().text();
-        return false;
-    }
-
-    return query.numRowsAffected() > 0;
-}
-
-QList<PasswordEntry> Database::getAllPasswords(int form_id)
-{
-    QList<PasswordEntry> entries;
-
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return entries;
-    }
-
-    QSqlQuery query(db);
-
-    if (form_id >= 0) {
-        // 查询指定表单的密码，按照添加顺序（ID递增）排序
-        query.prepare("SELECT id, form_id, website, username, account, password, notes FROM passwords WHERE form_id = :form_id ORDER BY id ASC");
-        query.bindValue(":form_id", form_id);
-    } else {
-        // 查询所有表单的密码，按照添加顺序（ID递增）排序
-        query.prepare("SELECT id, form_id, website, username, account, password, notes FROM passwords ORDER BY id ASC");
-    }
-
-    if (!query.exec()) {
-        qDebug() << "查询密码失败:" << query.lastError().text();
-        return entries;
-    }
-
-    while (query.next()) {
-        PasswordEntry entry;
-        entry.id = query.value(0).toInt();
-        entry.form_id = query.value(1).toInt();
-        entry.website = query.value(2).toString();
-        entry.username = query.value(3).toString();
-        entry.account = query.value(4).toString();  // 新增：获取账号
-        entry.password = query.value(5).toString();
-        entry.notes = query.value(6).toString();
-        entries.append(entry);
-    }
-
-    return entries;
-}
-
-QList<PasswordEntry> Database::searchPasswords(const QString &keyword, const QList<int> &form_ids)
-{
-    QList<PasswordEntry> entries;
-
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return entries;
-    }
-
-    QSqlQuery query(db);
-
-    QString sql = "SELECT id, form_id, website, username, account, password, notes FROM passwords ";
-    QString whereClause = "WHERE (website LIKE :keyword OR username LIKE :keyword OR account LIKE :keyword OR notes LIKE :keyword) ";
-
-    if (!form_ids.isEmpty()) {
-        // 构建IN子句
-        QStringList placeholders;
-        for (int i = 0; i < form_ids.size(); ++i) {
-            placeholders.append(QString(":form_id_%1").arg(i));
-        }
-        whereClause += "AND form_id IN (" + placeholders.join(",") + ") ";
-    }
-
-    sql += whereClause + "ORDER BY id ASC";  // 修改：按照添加顺序排序
-
-    query.prepare(sql);
-    query.bindValue(":keyword", "%" + keyword + "%");
-
-    // 绑定表单ID参数
-    for (int i = 0; i < form_ids.size(); ++i) {
-        query.bindValue(QString(":form_id_%1").arg(i), form_ids[i]);
-    }
-
-    if (!query.exec()) {
-        qDebug() << "搜索密码失败:" << query.lastError().text();
-        return entries;
-    }
-
-    while (query.next()) {
-        PasswordEntry entry;
-        entry.id = query.value(0).toInt();
-        entry.form_id = query.value(1).toInt();
-        entry.website = query.value(2).toString();
-        entry.username = query.value(3).toString();
-        entry.account = query.value(4).toString();  // 新增：获取账号
-        entry.password = query.value(5).toString();
-        entry.notes = query.value(6).toString();
-        entries.append(entry);
-    }
-
-    return entries;
-}
-
-bool Database::exportToCSV(const QString &filename, int form_id)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "无法打开文件:" << filename;
-        return false;
-    }
-
-    QTextStream out(&file);
-
-    // 写入UTF-8 BOM以确保正确识别编码（Windows系统需要）
-    out << "\xEF\xBB\xBF";
-
-    // 写入表头，增加Account列
-    out << "Website,Username,Account,Password,Notes\n";
-
-    auto passwords = getAllPasswords(form_id);
-    for (const auto &pwd : passwords) {
-        // 对CSV特殊字符进行转义
-        QString escapedWebsite = escapeCSVField(pwd.website);
-        QString escapedUsername = escapeCSVField(pwd.username);
-
-        // 解密账号和密码后再进行转义
-        QString decryptedAccount = Encryption::decrypt(pwd.account);
-        QString escapedDecryptedAccount = escapeCSVField(decryptedAccount);
-
-        QString decryptedPassword = Encryption::decrypt(pwd.password);
-        QString escapedPassword = escapeCSVField(decryptedPassword);
-
-        QString escapedNotes = escapeCSVField(pwd.notes);
-
-        out << escapedWebsite << ","
-            << escapedUsername << ","
-            << escapedDecryptedAccount << ","  // 使用解密后的账号
-            << escapedPassword << ","
-            << escapedNotes << "\n";
-    }
-
-    file.close();
-    qDebug() << "导出成功，共导出" << passwords.size() << "条记录";
-    return true;
-}
-
-bool Database::importFromCSV(const QString &filename, int form_id)
-{
-    if (!db.isOpen()) {
-        qDebug() << "数据库未打开";
-        return false;
-    }
-
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "无法打开文件:" << filename;
-        return false;
-    }
-
-    QTextStream in(&file);
-    // 检查并跳过UTF-8 BOM
-    QString firstLine = in.readLine();
-    if (!firstLine.startsWith("Website,Username,Account,Password,Notes")) {
-        // 可能是第一行包含BOM，尝试读取下一行
-        in.seek(0);
-        in.read(3); // 跳过BOM
-        firstLine = in.readLine(); // 读取标题行
-    }
-
-    int importedCount = 0;
-
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty()) continue;
-
-        // 使用改进的CSV解析
-        QStringList fields = parseCSVLine(line);
-
-        if (fields.size() >= 5) {
-            QString website = fields[0].trimmed();
-            QString username = fields[1].trimmed();
-            QString account = fields[2].trimmed();  // 新增：获取账号
-            QString password = fields[3].trimmed();  // CSV中的明文密码
-            QString notes = fields[4].trimmed();
-
-            if (!website.isEmpty() && !username.isEmpty()) {
-                // 对账号和密码进行加密后再存储
-                QString encryptedAccount = Encryption::encrypt(account);
-                QString encryptedPassword = Encryption::encrypt(password);
-                addPassword(form_id, website, username, encryptedAccount, encryptedPassword, notes);
-                importedCount++;
-            }
-        } else {
-            qDebug() << "CSV格式错误，行:" << line;
-            qDebug() << "解析出的字段数:" << fields.size();
-        }
-    }
-
-    file.close();
-    qDebug() << "成功导入" << importedCount << "条记录";
-    return importedCount > 0;
-}
-
+#include "database.h"
+#include "encryption.h"
+#include "csvutils.h"
+#include "sqlitebackend.h"
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <QDir>
+#include <QSqlError>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QThread>
+#include <QSqlDriver>
+#include <QAtomicInt>
+#include <QMutexLocker>
+#include <algorithm>
+#ifdef PM_HAVE_SQLITE3_API
+#include <sqlite3.h>
+#endif
+
+Database::Database()
+    : sqliteStorage(nullptr)
+    , currentStorage(nullptr)
+    , formCacheValid(false)
+    , formCacheGeneration(0)
+{
+    // 获取默认数据库连接
+    db = QSqlDatabase::database(); // 使用main.cpp中已经打开的连接
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开，尝试重新连接";
+        QString dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/passwords.db";
+        db = QSqlDatabase::addDatabase("QSQLITE");
+        db.setDatabaseName(dbPath);
+
+        if (!db.open()) {
+            qDebug() << "仍然无法打开数据库:" << db.lastError().text();
+        } else {
+            qDebug() << "数据库重新连接成功";
+        }
+    }
+
+    dbPath = db.databaseName();
+    sqliteStorage = new SqliteBackend(db);
+    currentStorage = sqliteStorage;
+}
+
+Database::~Database()
+{
+    if (currentStorage != sqliteStorage) {
+        delete currentStorage;
+    }
+    delete sqliteStorage;
+
+    if (db.isOpen()) {
+        db.close();
+    }
+    // 移除数据库连接
+    QSqlDatabase::removeDatabase(db.connectionName());
+}
+
+Database& Database::instance()
+{
+    static Database instance;
+    return instance;
+}
+
+bool Database::init()
+{
+    // 内存引擎不使用数据库文件
+    if (!currentStorage->isPersistent()) {
+        return true;
+    }
+
+    // 检查SQLite驱动是否可用
+    if (!QSqlDatabase::isDriverAvailable("QSQLITE")) {
+        qDebug() << "SQLite驱动不可用";
+        return false;
+    }
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开，尝试重新连接";
+        QString dbPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/passwords.db";
+        db = QSqlDatabase::addDatabase("QSQLITE");
+        db.setDatabaseName(dbPath);
+
+        if (!db.open()) {
+            qDebug() << "无法打开数据库:" << db.lastError().text();
+            return false;
+        }
+        sqliteStorage->setConnection(db);
+    }
+
+    if (db.databaseName() != dbPath) {
+        // 默认连接已经指向另一个数据库文件，重新读取表单
+        invalidateFormCache();
+    }
+    dbPath = db.databaseName();
+    return migrate();
+}
+
+int Database::schemaVersion()
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        qDebug() << "读取数据库版本失败:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool Database::setStorage(StorageBackend *storage)
+{
+    if (!storage) {
+        storage = sqliteStorage;
+    }
+    if (storage == currentStorage) {
+        return true;
+    }
+    if (currentStorage->transactionDepth() > 0) {
+        qDebug() << "事务进行中，不能切换存储引擎";
+        return false;
+    }
+
+    if (currentStorage != sqliteStorage) {
+        delete currentStorage;
+    }
+    currentStorage = storage;
+    invalidateFormCache();
+    qDebug() << "存储引擎已切换为" << (currentStorage->isPersistent() ? "SQLite" : "内存");
+    return true;
+}
+
+bool Database::isPersistent() const
+{
+    return currentStorage->isPersistent();
+}
+
+Database::Transaction::Transaction(StorageBackend *storage)
+    : m_storage(storage ? storage : Database::instance().currentStorage)
+    , m_level(0)
+    , m_active(false)
+{
+    begin();
+}
+
+Database::Transaction::~Transaction()
+{
+    if (m_active) {
+        qDebug() << "事务未提交，自动回滚";
+        rollback();
+    }
+}
+
+bool Database::Transaction::begin()
+{
+    int level = m_storage->beginTransaction();
+    m_active = level >= 0;
+    if (m_active) {
+        m_level = level;
+    }
+    return m_active;
+}
+
+bool Database::Transaction::commit()
+{
+    if (!m_active) {
+        return false;
+    }
+
+    if (m_storage->transactionDepth() != m_level + 1) {
+        qDebug() << "内层事务还没有结束，不能提交外层事务";
+        return false;
+    }
+
+    if (!m_storage->commitTransaction(m_level)) {
+        rollback();
+        return false;
+    }
+
+    m_active = false;
+    return true;
+}
+
+void Database::Transaction::rollback()
+{
+    if (!m_active) {
+        return;
+    }
+
+    m_storage->rollbackTransaction(m_level);
+    m_active = false;
+}
+
+bool Database::Transaction::restart()
+{
+    return commit() && begin();
+}
+
+Database::ThreadStorage::ThreadStorage(const QString &prefix)
+    : m_sqlite(nullptr)
+    , m_storage(nullptr)
+{
+    Database &database = Database::instance();
+    if (!database.isPersistent()) {
+        m_storage = database.storage();
+        return;
+    }
+
+    m_connectionName = database.openThreadConnection(prefix);
+    if (!m_connectionName.isEmpty()) {
+        m_sqlite = new SqliteBackend(QSqlDatabase::database(m_connectionName, false));
+        m_storage = m_sqlite;
+    }
+}
+
+Database::ThreadStorage::~ThreadStorage()
+{
+    delete m_sqlite;  // 先释放引擎持有的连接对象
+    closeThreadConnection(m_connectionName);
+}
+
+// 按PRAGMA user_version逐个执行尚未执行过的迁移，每个迁移和版本号更新在同一事务中完成
+bool Database::migrate()
+{
+    typedef bool (Database::*Migration)();
+    static const Migration migrations[] = {
+        &Database::createTables,     // 版本1：表、索引和默认表单
+        &Database::createFormStats,  // 版本2：每个表单的记录数统计表和维护触发器
+    };
+    const int latestVersion = sizeof(migrations) / sizeof(migrations[0]);
+
+    // 界面每次刷新都会调用init()，结构已是最新时只读一次文件头中的版本号
+    int version = schemaVersion();
+    if (version == latestVersion) {
+        return true;
+    }
+    if (version < 0) {
+        return false;
+    }
+    if (version > latestVersion) {
+        qDebug() << "数据库版本" << version << "高于程序支持的版本" << latestVersion << "，请使用新版本程序打开";
+        return false;
+    }
+
+    while (version < latestVersion) {
+        Transaction transaction(sqliteStorage);  // 迁移总是针对数据库文件
+        if (!transaction.isActive()) {
+            return false;
+        }
+
+        QSqlQuery query(db);
+        if (!(this->*migrations[version])() ||
+            !query.exec(QString("PRAGMA user_version = %1").arg(version + 1)) ||
+            !transaction.commit()) {
+            qDebug() << "迁移数据库到版本" << version + 1 << "失败:" << query.lastError().text();
+            return false;
+        }
+
+        ++version;
+        qDebug() << "数据库已迁移到版本" << version;
+    }
+
+    invalidateFormCache();  // 迁移可能创建了默认表单
+    return true;
+}
+
+// 版本1：旧版本程序创建的数据库（user_version为0）已经有这些表，IF NOT EXISTS保证可以直接升级
+bool Database::createTables()
+{
+    QSqlQuery query(db);
+
+    // 创建表单表
+    QString sql = "CREATE TABLE IF NOT EXISTS forms ("
+                  "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                  "name TEXT NOT NULL, "
+                  "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                  "UNIQUE(name))";
+
+    if (!query.exec(sql)) {
+        qDebug() << "创建表单表失败:" << query.lastError().text();
+        return false;
+    }
+
+    // 创建密码表，增加account字段和form_id字段
+    sql = "CREATE TABLE IF NOT EXISTS passwords ("
+          "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+          "form_id INTEGER NOT NULL, "
+          "website TEXT NOT NULL, "
+          "username TEXT NOT NULL, "
+          "account TEXT, "  // 新增：账号字段
+          "password TEXT NOT NULL, "
+          "notes TEXT, "
+          "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+          "FOREIGN KEY(form_id) REFERENCES forms(id) ON DELETE CASCADE, "
+          "UNIQUE(form_id, website, username, account))";  // 修改：将form_id加入唯一约束
+
+    if (!query.exec(sql)) {
+        qDebug() << "创建密码表失败:" << query.lastError().text();
+        return false;
+    }
+
+    // 创建索引以提高搜索性能
+    const QStringList indexes = {
+        "CREATE INDEX IF NOT EXISTS idx_passwords_form_id ON passwords(form_id)",
+        "CREATE INDEX IF NOT EXISTS idx_passwords_website ON passwords(website)",
+        "CREATE INDEX IF NOT EXISTS idx_passwords_username ON passwords(username)",
+        "CREATE INDEX IF NOT EXISTS idx_passwords_account ON passwords(account)"
+    };
+    for (const QString &index : indexes) {
+        if (!query.exec(index)) {
+            qDebug() << "创建索引失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // 检查是否有表单，如果没有则创建一个默认表单
+    query.exec("SELECT COUNT(*) FROM forms");
+    if (query.next() && query.value(0).toInt() == 0) {
+        query.exec("INSERT INTO forms (name) VALUES ('默认表单')");
+        qDebug() << "创建默认表单";
+    }
+
+    // 确保至少有一个表单ID为1的默认表单
+    query.exec("SELECT id FROM forms WHERE name = '默认表单'");
+    if (!query.next()) {
+        query.exec("INSERT INTO forms (name) VALUES ('默认表单')");
+    }
+
+    return true;
+}
+
+// 版本2：form_stats 按表单保存记录数和最后修改时间，由passwords上的触发器维护，
+// 显示每个表单的记录数只需读取一张与表单数量同样大小的表
+bool Database::createFormStats()
+{
+    QSqlQuery query(db);
+
+    const QStringList statements = {
+        "CREATE TABLE IF NOT EXISTS form_stats ("
+        "form_id INTEGER PRIMARY KEY, "
+        "entry_count INTEGER NOT NULL DEFAULT 0, "
+        "last_modified TIMESTAMP)",
+
+        "CREATE TRIGGER IF NOT EXISTS trg_forms_insert_stats AFTER INSERT ON forms BEGIN "
+        "INSERT OR IGNORE INTO form_stats (form_id, entry_count, last_modified) "
+        "VALUES (NEW.id, 0, CURRENT_TIMESTAMP); "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS trg_forms_delete_stats AFTER DELETE ON forms BEGIN "
+        "DELETE FROM form_stats WHERE form_id = OLD.id; "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS trg_passwords_insert_stats AFTER INSERT ON passwords BEGIN "
+        "INSERT OR IGNORE INTO form_stats (form_id, entry_count) VALUES (NEW.form_id, 0); "
+        "UPDATE form_stats SET entry_count = entry_count + 1, last_modified = CURRENT_TIMESTAMP "
+        "WHERE form_id = NEW.form_id; "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS trg_passwords_delete_stats AFTER DELETE ON passwords BEGIN "
+        "UPDATE form_stats SET entry_count = entry_count - 1, last_modified = CURRENT_TIMESTAMP "
+        "WHERE form_id = OLD.form_id; "
+        "END",
+
+        // 记录移动到其他表单时两边的数量都要调整；表单不变时减一再加一，只更新修改时间
+        "CREATE TRIGGER IF NOT EXISTS trg_passwords_update_stats AFTER UPDATE ON passwords BEGIN "
+        "INSERT OR IGNORE INTO form_stats (form_id, entry_count) VALUES (NEW.form_id, 0); "
+        "UPDATE form_stats SET entry_count = entry_count - 1, last_modified = CURRENT_TIMESTAMP "
+        "WHERE form_id = OLD.form_id; "
+        "UPDATE form_stats SET entry_count = entry_count + 1, last_modified = CURRENT_TIMESTAMP "
+        "WHERE form_id = NEW.form_id; "
+        "END"
+    };
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            qDebug() << "创建表单统计失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    return rebuildFormStats(db);
+}
+
+bool Database::rebuildFormStats(QSqlDatabase connection)
+{
+    QSqlQuery query(connection);
+    if (!query.exec("DELETE FROM form_stats") ||
+        !query.exec("INSERT INTO form_stats (form_id, entry_count, last_modified) "
+                    "SELECT forms.id, COUNT(passwords.id), MAX(COALESCE(passwords.created_at, forms.created_at)) "
+                    "FROM forms LEFT JOIN passwords ON passwords.form_id = forms.id "
+                    "GROUP BY forms.id")) {
+        qDebug() << "重建表单统计失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// 表单相关方法，修改成功后使表单缓存失效
+bool Database::addForm(const QString &name)
+{
+    if (!currentStorage->addForm(name)) {
+        return false;
+    }
+    invalidateFormCache();
+    return true;
+}
+
+bool Database::updateForm(int id, const QString &name)
+{
+    if (!currentStorage->updateForm(id, name)) {
+        return false;
+    }
+    invalidateFormCache();
+    return true;
+}
+
+bool Database::deleteForm(int id)
+{
+    // 首先检查是否有其他表单，不能删除最后一个表单
+    if (getAllForms().size() <= 1) {
+        qDebug() << "不能删除最后一个表单";
+        return false;
+    }
+
+    if (!currentStorage->deleteForm(id)) {
+        return false;
+    }
+    invalidateFormCache();
+    return true;
+}
+
+QList<FormEntry> Database::getAllForms()
+{
+    // 表单很少变化，缓存命中时不访问数据库
+    int generation;
+    {
+        QMutexLocker locker(&formCacheMutex);
+        if (formCacheValid) {
+            return formCache;
+        }
+        generation = formCacheGeneration;
+    }
+
+    QList<FormEntry> forms = currentStorage->getAllForms();
+
+    // 如果没有表单，创建一个默认表单（创建失败时说明数据库不可用，直接返回空列表）
+    if (forms.isEmpty()) {
+        if (addForm("默认表单")) {
+            return getAllForms(); // 递归调用，现在应该有表单了
+        }
+        return forms;
+    }
+
+    // 查询期间其他线程修改了表单时不写入缓存，下次重新查询
+    QMutexLocker locker(&formCacheMutex);
+    if (generation == formCacheGeneration) {
+        formCache = forms;
+        formCacheValid = true;
+    }
+    return forms;
+}
+
+FormEntry Database::getFormById(int id)
+{
+    for (const auto &form : getAllForms()) {
+        if (form.id == id) {
+            return form;
+        }
+    }
+
+    FormEntry form;
+    form.id = -1;
+    return form;
+}
+
+QHash<int, FormStats> Database::getFormStats()
+{
+    return currentStorage->getFormStats();
+}
+
+void Database::invalidateFormCache()
+{
+    QMutexLocker locker(&formCacheMutex);
+    formCacheValid = false;
+    formCache.clear();
+    ++formCacheGeneration;
+}
+
+// 密码相关方法
+bool Database::addPassword(int form_id, const QString &website, const QString &username,
+                           const QString &account, const QString &password,
+                           const QString &notes)
+{
+    // 如果form_id为-1，使用第一个表单
+    if (form_id <= 0) {
+        auto forms = getAllForms();
+        if (!forms.isEmpty()) {
+            form_id = forms.first().id;
+        } else {
+            qDebug() << "没有可用的表单";
+            return false;
+        }
+    }
+
+    return currentStorage->addPassword(form_id, website, username, account, password, notes);
+}
+
+bool Database::updatePassword(int id, int form_id, const QString &website,
+                              const QString &username, const QString &account,
+                              const QString &password, const QString &notes)
+{
+    return currentStorage->updatePassword(id, form_id, website, username, account, password, notes);
+}
+
+bool Database::updateField(int id, EntryField field, const QString &value, bool *conflict)
+{
+    return currentStorage->updateField(id, field, value, conflict);
+}
+
+bool Database::deletePassword(int id)
+{
+    return currentStorage->deletePassword(id);
+}
+
+int Database::deletePasswords(const QList<int> &ids)
+{
+    return currentStorage->deletePasswords(ids);
+}
+
+int Database::movePasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, int *conflictCount)
+{
+    return currentStorage->transferPasswords(ids, targetFormId, policy, false, conflictCount);
+}
+
+int Database::copyPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, int *conflictCount)
+{
+    return currentStorage->transferPasswords(ids, targetFormId, policy, true, conflictCount);
+}
+
+int Database::transferPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, bool copy,
+                                int *conflictCount)
+{
+    return currentStorage->transferPasswords(ids, targetFormId, policy, copy, conflictCount);
+}
+
+bool Database::deletePasswordByWebsite(const QString &website)
+{
+    return currentStorage->deletePasswordByWebsite(website);
+}
+
+QList<PasswordEntry> Database::getAllPasswords(int form_id)
+{
+    return currentStorage->getAllPasswords(form_id);
+}
+
+QList<PasswordEntry> Database::searchPasswords(const QString &keyword, const QList<int> &form_ids)
+{
+    return currentStorage->searchPasswords(keyword, form_ids);
+}
+
+QList<PasswordEntry> Database::getPasswordsByIds(const QList<int> &ids)
+{
+    return currentStorage->getPasswordsByIds(ids);
+}
+
+QList<PasswordEntry> Database::getPasswordsAfter(int form_id, int afterId, int limit)
+{
+    return currentStorage->getPasswordsAfter(form_id, afterId, limit);
+}
+
+int Database::countPasswords(int form_id)
+{
+    return currentStorage->countPasswords(form_id);
+}
+
+int Database::beginTransaction()
+{
+    return currentStorage->beginTransaction();
+}
+
+bool Database::commitTransaction(int level)
+{
+    return currentStorage->commitTransaction(level);
+}
+
+void Database::rollbackTransaction(int level)
+{
+    currentStorage->rollbackTransaction(level);
+}
+
+int Database::transactionDepth() const
+{
+    return currentStorage->transactionDepth();
+}
+
+void Database::setNativeReads(bool enabled)
+{
+    SqliteBackend::setNativeReads(enabled);
+}
+
+bool Database::nativeReadsEnabled()
+{
+    return SqliteBackend::nativeReadsEnabled();
+}
+
+bool Database::exportToCSV(const QString &filename, int form_id)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "无法打开文件:" << filename;
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    // 写入UTF-8 BOM以确保正确识别编码（Windows系统需要）
+    out << "\xEF\xBB\xBF";
+
+    // 写入表头，增加Account列
+    out << "Website,Username,Account,Password,Notes\n";
+
+    auto passwords = getAllPasswords(form_id);
+    for (const auto &pwd : passwords) {
+        // 对CSV特殊字符进行转义
+        QString escapedWebsite = escapeCSVField(pwd.website);
+        QString escapedUsername = escapeCSVField(pwd.username);
+
+        // 解密账号和密码后再进行转义
+        QString decryptedAccount = Encryption::decrypt(pwd.account);
+        QString escapedDecryptedAccount = escapeCSVField(decryptedAccount);
+
+        QString decryptedPassword = Encryption::decrypt(pwd.password);
+        QString escapedPassword = escapeCSVField(decryptedPassword);
+
+        QString escapedNotes = escapeCSVField(pwd.notes);
+
+        out << escapedWebsite << ","
+            << escapedUsername << ","
+            << escapedDecryptedAccount << ","  // 使用解密后的账号
+            << escapedPassword << ","
+            << escapedNotes << "\n";
+    }
+
+    file.close();
+    qDebug() << "导出成功，共导出" << passwords.size() << "条记录";
+    return true;
+}
+
+bool Database::importFromCSV(const QString &filename, int form_id)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "无法打开文件:" << filename;
+        return false;
+    }
+
+    QTextStream in(&file);
+    // 检查并跳过UTF-8 BOM
+    QString firstLine = in.readLine();
+    if (!firstLine.startsWith("Website,Username,Account,Password,Notes")) {
+        // 可能是第一行包含BOM，尝试读取下一行
+        in.seek(0);
+        in.read(3); // 跳过BOM
+        firstLine = in.readLine(); // 读取标题行
+    }
+
+    int importedCount = 0;
+
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty()) continue;
+
+        // 使用改进的CSV解析
+        QStringList fields = parseCSVLine(line);
+
+        if (fields.size() >= 5) {
+            QString website = fields[0].trimmed();
+            QString username = fields[1].trimmed();
+            QString account = fields[2].trimmed();  // 新增：获取账号
+            QString password = fields[3].trimmed();  // CSV中的明文密码
+            QString notes = fields[4].trimmed();
+
+            if (!website.isEmpty() && !username.isEmpty()) {
+                // 对账号和密码进行加密后再存储
+                QString encryptedAccount = Encryption::encrypt(account);
+                QString encryptedPassword = Encryption::encrypt(password);
+                addPassword(form_id, website, username, encryptedAccount, encryptedPassword, notes);
+                importedCount++;
+            }
+        } else {
+            qDebug() << "CSV格式错误，行:" << line;
+            qDebug() << "解析出的字段数:" << fields.size();
+        }
+    }
+
+    file.close();
+    qDebug() << "成功导入" << importedCount << "条记录";
+    return importedCount > 0;
+}
+
+
+QString Database::openThreadConnection(const QString &prefix)
+{
+    static QAtomicInt counter(0);
+    QString name = QString("%1_%2").arg(prefix).arg(counter.fetchAndAddRelaxed(1));
+
+    QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", name);
+    connection.setDatabaseName(dbPath);
+    // 其他连接正在写入时稍作等待，而不是立即返回SQLITE_BUSY
+    connection.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!connection.open()) {
+        qDebug() << "无法打开线程数据库连接:" << connection.lastError().text();
+        connection = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        return QString();
+    }
+
+    return name;
+}
+
+void Database::closeThreadConnection(const QString &connectionName)
+{
+    if (connectionName.isEmpty()) {
+        return;
+    }
+
+    {
+        QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+        if (connection.isOpen()) {
+            connection.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool Database::readFormPasswords(const QString &connectionName, int form_id, QList<PasswordEntry> &entries,
+                                 const std::function<bool()> &cancelled, int pageSize)
+{
+    QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+    if (!connection.isOpen()) {
+        qDebug() << "线程数据库连接未打开:" << connectionName;
+        return false;
+    }
+
+    int afterId = 0;
+    for (;;) {
+        if (cancelled && cancelled()) {
+            return false;
+        }
+
+        // 每页是一条独立执行完的语句，读完即释放读锁
+        int before = entries.size();
+        if (!SqliteBackend::queryPasswords(connection, "SELECT id, form_id, website, username, account, password, notes "
+                                        "FROM passwords WHERE form_id = ? AND id > ? ORDER BY id ASC LIMIT ?",
+                            QVariantList() << form_id << afterId << pageSize, entries)) {
+            qDebug() << "分页查询密码失败";
+            return false;
+        }
+
+        int count = entries.size() - before;
+        if (count < pageSize) {
+            return true;
+        }
+        afterId = entries.last().id;
+    }
+}
+
+bool Database::backupTo(const QString &filename, const BackupProgress &progress, int pagesPerStep)
+{
+    QString connectionName = openThreadConnection("backup");
+    if (connectionName.isEmpty()) {
+        return false;
+    }
+
+    // 先写到临时文件，成功后再替换目标文件，避免留下不完整的备份
+    QString partFile = filename + ".part";
+    QFile::remove(partFile);
+    bool ok = false;
+
+    {
+        QSqlDatabase source = QSqlDatabase::database(connectionName);
+
+#ifdef PM_HAVE_SQLITE3_API
+        // 使用SQLite在线备份API，每次只复制少量页面，步骤之间释放锁，不会长时间阻塞写入方
+        // 其他连接在备份期间修改了数据库时，SQLite会自动从头开始，保证得到一致的快照
+        QVariant handle = source.driver()->handle();
+        sqlite3 *sourceHandle = nullptr;
+        if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+            sourceHandle = *static_cast<sqlite3 **>(handle.data());
+        }
+
+        sqlite3 *target = nullptr;
+        if (sourceHandle && sqlite3_open(QFile::encodeName(partFile).constData(), &target) == SQLITE_OK) {
+            sqlite3_backup *backup = sqlite3_backup_init(target, "main", sourceHandle, "main");
+            if (backup) {
+                int rc;
+                bool cancelled = false;
+                do {
+                    rc = sqlite3_backup_step(backup, pagesPerStep);
+                    if (progress && !progress(sqlite3_backup_remaining(backup), sqlite3_backup_pagecount(backup))) {
+                        cancelled = true;
+                        break;
+                    }
+                    if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+                        sqlite3_sleep(20);
+                    }
+                } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+
+                sqlite3_backup_finish(backup);
+                ok = !cancelled && rc == SQLITE_DONE;
+                if (!ok && !cancelled) {
+                    qDebug() << "在线备份失败:" << sqlite3_errstr(rc);
+                }
+            } else {
+                qDebug() << "初始化在线备份失败:" << sqlite3_errmsg(target);
+            }
+        } else {
+            qDebug() << "无法获取SQLite句柄或创建备份文件";
+        }
+        if (target) {
+            sqlite3_close(target);
+        }
+#else
+        // 没有链接SQLite C API时使用VACUUM INTO（SQLite 3.27+），同样是一致快照，但只能一次完成
+        Q_UNUSED(pagesPerStep);
+        if (progress) {
+            progress(1, 1);
+        }
+        QSqlQuery query(source);
+        query.prepare("VACUUM INTO :file");
+        query.bindValue(":file", partFile);
+        ok = query.exec();
+        if (!ok) {
+            qDebug() << "VACUUM INTO备份失败:" << query.lastError().text();
+        } else if (progress) {
+            progress(0, 1);
+        }
+#endif
+    }
+
+    closeThreadConnection(connectionName);
+
+    if (ok) {
+        QFile::remove(filename);
+        ok = QFile::rename(partFile, filename);
+    }
+    if (!ok) {
+        QFile::remove(partFile);
+    }
+
+    qDebug() << "数据库热备份" << (ok ? "成功:" : "失败:") << filename;
+    return ok;
+}
@@ -1,64 +1,160 @@
-#ifndef DATABASE_H
-#define DATABASE_H
-
-#include <QSqlDatabase>
-#include <QSqlQuery>
-#include <QSqlError>
-#include <QList>
-#include <QString>
-
-              // 表单结构体
-              struct FormEntry {
-    int id;
-    QString name;
-    QString created_at;
-};
-
-struct PasswordEntry {
-    int id;  // 新增：主键ID
-    int form_id;  // 新增：表单ID
-    QString website;
-    QString username;
-    QString account;  // 新增：账号字段
-    QString password;  // 加密后的
-    QString notes;
-};
-
-class Database
-{
-public:
-    static Database& instance();
-
-    bool init();
-
-    // 表单相关方法
-    bool addForm(const QString &name);
-    bool updateForm(int id, const QString &name);
-    bool deleteForm(int id);
-    QList<FormEntry> getAllForms();
-    FormEntry getFormById(int id);
-
-    // 密码相关方法
-    bool addPassword(int form_id, const QString &website, const QString &username,
-                     const QString &account, const QString &password, const QString &notes);
-    bool updatePassword(int id, int form_id, const QString &website,
-                        const QString &username, const QString &account,
-                        const QString &password, const QString &notes);
-    bool deletePassword(int id);
-    bool deletePasswordByWebsite(const QString &website);
-    QList<PasswordEntry> getAllPasswords(int form_id = -1);  // -1 表示所有表单
-    QList<PasswordEntry> searchPasswords(const QString &keyword, const QList<int> &form_ids = QList<int>());
-    bool exportToCSV(const QString &filename, int form_id = -1);
-    bool importFromCSV(const QString &filename, int form_id = 1);  // 默认导入到第一个表单
-
-private:
-    Database();
-    ~Database();
-    Database(const Database&) = delete;
-    Database& operator=(const Database&) = delete;
-
-    QSqlDatabase db;
-    bool createTables();
-};
-
-#endif // DATABASE_H
+#ifndef DATABASE_H
+#define DATABASE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <functional>
+#include "storagebackend.h"
+
+class SqliteBackend;
+
+// 对外的数据库接口（单例）：记录的读写转交给当前的存储引擎，默认是默认连接上的SQLite，
+// 也可以换成内存引擎；表单缓存、表结构迁移、备份和后台线程连接等在这里实现
+class Database : public StorageBackend
+{
+public:
+    static Database& instance();
+
+    // 打开数据库并把表结构迁移到最新版本；结构已是最新时只读取版本号
+    bool init();
+    int schemaVersion();  // PRAGMA user_version，读取失败返回-1
+
+    // 切换存储引擎，成功时接管所有权；传入nullptr恢复为SQLite；有未结束的事务时不能切换，返回false
+    bool setStorage(StorageBackend *storage);
+    StorageBackend *storage() const { return currentStorage; }
+    bool isPersistent() const override;
+
+    // 事务保护对象：构造时开始事务，析构时如果还没有提交就自动回滚，提前返回或抛出异常都不会留下未结束的事务
+    // 嵌套使用时内层回滚只撤销自己的修改（SQLite用SAVEPOINT，内存引擎用撤销日志），最外层提交时才真正写盘
+    // 不指定存储引擎时使用Database当前的引擎
+    class Transaction
+    {
+    public:
+        explicit Transaction(StorageBackend *storage = nullptr);
+        ~Transaction();
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+
+        bool isActive() const { return m_active; }
+        bool commit();   // 失败时自动回滚
+        void rollback();
+        bool restart();  // 提交后在同一层开始新的事务，用于按批提交
+
+    private:
+        bool begin();
+
+        StorageBackend *m_storage;
+        int m_level;  // 0为最外层事务，大于0为保存点
+        bool m_active;
+    };
+
+    // 后台线程使用的存储引擎：SQLite时在本线程打开独立连接并在其上创建引擎，析构时关闭连接；
+    // 内存引擎的每个方法都加锁，直接使用Database当前的引擎。只能在创建它的线程上使用
+    class ThreadStorage
+    {
+    public:
+        explicit ThreadStorage(const QString &prefix);
+        ~ThreadStorage();
+        ThreadStorage(const ThreadStorage&) = delete;
+        ThreadStorage& operator=(const ThreadStorage&) = delete;
+
+        StorageBackend *storage() const { return m_storage; }  // 打开连接失败时为nullptr
+
+    private:
+        QString m_connectionName;
+        SqliteBackend *m_sqlite;
+        StorageBackend *m_storage;
+    };
+
+    // 表单相关方法
+    bool addForm(const QString &name) override;
+    bool updateForm(int id, const QString &name) override;
+    bool deleteForm(int id) override;  // 不能删除最后一个表单
+    QList<FormEntry> getAllForms() override;  // 按名称排序，结果缓存在内存中
+    FormEntry getFormById(int id);
+    void invalidateFormCache();  // 绕过上面的方法直接修改forms表后调用（例如从备份恢复）
+    QHash<int, FormStats> getFormStats() override;  // 所有表单的记录数，一次读取，与记录总数无关
+
+    // 按passwords表重新计算form_stats（批量写入时先删除触发器的工具使用）
+    static bool rebuildFormStats(QSqlDatabase connection);
+
+    // 密码相关方法
+    bool addPassword(int form_id, const QString &website, const QString &username,
+                     const QString &account, const QString &password, const QString &notes) override;  // form_id <= 0 时使用第一个表单
+    bool updatePassword(int id, int form_id, const QString &website,
+                        const QString &username, const QString &account,
+                        const QString &password, const QString &notes) override;
+    // 只修改一个字段（账号和密码传入加密后的值），不预先查询重复记录；
+    // 与同表单中已有记录的网站、用户名和账号组合冲突时返回false并设置conflict
+    bool updateField(int id, EntryField field, const QString &value, bool *conflict = nullptr) override;
+    bool deletePassword(int id) override;
+    int deletePasswords(const QList<int> &ids) override;  // 在一个事务中批量删除，返回删除的条数，失败返回-1（全部回滚）
+
+    // 批量移动/复制到另一个表单；目标表单中已有相同网站、用户名和账号的记录时
+    // SkipConflicts跳过该条，ReplaceConflicts替换目标表单中的旧记录
+    // 返回移动/复制的条数，失败返回-1（全部回滚）；conflictCount返回跳过或替换的条数
+    int movePasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, int *conflictCount = nullptr);
+    int copyPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, int *conflictCount = nullptr);
+    int transferPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, bool copy,
+                          int *conflictCount) override;
+    bool deletePasswordByWebsite(const QString &website) override;
+    QList<PasswordEntry> getAllPasswords(int form_id = -1) override;  // -1 表示所有表单
+    QList<PasswordEntry> searchPasswords(const QString &keyword, const QList<int> &form_ids = QList<int>()) override;
+    QList<PasswordEntry> getPasswordsByIds(const QList<int> &ids) override;  // 按ID批量获取，结果按ID递增排序
+    QList<PasswordEntry> getPasswordsAfter(int form_id, int afterId, int limit) override;  // 按ID分页读取（id > afterId）
+    int countPasswords(int form_id = -1) override;
+
+    int beginTransaction() override;
+    bool commitTransaction(int level) override;
+    void rollbackTransaction(int level) override;
+    int transactionDepth() const override;
+    bool exportToCSV(const QString &filename, int form_id = -1);
+    bool importFromCSV(const QString &filename, int form_id = 1);  // 默认导入到第一个表单
+
+    // 热备份：在调用线程上用独立连接生成一致的数据库快照，期间其他连接可以继续读写
+    // 进度回调参数为剩余页数和总页数，返回false表示取消
+    typedef std::function<bool(int remaining, int total)> BackupProgress;
+    bool backupTo(const QString &filename, const BackupProgress &progress = BackupProgress(), int pagesPerStep = 64);
+
+    // 后台线程使用的独立连接（QSqlDatabase连接不能跨线程使用）
+    QString databasePath() const { return dbPath; }
+    QString openThreadConnection(const QString &prefix);
+    static void closeThreadConnection(const QString &connectionName);
+
+    // 在指定的（线程）连接上按ID分页读取一个表单的全部记录，每页之间检查cancelled，取消或出错返回false
+    // 分页读取让每条SELECT只短暂持有读锁，主连接的写入不会被长时间阻塞
+    static bool readFormPasswords(const QString &connectionName, int form_id, QList<PasswordEntry> &entries,
+                                  const std::function<bool()> &cancelled, int pageSize = 2000);
+
+    // 读取密码记录时直接使用SQLite C API（编译时启用PM_HAVE_SQLITE3_API才可用），默认开启
+    // 关闭后回到QSqlQuery路径，基准测试用来对比两者
+    static void setNativeReads(bool enabled);
+    static bool nativeReadsEnabled();
+
+private:
+    Database();
+    ~Database();
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+
+    QSqlDatabase db;
+    QString dbPath;
+    SqliteBackend *sqliteStorage;     // 默认连接上的SQLite引擎，始终存在
+    StorageBackend *currentStorage;   // 当前使用的引擎，不是sqliteStorage时由Database拥有
+
+    // 表单缓存，导入工作线程也会读取，用互斥锁保护
+    QMutex formCacheMutex;
+    QList<FormEntry> formCache;
+    bool formCacheValid;
+    int formCacheGeneration;  // 每次失效加一，避免把失效前查到的结果写回缓存
+    bool migrate();
+    bool createTables();
+    bool createFormStats();
+};
+
+#endif // DATABASE_H
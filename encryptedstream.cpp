@@ -0,0 +1,486 @@
+#include "encryptedstream.h"
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <QDebug>
+#ifdef PM_HAVE_OPENSSL
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#endif
+
+static const char ARCHIVE_MAGIC[8] = { 'P', 'M', 'E', 'N', 'C', '\0', '\0', '\0' };
+static const quint32 ARCHIVE_VERSION = 1;
+static const int HEADER_SIZE = 44;
+static const int SALT_SIZE = 16;
+static const int NONCE_PREFIX_SIZE = 8;
+static const int KEY_SIZE = 32;
+static const int TAG_SIZE = 16;
+static const quint32 DEFAULT_CHUNK_SIZE = 1024 * 1024;
+static const quint32 MAX_CHUNK_SIZE = 64 * 1024 * 1024;
+static const quint32 KDF_ITERATIONS = 200000;
+static const quint32 MAX_KDF_ITERATIONS = KDF_ITERATIONS * 10;  // 读取时的上限，防止损坏或恶意的文件头让密钥派生耗时过长
+static const quint32 FINAL_FLAG = 0x80000000u;
+
+#ifdef PM_HAVE_OPENSSL
+// 加密一个数据块，输出为密文+认证标签
+static EncryptedChunk sealChunk(const QByteArray &key, const QByteArray &nonce,
+                                const QByteArray &aad, const QByteArray &plain)
+{
+    EncryptedChunk result;
+    result.data.resize(plain.size() + TAG_SIZE);
+    unsigned char *out = reinterpret_cast<unsigned char *>(result.data.data());
+
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int len = 0;
+    int total = 0;
+    result.ok = ctx
+                && EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1
+                && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, nonce.size(), nullptr) == 1
+                && EVP_EncryptInit_ex(ctx, nullptr, nullptr,
+                                      reinterpret_cast<const unsigned char *>(key.constData()),
+                                      reinterpret_cast<const unsigned char *>(nonce.constData())) == 1
+                && EVP_EncryptUpdate(ctx, nullptr, &len,
+                                     reinterpret_cast<const unsigned char *>(aad.constData()), aad.size()) == 1
+                && EVP_EncryptUpdate(ctx, out, &len,
+                                     reinterpret_cast<const unsigned char *>(plain.constData()), plain.size()) == 1;
+    total = len;
+    result.ok = result.ok
+                && EVP_EncryptFinal_ex(ctx, out + total, &len) == 1
+                && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_SIZE, out + total + len) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    return result;
+}
+
+// 解密并校验一个数据块，输入为密文+认证标签
+static EncryptedChunk openChunk(const QByteArray &key, const QByteArray &nonce,
+                                const QByteArray &aad, const QByteArray &sealed)
+{
+    EncryptedChunk result;
+    result.ok = false;
+    if (sealed.size() < TAG_SIZE) {
+        return result;
+    }
+
+    int cipherSize = sealed.size() - TAG_SIZE;
+    result.data.resize(cipherSize);
+    unsigned char *out = reinterpret_cast<unsigned char *>(result.data.data());
+    QByteArray tag = sealed.right(TAG_SIZE);
+
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int len = 0;
+    result.ok = ctx
+                && EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1
+                && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, nonce.size(), nullptr) == 1
+                && EVP_DecryptInit_ex(ctx, nullptr, nullptr,
+                                      reinterpret_cast<const unsigned char *>(key.constData()),
+                                      reinterpret_cast<const unsigned char *>(nonce.constData())) == 1
+                && EVP_DecryptUpdate(ctx, nullptr, &len,
+                                     reinterpret_cast<const unsigned char *>(aad.constData()), aad.size()) == 1
+                && EVP_DecryptUpdate(ctx, out, &len,
+                                     reinterpret_cast<const unsigned char *>(sealed.constData()), cipherSize) == 1
+                && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, TAG_SIZE, tag.data()) == 1
+                && EVP_DecryptFinal_ex(ctx, out + len, &len) > 0;
+    EVP_CIPHER_CTX_free(ctx);
+
+    if (!result.ok) {
+        result.data.clear();
+    }
+    return result;
+}
+#endif
+
+EncryptedStream::EncryptedStream(const QString &filename, const QString &passphrase, QObject *parent)
+    : QIODevice(parent)
+    , m_file(filename)
+    , m_passphrase(passphrase)
+    , m_chunkSize(DEFAULT_CHUNK_SIZE)
+    , m_nextChunk(0)
+    , m_sawFinal(false)
+    , m_error(false)
+    , m_maxInFlight(qMax(2, QThreadPool::globalInstance()->maxThreadCount() * 2))
+    , m_bufferPos(0)
+{
+}
+
+EncryptedStream::~EncryptedStream()
+{
+    if (isOpen()) {
+        close();
+    }
+}
+
+bool EncryptedStream::isSupported()
+{
+#ifdef PM_HAVE_OPENSSL
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool EncryptedStream::isEncryptedArchive(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return file.read(8) == QByteArray(ARCHIVE_MAGIC, 8);
+}
+
+bool EncryptedStream::open(OpenMode mode)
+{
+    bool reading = mode.testFlag(QIODevice::ReadOnly);
+    bool writing = mode.testFlag(QIODevice::WriteOnly);
+    if (reading == writing) {
+        setErrorString("加密文件只支持只读或只写");
+        return false;
+    }
+
+    if (!isSupported()) {
+        setErrorString("未启用加密导出支持（需要在编译时启用OpenSSL）");
+        return false;
+    }
+
+    if (m_passphrase.isEmpty()) {
+        setErrorString("未设置口令");
+        return false;
+    }
+
+    if (!m_file.open(reading ? QIODevice::ReadOnly : (QIODevice::WriteOnly | QIODevice::Truncate))) {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+
+    m_pending.clear();
+    m_buffer.clear();
+    m_bufferPos = 0;
+    m_nextChunk = 0;
+    m_sawFinal = false;
+    m_error = false;
+
+    bool ok = reading ? readHeader() : writeHeader();
+    m_passphrase.clear();  // 密钥派生完成后不再保留口令
+    if (!ok) {
+        QString error = errorString();
+        m_file.close();
+        setErrorString(error);
+        return false;
+    }
+
+    return QIODevice::open(mode);
+}
+
+void EncryptedStream::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    if (openMode().testFlag(QIODevice::WriteOnly)) {
+        // 剩余的明文（可能为空）作为最后一块，带上结束标记
+        if (!m_error) {
+            submitWrite(m_buffer, true);
+            m_buffer.clear();
+        }
+        writeCompleted(true);
+        if (!m_error && !m_file.flush()) {
+            setStreamError(m_file.errorString());
+        }
+    } else {
+        // 等待仍在线程池中运行的解密任务结束
+        while (!m_pending.isEmpty()) {
+            m_pending.dequeue().waitForFinished();
+        }
+    }
+
+    QString error = errorString();
+    m_file.close();
+    m_key.fill('\0');
+    m_key.clear();
+    m_buffer.clear();
+    m_bufferPos = 0;
+
+    QIODevice::close();
+    if (m_error) {
+        setErrorString(error);
+    }
+}
+
+bool EncryptedStream::writeHeader()
+{
+#ifdef PM_HAVE_OPENSSL
+    QByteArray salt(SALT_SIZE, '\0');
+    m_noncePrefix.fill('\0', NONCE_PREFIX_SIZE);
+    if (RAND_bytes(reinterpret_cast<unsigned char *>(salt.data()), SALT_SIZE) != 1
+        || RAND_bytes(reinterpret_cast<unsigned char *>(m_noncePrefix.data()), NONCE_PREFIX_SIZE) != 1) {
+        setErrorString("无法生成随机数");
+        return false;
+    }
+
+    m_header = QByteArray(ARCHIVE_MAGIC, 8);
+    char buffer[4];
+    qToLittleEndian(ARCHIVE_VERSION, buffer);
+    m_header.append(buffer, 4);
+    qToLittleEndian(m_chunkSize, buffer);
+    m_header.append(buffer, 4);
+    qToLittleEndian(KDF_ITERATIONS, buffer);
+    m_header.append(buffer, 4);
+    m_header.append(salt);
+    m_header.append(m_noncePrefix);
+
+    QByteArray passphrase = m_passphrase.toUtf8();
+    m_key.fill('\0', KEY_SIZE);
+    if (PKCS5_PBKDF2_HMAC(passphrase.constData(), passphrase.size(),
+                          reinterpret_cast<const unsigned char *>(salt.constData()), SALT_SIZE,
+                          static_cast<int>(KDF_ITERATIONS), EVP_sha256(),
+                          KEY_SIZE, reinterpret_cast<unsigned char *>(m_key.data())) != 1) {
+        setErrorString("密钥派生失败");
+        return false;
+    }
+    passphrase.fill('\0');
+
+    if (m_file.write(m_header) != m_header.size()) {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool EncryptedStream::readHeader()
+{
+#ifdef PM_HAVE_OPENSSL
+    m_header = m_file.read(HEADER_SIZE);
+    if (m_header.size() != HEADER_SIZE || !m_header.startsWith(QByteArray(ARCHIVE_MAGIC, 8))) {
+        setErrorString("不是有效的加密导出文件");
+        return false;
+    }
+
+    quint32 version = qFromLittleEndian<quint32>(m_header.constData() + 8);
+    m_chunkSize = qFromLittleEndian<quint32>(m_header.constData() + 12);
+    quint32 iterations = qFromLittleEndian<quint32>(m_header.constData() + 16);
+    if (version != ARCHIVE_VERSION || m_chunkSize == 0 || m_chunkSize > MAX_CHUNK_SIZE
+        || iterations == 0 || iterations > MAX_KDF_ITERATIONS) {
+        setErrorString("不支持的加密文件版本或文件头已损坏");
+        return false;
+    }
+
+    QByteArray salt = m_header.mid(20, SALT_SIZE);
+    m_noncePrefix = m_header.mid(20 + SALT_SIZE, NONCE_PREFIX_SIZE);
+
+    QByteArray passphrase = m_passphrase.toUtf8();
+    m_key.fill('\0', KEY_SIZE);
+    if (PKCS5_PBKDF2_HMAC(passphrase.constData(), passphrase.size(),
+                          reinterpret_cast<const unsigned char *>(salt.constData()), SALT_SIZE,
+                          static_cast<int>(iterations), EVP_sha256(),
+                          KEY_SIZE, reinterpret_cast<unsigned char *>(m_key.data())) != 1) {
+        setErrorString("密钥派生失败");
+        return false;
+    }
+    passphrase.fill('\0');
+    return true;
+#else
+    return false;
+#endif
+}
+
+QByteArray EncryptedStream::chunkNonce(quint64 index) const
+{
+    // 12字节nonce：8字节随机前缀 + 4字节块序号（大端）
+    char counter[4];
+    qToBigEndian(static_cast<quint32>(index), counter);
+    QByteArray nonce = m_noncePrefix;
+    nonce.append(counter, 4);
+    return nonce;
+}
+
+QByteArray EncryptedStream::chunkAad(quint64 index, bool final) const
+{
+    char buffer[8];
+    qToLittleEndian(index, buffer);
+    QByteArray aad = m_header;
+    aad.append(buffer, 8);
+    aad.append(final ? '\1' : '\0');
+    return aad;
+}
+
+void EncryptedStream::setStreamError(const QString &error)
+{
+    if (!m_error) {
+        qDebug() << "加密文件错误:" << m_file.fileName() << error;
+    }
+    m_error = true;
+    setErrorString(error);
+}
+
+// ---------- 写入 ----------
+
+qint64 EncryptedStream::writeData(const char *data, qint64 maxSize)
+{
+    if (m_error) {
+        return -1;
+    }
+
+    m_buffer.append(data, static_cast<int>(maxSize));
+
+    // 只有确定后面还有数据时才提交整块，最后一块留到close()时带上结束标记
+    int offset = 0;
+    while (m_buffer.size() - offset > static_cast<int>(m_chunkSize)) {
+        submitWrite(m_buffer.mid(offset, static_cast<int>(m_chunkSize)), false);
+        offset += static_cast<int>(m_chunkSize);
+        if (!writeCompleted(false)) {
+            return -1;
+        }
+    }
+    if (offset > 0) {
+        m_buffer.remove(0, offset);
+    }
+    return maxSize;
+}
+
+void EncryptedStream::submitWrite(const QByteArray &plain, bool final)
+{
+#ifdef PM_HAVE_OPENSSL
+    if (m_nextChunk > 0xFFFFFFFFull) {
+        setStreamError("文件过大，超过了加密块数量上限");
+        return;
+    }
+
+    QByteArray key = m_key;
+    QByteArray nonce = chunkNonce(m_nextChunk);
+    QByteArray aad = chunkAad(m_nextChunk, final);
+    quint32 length = static_cast<quint32>(plain.size()) | (final ? FINAL_FLAG : 0);
+    m_nextChunk++;
+
+    m_pending.enqueue(QtConcurrent::run(QThreadPool::globalInstance(), [key, nonce, aad, plain, length]() {
+        EncryptedChunk sealed = sealChunk(key, nonce, aad, plain);
+        char buffer[4];
+        qToLittleEndian(length, buffer);
+        sealed.data.prepend(buffer, 4);
+        return sealed;
+    }));
+#else
+    Q_UNUSED(plain);
+    Q_UNUSED(final);
+#endif
+}
+
+bool EncryptedStream::writeCompleted(bool waitAll)
+{
+    // 按提交顺序写出已完成的块；在途块超过上限或要求全部完成时阻塞等待
+    while (!m_pending.isEmpty()
+           && (waitAll || m_pending.size() >= m_maxInFlight || m_pending.head().isFinished())) {
+        EncryptedChunk chunk = m_pending.dequeue().result();
+        if (m_error) {
+            continue;
+        }
+        if (!chunk.ok) {
+            setStreamError("加密数据块失败");
+        } else if (m_file.write(chunk.data) != chunk.data.size()) {
+            setStreamError(m_file.errorString());
+        }
+    }
+    return !m_error;
+}
+
+// ---------- 读取 ----------
+
+bool EncryptedStream::readAhead()
+{
+#ifdef PM_HAVE_OPENSSL
+    // 读取后续的块并提交到线程池并行解密，在途块数量有上限
+    while (!m_sawFinal && !m_error && m_pending.size() < m_maxInFlight) {
+        QByteArray lengthBytes = m_file.read(4);
+        if (lengthBytes.size() != 4) {
+            setStreamError("加密文件不完整（缺少最后一块），文件可能被截断");
+            return false;
+        }
+
+        quint32 length = qFromLittleEndian<quint32>(lengthBytes.constData());
+        bool final = (length & FINAL_FLAG) != 0;
+        quint32 plainSize = length & ~FINAL_FLAG;
+        if (plainSize > m_chunkSize || (!final && plainSize != m_chunkSize)) {
+            setStreamError(QString("第 %1 块长度异常，文件可能已损坏").arg(m_nextChunk + 1));
+            return false;
+        }
+
+        QByteArray sealed = m_file.read(static_cast<qint64>(plainSize) + TAG_SIZE);
+        if (sealed.size() != static_cast<int>(plainSize) + TAG_SIZE) {
+            setStreamError("加密文件不完整，文件可能被截断");
+            return false;
+        }
+
+        QByteArray key = m_key;
+        QByteArray nonce = chunkNonce(m_nextChunk);
+        QByteArray aad = chunkAad(m_nextChunk, final);
+        m_nextChunk++;
+        m_sawFinal = final;
+
+        m_pending.enqueue(QtConcurrent::run(QThreadPool::globalInstance(), [key, nonce, aad, sealed]() {
+            return openChunk(key, nonce, aad, sealed);
+        }));
+    }
+
+    if (m_sawFinal && !m_file.atEnd()) {
+        setStreamError("加密文件在最后一块之后还有多余数据");
+        return false;
+    }
+    return !m_error;
+#else
+    return false;
+#endif
+}
+
+bool EncryptedStream::nextReadChunk()
+{
+    m_buffer.clear();
+    m_bufferPos = 0;
+
+    while (m_buffer.isEmpty()) {
+        if (!readAhead() && m_pending.isEmpty()) {
+            return false;
+        }
+        if (m_pending.isEmpty()) {
+            return false;  // 已读完最后一块
+        }
+
+        quint64 index = m_nextChunk - static_cast<quint64>(m_pending.size()) + 1;
+        EncryptedChunk chunk = m_pending.dequeue().result();
+        if (!chunk.ok) {
+            setStreamError(QString("第 %1 块认证失败：口令错误或文件已损坏").arg(index));
+            // 认证失败之后的块一律丢弃
+            while (!m_pending.isEmpty()) {
+                m_pending.dequeue().waitForFinished();
+            }
+            return false;
+        }
+        m_buffer = chunk.data;  // 空块（只有结束标记）会继续取下一块
+    }
+    return true;
+}
+
+qint64 EncryptedStream::bytesAvailable() const
+{
+    qint64 available = QIODevice::bytesAvailable() + (m_buffer.size() - m_bufferPos);
+    bool moreChunks = !m_pending.isEmpty() || (!m_sawFinal && !m_error);
+    if (openMode().testFlag(QIODevice::ReadOnly) && available == 0 && moreChunks) {
+        // 还有未解密的块，报告有数据可读，实际数据在readData中按需等待
+        return 1;
+    }
+    return available;
+}
+
+qint64 EncryptedStream::readData(char *data, qint64 maxSize)
+{
+    // 读取方向上出错前已经提交的块仍然按顺序交付，出错位置之后才返回-1
+    if (m_bufferPos >= m_buffer.size() && !nextReadChunk()) {
+        return m_error ? -1 : 0;
+    }
+
+    qint64 count = qMin(maxSize, static_cast<qint64>(m_buffer.size() - m_bufferPos));
+    memcpy(data, m_buffer.constData() + m_bufferPos, static_cast<size_t>(count));
+    m_bufferPos += static_cast<int>(count);
+    return count;
+}
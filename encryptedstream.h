@@ -0,0 +1,75 @@
+#ifndef ENCRYPTEDSTREAM_H
+#define ENCRYPTEDSTREAM_H
+
+#include <QIODevice>
+#include <QFile>
+#include <QQueue>
+#include <QFuture>
+#include <QByteArray>
+
+// 加密导出文件（.pmenc）：
+//
+//   文件头（44字节）：magic[8] = "PMENC\0\0\0"，quint32 版本号，quint32 块大小，
+//     quint32 PBKDF2迭代次数，salt[16]，nonce前缀[8]（整数均为小端序）
+//   数据块（重复）：quint32 长度（最高位表示最后一块），密文，16字节GCM认证标签
+//
+// 明文按固定大小切块，每块用AES-256-GCM单独加密，密钥由口令经PBKDF2-SHA256派生
+// nonce = nonce前缀 + 块序号；附加认证数据 = 文件头 + 块序号 + 是否最后一块，
+// 因此块被篡改、调换顺序或文件被截断都能在对应的块上发现，不需要读完整个文件
+// 除最后一块外每块长度相同，可以直接计算任意块的偏移；加解密在线程池中按块并行，内存占用固定
+struct EncryptedChunk {
+    bool ok;
+    QByteArray data;
+};
+
+class EncryptedStream : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    EncryptedStream(const QString &filename, const QString &passphrase, QObject *parent = nullptr);
+    ~EncryptedStream() override;
+
+    static bool isSupported();  // 编译时是否启用了OpenSSL
+    static bool isEncryptedArchive(const QString &filename);
+
+    bool open(OpenMode mode) override;  // 只支持ReadOnly或WriteOnly
+    void close() override;
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+    qint64 archivePos() const { return m_file.pos(); }  // 已读取/写入的文件字节数，用于显示进度
+    bool hasError() const { return m_error; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    bool writeHeader();
+    bool readHeader();
+    QByteArray chunkNonce(quint64 index) const;
+    QByteArray chunkAad(quint64 index, bool final) const;
+    void submitWrite(const QByteArray &plain, bool final);
+    bool writeCompleted(bool waitAll);
+    bool readAhead();
+    bool nextReadChunk();
+    void setStreamError(const QString &error);
+
+    QFile m_file;
+    QString m_passphrase;
+    QByteArray m_key;
+    QByteArray m_header;
+    QByteArray m_noncePrefix;
+    quint32 m_chunkSize;
+    quint64 m_nextChunk;  // 下一个提交加解密的块序号
+    bool m_sawFinal;      // 读取时已经遇到最后一块
+    bool m_error;
+    int m_maxInFlight;
+
+    QQueue<QFuture<EncryptedChunk>> m_pending;  // 按块序号排列的在途任务
+    QByteArray m_buffer;  // 写入时为未满一块的明文，读取时为当前已解密的明文
+    int m_bufferPos;
+};
+
+#endif // ENCRYPTEDSTREAM_H
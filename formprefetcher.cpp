@@ -0,0 +1,181 @@
+#include "formprefetcher.h"
+#include "encryption.h"
+#include <QTimer>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+
+static const int IDLE_DELAY_MS = 300;  // 界面空闲多久后开始预读
+
+FormPrefetcher::FormPrefetcher(int maxCachedRows, QObject *parent)
+    : QObject(parent)
+    , m_maxCachedRows(maxCachedRows)
+    , m_cachedRows(0)
+    , m_idleTimer(new QTimer(this))
+    , m_runningFormId(-1)
+{
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(IDLE_DELAY_MS);
+    connect(m_idleTimer, &QTimer::timeout, this, &FormPrefetcher::startNext);
+    connect(&m_watcher, &QFutureWatcher<PrefetchedForm>::finished, this, &FormPrefetcher::onPrefetchFinished);
+}
+
+FormPrefetcher::~FormPrefetcher()
+{
+    // 后台任务使用自己的数据库连接，等它结束后再销毁
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+bool FormPrefetcher::take(int formId, PrefetchedForm &form)
+{
+    if (!m_cache.contains(formId)) {
+        return false;
+    }
+    form = m_cache.take(formId);
+    m_recentlyUsed.removeAll(formId);
+    m_cachedRows -= form.entries.size();
+    qDebug() << "使用预读的表单" << formId << "记录数:" << form.entries.size();
+    return true;
+}
+
+void FormPrefetcher::schedule(const QList<int> &formIds)
+{
+    m_queue.clear();
+    for (int formId : formIds) {
+        if (formId >= 0 && formId != m_runningFormId && !m_cache.contains(formId) &&
+            !m_tooLarge.contains(formId) && !m_queue.contains(formId)) {
+            m_queue.append(formId);
+        }
+    }
+    if (!m_queue.isEmpty() && !m_watcher.isRunning()) {
+        m_idleTimer->start();
+    }
+}
+
+void FormPrefetcher::cancel()
+{
+    m_idleTimer->stop();
+    m_queue.clear();
+    if (m_cancelFlag) {
+        m_cancelFlag->storeRelease(1);
+    }
+}
+
+void FormPrefetcher::clear()
+{
+    cancel();
+    m_cache.clear();
+    m_recentlyUsed.clear();
+    m_tooLarge.clear();
+    m_cachedRows = 0;
+}
+
+void FormPrefetcher::recordOpen(int formId)
+{
+    m_openCounts[formId] += 1;
+}
+
+QList<int> FormPrefetcher::mostOpenedForms(int count) const
+{
+    QList<QPair<int, int>> counts;
+    for (auto it = m_openCounts.constBegin(); it != m_openCounts.constEnd(); ++it) {
+        counts.append(qMakePair(it.value(), it.key()));
+    }
+    std::sort(counts.begin(), counts.end(), [](const QPair<int, int> &a, const QPair<int, int> &b) {
+        return a.first > b.first;
+    });
+
+    QList<int> formIds;
+    for (int i = 0; i < counts.size() && i < count; ++i) {
+        formIds.append(counts[i].second);
+    }
+    return formIds;
+}
+
+void FormPrefetcher::startNext()
+{
+    if (m_watcher.isRunning() || m_queue.isEmpty()) {
+        return;
+    }
+
+    int formId = m_queue.takeFirst();
+    m_runningFormId = formId;
+    m_cancelFlag.reset(new QAtomicInt(0));
+    QSharedPointer<QAtomicInt> cancelFlag = m_cancelFlag;
+    int maxRows = m_maxCachedRows;
+
+    m_watcher.setFuture(QtConcurrent::run(QThreadPool::globalInstance(), [formId, cancelFlag, maxRows]() {
+        PrefetchedForm form;
+        auto cancelled = [cancelFlag, &form, maxRows]() {
+            // 超过缓存上限的表单不预读
+            return cancelFlag->loadAcquire() != 0 || form.entries.size() > maxRows;
+        };
+
+        QString connectionName = Database::instance().openThreadConnection("prefetch");
+        if (connectionName.isEmpty()) {
+            cancelFlag->storeRelease(1);
+            return form;
+        }
+        bool ok = Database::readFormPasswords(connectionName, formId, form.entries, cancelled);
+        Database::closeThreadConnection(connectionName);
+        if (!ok) {
+            form.tooLarge = form.entries.size() > maxRows;
+            form.entries.clear();
+            if (!form.tooLarge) {
+                cancelFlag->storeRelease(1);  // 读取失败，结果不放入缓存
+            }
+            return form;
+        }
+
+        form.accounts.reserve(form.entries.size());
+        form.passwords.reserve(form.entries.size());
+        for (const auto &entry : form.entries) {
+            if (cancelFlag->loadAcquire() != 0) {
+                return PrefetchedForm();
+            }
+            form.accounts.append(Encryption::decrypt(entry.account));
+            form.passwords.append(Encryption::decrypt(entry.password));
+        }
+        return form;
+    }));
+}
+
+void FormPrefetcher::onPrefetchFinished()
+{
+    int formId = m_runningFormId;
+    m_runningFormId = -1;
+
+    // 取消之后完成的结果可能已经过期，直接丢弃
+    if (m_cancelFlag && m_cancelFlag->loadAcquire() == 0) {
+        PrefetchedForm form = m_watcher.result();
+        if (form.tooLarge) {
+            m_tooLarge.insert(formId);
+        } else if (form.accounts.size() == form.entries.size()) {
+            insert(formId, form);
+        }
+    }
+    m_cancelFlag.reset();
+
+    if (!m_queue.isEmpty()) {
+        m_idleTimer->start();
+    }
+}
+
+void FormPrefetcher::insert(int formId, const PrefetchedForm &form)
+{
+    if (form.entries.size() > m_maxCachedRows) {
+        return;
+    }
+
+    // 淘汰最久未用的表单，直到放得下
+    while (!m_recentlyUsed.isEmpty() && m_cachedRows + form.entries.size() > m_maxCachedRows) {
+        int oldest = m_recentlyUsed.takeFirst();
+        m_cachedRows -= m_cache.take(oldest).entries.size();
+    }
+
+    m_cache.insert(formId, form);
+    m_recentlyUsed.append(formId);
+    m_cachedRows += form.entries.size();
+    qDebug() << "预读表单" << formId << "完成，记录数:" << form.entries.size() << "缓存记录数:" << m_cachedRows;
+}
@@ -0,0 +1,70 @@
+#ifndef FORMPREFETCHER_H
+#define FORMPREFETCHER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include "database.h"
+
+class QTimer;
+
+// 空闲时在后台连接上预读可能马上要打开的表单（相邻标签、最常打开的表单），
+// 账号和密码也预先解密，切换标签时直接从内存显示
+// 缓存按总记录数限制大小，最久未用的表单先被淘汰；有真正的加载或写入时取消正在进行的预读
+class FormPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct PrefetchedForm {
+        QList<PasswordEntry> entries;
+        QStringList accounts;   // 解密后的账号，与entries一一对应
+        QStringList passwords;  // 解密后的密码
+        bool tooLarge = false;  // 超过缓存上限，没有读完
+    };
+
+    explicit FormPrefetcher(int maxCachedRows, QObject *parent = nullptr);
+    ~FormPrefetcher();
+
+    // 取出缓存的表单（取出后从缓存中删除），没有时返回false
+    bool take(int formId, PrefetchedForm &form);
+    bool contains(int formId) const { return m_cache.contains(formId); }
+
+    // 按顺序排队预读，空闲一段时间后开始；替换之前尚未开始的队列
+    void schedule(const QList<int> &formIds);
+    // 停止正在进行和排队的预读，已缓存的数据保留
+    void cancel();
+    // 数据库被修改后调用：取消预读并清空缓存
+    void clear();
+
+    // 记录表单被打开的次数，用于挑选最常打开的表单
+    void recordOpen(int formId);
+    QList<int> mostOpenedForms(int count) const;
+
+private slots:
+    void startNext();
+    void onPrefetchFinished();
+
+private:
+    void insert(int formId, const PrefetchedForm &form);
+
+    int m_maxCachedRows;
+    int m_cachedRows;
+    QHash<int, PrefetchedForm> m_cache;
+    QList<int> m_recentlyUsed;  // 缓存中的表单，最近放入的在最后
+    QList<int> m_queue;
+    QHash<int, int> m_openCounts;
+    QSet<int> m_tooLarge;  // 放不进缓存的表单，不再预读
+
+    QTimer *m_idleTimer;
+    QFutureWatcher<PrefetchedForm> m_watcher;
+    QSharedPointer<QAtomicInt> m_cancelFlag;  // 正在进行的预读的取消标志
+    int m_runningFormId;
+};
+
+#endif // FORMPREFETCHER_H
@@ -1,54 +1,61 @@
-#ifndef FORMTABWIDGET_H
-#define FORMTABWIDGET_H
-
-#include <QWidget>
-#include <QTabBar>
-#include <QPushButton>
-#include <QLabel>
-#include <QHBoxLayout>
-#include <QList>
-#include <QInputDialog>
-#include <QMessageBox>
-#include <QMap>
-
-class FormTabWidget : public QWidget
-{
-    Q_OBJECT
-
-public:
-    explicit FormTabWidget(QWidget *parent = nullptr);
-
-    void addForm(int id, const QString &name, bool setCurrent = false);
-    void removeForm(int id);
-    void updateForm(int id, const QString &name);
-    void setCurrentForm(int id);
-    int currentFormId() const;
-    QString currentFormName() const;
-    QList<int> allFormIds() const;
-    QList<int> selectedFormIds() const;
-    void setSelectedForms(const QList<int> &formIds);
-    void clearSelection();
-    void clear();  // 新增：清空所有标签
-
-signals:
-    void formAdded(int id, const QString &name);
-    void formRemoved(int id);
-    void formRenamed(int id, const QString &newName);
-    void currentFormChanged(int id);
-    void formSelectionChanged(const QList<int> &selectedIds);
-
-public slots:
-    void onAddFormClicked();
-    void onTabDoubleClicked(int index);
-    void onTabCloseRequested(int index);
-    void onTabCurrentChanged(int index);
-
-private:
-    QTabBar *tabBar;
-    QPushButton *addButton;
-    QMap<int, int> formIdToTabIndex;  // 表单ID到标签页索引的映射
-    QMap<int, int> tabIndexToFormId;  // 标签页索引到表单ID的映射
-    QList<int> selectedForms;  // 选中的表单ID列表
-};
-
-#endif // FORMTABWIDGET_H
+#ifndef FORMTABWIDGET_H
+#define FORMTABWIDGET_H
+
+#include <QWidget>
+#include <QTabBar>
+#include <QPushButton>
+#include <QLabel>
+#include <QHBoxLayout>
+#include <QList>
+#include <QHash>
+#include <QInputDialog>
+#include <QMessageBox>
+
+class FormTabWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FormTabWidget(QWidget *parent = nullptr);
+
+    void addForm(int id, const QString &name, bool setCurrent = false);
+    void removeForm(int id);
+    void updateForm(int id, const QString &name);
+    void setFormCounts(const QHash<int, int> &counts);  // 标签上显示的记录数，没有的表单不显示
+    void setCurrentForm(int id);
+    int currentFormId() const;
+    QString currentFormName() const;
+    QList<int> allFormIds() const;
+    QList<int> adjacentFormIds(int id) const;  // 按标签顺序紧邻的表单（右侧在前）
+    QList<int> selectedFormIds() const;
+    void setSelectedForms(const QList<int> &formIds);
+    void clearSelection();
+    void clear();  // 新增：清空所有标签
+
+signals:
+    void formAdded(int id, const QString &name);
+    void formRemoved(int id);
+    void formRenamed(int id, const QString &newName);
+    void currentFormChanged(int id);
+    void formSelectionChanged(const QList<int> &selectedIds);
+
+public slots:
+    void onAddFormClicked();
+    void onTabDoubleClicked(int index);
+    void onTabCloseRequested(int index);
+    void onTabCurrentChanged(int index);
+
+private:
+    int indexOfForm(int id) const;  // 找不到返回-1
+    int formIdAt(int index) const;  // 无效索引返回-1
+    void updateTabText(int index);
+
+    QTabBar *tabBar;
+    QPushButton *addButton;
+    int lastCurrentFormId;  // 上次发出currentFormChanged的表单ID
+    QHash<int, QString> formNames;  // 表单名称（标签文字中还带有记录数）
+    QHash<int, int> formCounts;
+    QList<int> selectedForms;  // 选中的表单ID列表
+};
+
+#endif // FORMTABWIDGET_H
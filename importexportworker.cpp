@@ -1,361 +1,930 @@
-#include "importexportworker.h"
-#include "encryption.h"
-#include <QFile>
-#include <QTextStream>
-#include <QDebug>
-#include <QCoreApplication>
-#include <QStandardItemModel>
-#include <QSqlDatabase>
-#include <QSqlQuery>
-
-              // CSV字段转义函数（复制自database.cpp，稍作修改）
-              static QString escapeCSVField(const QString &field)
-{
-    QString escaped = field;
-
-    // 检查是否需要引号（包含逗号、双引号或换行符）
-    bool needsQuotes = escaped.contains(',') ||
-                       escaped.contains('"') ||
-                       escaped.contains('\n') ||
-                       escaped.contains('\r');
-
-    // 转义双引号
-    escaped.replace("\"", "\"\"");
-
-    // 如果需要引号，则添加引号
-    if (needsQuotes || escaped.startsWith(' ') || escaped.endsWith(' ')) {
-        escaped = "\"" + escaped + "\"";
-    }
-
-    return escaped;
-}
-
-// CSV行解析函数（复制自database.cpp）
-static QStringList parseCSVLine(const QString &line)
-{
-    QStringList fields;
-    QString field;
-    bool inQuotes = false;
-
-    for (int i = 0; i < line.length(); ++i) {
-        QChar ch = line[i];
-
-        if (ch == '"') {
-            if (i + 1 < line.length() && line[i + 1] == '"') {
-                // 双引号转义
-                field.append('"');
-                i++; // 跳过下一个引号
-            } else {
-                inQuotes = !inQuotes;
-            }
-        } else if (ch == ',' && !inQuotes) {
-            fields.append(field);
-            field.clear();
-        } else {
-            field.append(ch);
-        }
-    }
-
-    // 添加最后一个字段
-    fields.append(field);
-
-    return fields;
-}
-
-ImportExportWorker::ImportExportWorker(QObject *parent)
-    : QObject(parent)
-    , m_operationType(ImportOperation)
-    , m_exportEncrypted(false)  // 默认导出未保密版
-    , m_formId(-1)  // 默认-1表示所有表单
-{
-}
-
-void ImportExportWorker::startOperation()
-{
-    qDebug() << "Worker thread started:" << QThread::currentThread()->objectName();
-
-    bool success = false;
-    QString message;
-
-    try {
-        switch (m_operationType) {
-        case ImportOperation:
-            success = importFromCSV();
-            message = success ? "导入完成" : "导入失败";
-            break;
-        case ExportOperation:
-            success = exportToCSV();
-            message = success ? "导出完成" : "导出失败";
-            break;
-        case ExportSelectedOperation:
-            success = exportSelectedToCSV(m_selectedRows);
-            message = success ? "导出完成" : "导出失败";
-            break;
-        }
-    } catch (const std::exception &e) {
-        QString error = QString("操作异常: %1").arg(e.what());
-        emit errorOccurred(error);
-        return;
-    } catch (...) {
-        emit errorOccurred("未知异常");
-        return;
-    }
-
-    emit operationFinished(success, message);
-}
-
-bool ImportExportWorker::importFromCSV()
-{
-    emit progressChanged(0, "开始导入...");
-
-    QFile file(m_filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        emit errorOccurred(QString("无法打开文件: %1").arg(m_filename));
-        return false;
-    }
-
-    QTextStream in(&file);
-    QString firstLine = in.readLine();
-
-    // 检查并跳过UTF-8 BOM
-    if (!firstLine.startsWith("Website,Username,Account,Password,Notes")) {
-        in.seek(0);
-        in.read(3); // 跳过BOM
-        firstLine = in.readLine(); // 读取标题行
-    }
-
-    // 获取文件大小用于计算进度
-    file.seek(0);
-    qint64 fileSize = file.size();
-    qint64 processedSize = 0;
-
-    // 统计导入数量
-    int importedCount = 0;
-    int lineNumber = 0;
-
-    // 批量插入，每10条提交一次
-    const int BATCH_SIZE = 10;
-    QSqlDatabase::database().transaction();
-
-    while (!in.atEnd()) {
-        lineNumber++;
-        QString line = in.readLine().trimmed();
-        processedSize += line.length() + 2; // +2 for CRLF
-
-        if (line.isEmpty()) continue;
-
-        // 计算进度
-        int progress = fileSize > 0 ? static_cast<int>((processedSize * 100) / fileSize) : 0;
-        emit progressChanged(progress, QString("正在导入第 %1 行...").arg(lineNumber));
-
-        // 处理CSV行
-        QStringList fields = parseCSVLine(line);
-
-        if (fields.size() >= 5) {
-            QString website = fields[0].trimmed();
-            QString username = fields[1].trimmed();
-            QString account = fields[2].trimmed();  // 账号字段
-            QString password = fields[3].trimmed();  // CSV中的明文密码
-            QString notes = fields[4].trimmed();
-
-            if (!website.isEmpty() && !username.isEmpty()) {
-                // 对账号和密码进行加密后再存储
-                QString encryptedAccount = Encryption::encrypt(account);
-                QString encryptedPassword = Encryption::encrypt(password);
-
-                // 使用指定的表单ID（如果为-1则使用默认表单）
-                int targetFormId = m_formId;
-                if (targetFormId <= 0) {
-                    // 获取第一个表单作为默认
-                    auto forms = Database::instance().getAllForms();
-                    if (!forms.isEmpty()) {
-                        targetFormId = forms.first().id;
-                    } else {
-                        // 如果没有表单，创建一个默认表单
-                        Database::instance().addForm("默认表单");
-                        forms = Database::instance().getAllForms();
-                        if (!forms.isEmpty()) {
-                            targetFormId = forms.first().id;
-                        }
-                    }
-                }
-
-                Database::instance().addPassword(targetFormId, website, username,
-                                                 encryptedAccount, encryptedPassword, notes);
-                importedCount++;
-
-                // 每批提交一次
-                if (importedCount % BATCH_SIZE == 0) {
-                    QSqlDatabase::database().commit();
-                    QSqlDatabase::database().transaction();
-                }
-            }
-        }
-
-        // 处理事件循环，避免界面卡死
-        QCoreApplication::processEvents();
-    }
-
-    // 提交最后一批
-    QSqlDatabase::database().commit();
-
-    file.close();
-
-    emit progressChanged(100, QString("导入完成，共导入 %1 条记录").arg(importedCount));
-    return importedCount > 0;
-}
-
-bool ImportExportWorker::exportToCSV()
-{
-    emit progressChanged(0, "开始导出...");
-
-    QFile file(m_filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        emit errorOccurred(QString("无法创建文件: %1").arg(m_filename));
-        return false;
-    }
-
-    QTextStream out(&file);
-
-    // 写入UTF-8 BOM
-    out << "\xEF\xBB\xBF";
-
-    // 写入表头，增加Account列
-    out << "Website,Username,Account,Password,Notes\n";
-
-    // 获取指定表单的密码（如果m_formId为-1则获取所有）
-    auto passwords = Database::instance().getAllPasswords(m_formId);
-    int totalCount = passwords.size();
-    int exportedCount = 0;
-
-    for (const auto &pwd : passwords) {
-        exportedCount++;
-
-        // 更新进度
-        int progress = totalCount > 0 ? static_cast<int>((exportedCount * 100) / totalCount) : 0;
-        QString exportType = m_exportEncrypted ? "保密版" : "未保密版";
-        emit progressChanged(progress, QString("正在导出(%1)第 %2/%3 条...").arg(exportType).arg(exportedCount).arg(totalCount));
-
-        // 对CSV特殊字符进行转义
-        QString escapedWebsite = escapeCSVField(pwd.website);
-        QString escapedUsername = escapeCSVField(pwd.username);
-
-        // 根据导出类型决定账号和密码字段
-        QString accountField;
-        QString passwordField;
-
-        if (m_exportEncrypted) {
-            // 保密版：直接使用数据库中的加密账号和密码
-            accountField = pwd.account;
-            passwordField = pwd.password;
-        } else {
-            // 未保密版：解密账号和密码
-            accountField = Encryption::decrypt(pwd.account);
-            passwordField = Encryption::decrypt(pwd.password);
-        }
-
-        QString escapedAccount = escapeCSVField(accountField);
-        QString escapedPassword = escapeCSVField(passwordField);
-        QString escapedNotes = escapeCSVField(pwd.notes);
-
-        out << escapedWebsite << ","
-            << escapedUsername << ","
-            << escapedAccount << ","   // 增加账号列
-            << escapedPassword << ","
-            << escapedNotes << "\n";
-
-        // 处理事件循环，避免界面卡死
-        if (exportedCount % 10 == 0) {
-            QCoreApplication::processEvents();
-        }
-    }
-
-    file.close();
-
-    QString exportType = m_exportEncrypted ? "保密版" : "未保密版";
-    QString formInfo = (m_formId >= 0) ?
-                           QString("表单ID:%1").arg(m_formId) :
-                           "所有表单";
-    emit progressChanged(100, QString("导出(%1)完成，共导出 %2 条记录 (%3)").arg(exportType).arg(exportedCount).arg(formInfo));
-    return exportedCount > 0;
-}
-
-bool ImportExportWorker::exportSelectedToCSV(const QList<int> &selectedRows)
-{
-    emit progressChanged(0, "开始导出选中的记录...");
-
-    QFile file(m_filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        emit errorOccurred(QString("无法创建文件: %1").arg(m_filename));
-        return false;
-    }
-
-    QTextStream out(&file);
-
-    // 写入UTF-8 BOM
-    out << "\xEF\xBB\xBF";
-
-    // 写入表头，增加Account列
-    out << "Website,Username,Account,Password,Notes\n";
-
-    // 获取指定表单的密码（如果m_formId为-1则获取所有）
-    auto passwords = Database::instance().getAllPasswords(m_formId);
-    int totalCount = selectedRows.size();
-    int exportedCount = 0;
-
-    for (int row : selectedRows) {
-        if (row < 0 || row >= passwords.size()) {
-            continue;
-        }
-
-        const auto &pwd = passwords[row];
-        exportedCount++;
-
-        // 更新进度
-        int progress = totalCount > 0 ? static_cast<int>((exportedCount * 100) / totalCount) : 0;
-        QString exportType = m_exportEncrypted ? "保密版" : "未保密版";
-        emit progressChanged(progress, QString("正在导出(%1)第 %2/%3 条...").arg(exportType).arg(exportedCount).arg(totalCount));
-
-        // 对CSV特殊字符进行转义
-        QString escapedWebsite = escapeCSVField(pwd.website);
-        QString escapedUsername = escapeCSVField(pwd.username);
-
-        // 根据导出类型决定账号和密码字段
-        QString accountField;
-        QString passwordField;
-
-        if (m_exportEncrypted) {
-            // 保密版：直接使用数据库中的加密账号和密码
-            accountField = pwd.account;
-            passwordField = pwd.password;
-        } else {
-            // 未保密版：解密账号和密码
-            accountField = Encryption::decrypt(pwd.account);
-            passwordField = Encryption::decrypt(pwd.password);
-        }
-
-        QString escapedAccount = escapeCSVField(accountField);
-        QString escapedPassword = escapeCSVField(passwordField);
-        QString escapedNotes = escapeCSVField(pwd.notes);
-
-        out << escapedWebsite << ","
-            << escapedUsername << ","
-            << escapedAccount << ","   // 增加账号列
-            << escapedPassword << ","
-            << escapedNotes << "\n";
-
-        // 处理事件循环，避免界面卡死
-        if (exportedCount % 10 == 0) {
-            QCoreApplication::processEvents();
-        }
-    }
-
-    file.close();
-
-    QString exportType = m_exportEncrypted ? "保密版" : "未保密版";
-    QString formInfo = (m_formId >= 0) ?
-                           QString("表单ID:%1").arg(m_formId) :
-                           "所有表单";
-    emit progressChanged(100, QString("导出(%1)完成，共导出 %2 条记录 (%3)").arg(exportType).arg(exportedCount).arg(formInfo));
-    return exportedCount > 0;
-}
+#include "importexportworker.h"
+#include "encryption.h"
+#include "csvutils.h"
+#include "compressedstream.h"
+#include "encryptedstream.h"
+#include "vaultbackup.h"
+#include "jsonstreamreader.h"
+#include "importreaders.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QThreadPool>
+#include <QQueue>
+#include <QScopedPointer>
+#include <QPair>
+#include <QHash>
+#include <QSet>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QtConcurrent>
+#include <algorithm>
+#include <memory>
+
+// 打开导入导出文件：设置了口令时（导入时按文件头识别）使用加密流，
+// .gz/.zst文件（导入时也按文件头识别）使用压缩流，其余为普通文件
+static QIODevice *openDataFile(const QString &filename, QIODevice::OpenMode mode,
+                               const QString &passphrase, QString *error)
+{
+    bool encrypted = mode.testFlag(QIODevice::ReadOnly)
+                         ? EncryptedStream::isEncryptedArchive(filename)
+                         : !passphrase.isEmpty();
+    if (encrypted) {
+        EncryptedStream *stream = new EncryptedStream(filename, passphrase);
+        if (!stream->open(mode)) {
+            *error = stream->errorString();
+            delete stream;
+            return nullptr;
+        }
+        return stream;
+    }
+
+    CompressedStream::Format format = mode.testFlag(QIODevice::ReadOnly)
+                                          ? CompressedStream::detectFormat(filename)
+                                          : CompressedStream::formatFromFileName(filename);
+
+    QIODevice *device;
+    if (format == CompressedStream::PlainFormat) {
+        device = new QFile(filename);
+    } else {
+        device = new CompressedStream(filename, format);
+    }
+
+    if (!device->open(mode)) {
+        *error = device->errorString();
+        delete device;
+        return nullptr;
+    }
+    return device;
+}
+
+// 关闭文件，压缩流和加密流在关闭时才写完最后的数据，需要检查是否出错
+static bool closeDataFile(QIODevice *device)
+{
+    device->close();
+    CompressedStream *compressed = qobject_cast<CompressedStream *>(device);
+    EncryptedStream *encrypted = qobject_cast<EncryptedStream *>(device);
+    return !(compressed && compressed->hasError()) && !(encrypted && encrypted->hasError());
+}
+
+// 已读取的文件字节数（压缩文件和加密文件返回已读取的文件字节数）
+static qint64 dataFilePos(QIODevice *device)
+{
+    if (CompressedStream *compressed = qobject_cast<CompressedStream *>(device)) {
+        return compressed->compressedPos();
+    }
+    if (EncryptedStream *encrypted = qobject_cast<EncryptedStream *>(device)) {
+        return encrypted->archivePos();
+    }
+    return device->pos();
+}
+
+// 将一块记录格式化为CSV文本（UTF-8），在线程池中调用，不访问数据库和成员变量
+static QByteArray formatCSVBlock(const QList<PasswordEntry> &entries, bool exportEncrypted)
+{
+    QString text;
+    for (const auto &pwd : entries) {
+        // 根据导出类型决定账号和密码字段
+        QString accountField;
+        QString passwordField;
+
+        if (exportEncrypted) {
+            // 保密版：直接使用数据库中的加密账号和密码
+            accountField = pwd.account;
+            passwordField = pwd.password;
+        } else {
+            // 未保密版：解密账号和密码
+            accountField = Encryption::decrypt(pwd.account);
+            passwordField = Encryption::decrypt(pwd.password);
+        }
+
+        text += escapeCSVField(pwd.website);
+        text += ',';
+        text += escapeCSVField(pwd.username);
+        text += ',';
+        text += escapeCSVField(accountField);
+        text += ',';
+        text += escapeCSVField(passwordField);
+        text += ',';
+        text += escapeCSVField(pwd.notes);
+        text += '\n';
+    }
+    return text.toUtf8();
+}
+
+// 按扩展名判断是否为JSON Lines文件（忽略.gz/.zst/.pmenc后缀）
+static bool isJsonLinesFileName(const QString &filename)
+{
+    QString name = filename.toLower();
+    for (const char *suffix : { ".pmenc", ".gz", ".zst" }) {
+        if (name.endsWith(QLatin1String(suffix))) {
+            name.chop(static_cast<int>(qstrlen(suffix)));
+        }
+    }
+    return name.endsWith(".jsonl") || name.endsWith(".ndjson");
+}
+
+enum ImportFormat {
+    CsvImport,
+    JsonLinesImport,
+    BitwardenImport,
+    KeePassImport
+};
+
+// 导入时按内容判断格式：'<'开头为KeePass XML；'{'开头时，最外层对象的字段值中出现数组或对象
+// 的是Bitwarden导出（folders/items），否则为每行一条记录的JSON Lines；其余按CSV处理
+static ImportFormat detectImportFormat(QIODevice *device)
+{
+    QByteArray head = device->peek(4096);
+    int pos = head.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+    while (pos < head.size() && QChar::isSpace(static_cast<uchar>(head.at(pos)))) {
+        pos++;
+    }
+    if (pos >= head.size()) {
+        return CsvImport;
+    }
+    if (head.at(pos) == '<') {
+        return KeePassImport;
+    }
+    if (head.at(pos) != '{') {
+        return CsvImport;
+    }
+
+    JsonStreamReader reader(head.mid(pos));
+    for (;;) {
+        JsonStreamReader::TokenType token = reader.readNext();
+        if ((token == JsonStreamReader::StartObject || token == JsonStreamReader::StartArray) && reader.depth() > 1) {
+            return BitwardenImport;
+        }
+        if (token == JsonStreamReader::EndObject || reader.atEnd()) {
+            return JsonLinesImport;
+        }
+    }
+}
+
+// 将一块记录格式化为JSON Lines，每条记录一行，带表单ID和表单名称
+static QByteArray formatJsonLinesBlock(const QList<PasswordEntry> &entries,
+                                       const QHash<int, QString> &formNames, bool exportEncrypted)
+{
+    QByteArray lines;
+    for (const auto &pwd : entries) {
+        QJsonObject record;
+        record.insert("id", pwd.id);
+        record.insert("form_id", pwd.form_id);
+        record.insert("form", formNames.value(pwd.form_id));
+        record.insert("website", pwd.website);
+        record.insert("username", pwd.username);
+        // 保密版保留数据库中的加密形式，并标记出来，导入时不再重复加密
+        record.insert("account", exportEncrypted ? pwd.account : Encryption::decrypt(pwd.account));
+        record.insert("password", exportEncrypted ? pwd.password : Encryption::decrypt(pwd.password));
+        record.insert("notes", pwd.notes);
+        record.insert("encrypted", exportEncrypted);
+
+        lines += QJsonDocument(record).toJson(QJsonDocument::Compact);
+        lines += '\n';
+    }
+    return lines;
+}
+
+static bool parseJsonLinesRecord(const QByteArray &line, ImportRecord &record)
+{
+    JsonStreamReader reader(line);
+    if (reader.readNext() != JsonStreamReader::StartObject) {
+        record.error = reader.hasError() ? reader.errorString() : QString("不是JSON对象");
+        return false;
+    }
+
+    bool encrypted = false;
+    while (reader.readNext() == JsonStreamReader::Name) {
+        QString key = reader.text();
+        if (key == "website") {
+            record.entry.website = reader.readValueText();
+        } else if (key == "username") {
+            record.entry.username = reader.readValueText();
+        } else if (key == "account") {
+            record.entry.account = reader.readValueText();
+        } else if (key == "password") {
+            record.entry.password = reader.readValueText();
+        } else if (key == "notes") {
+            record.entry.notes = reader.readValueText();
+        } else if (key == "form") {
+            record.formName = reader.readValueText();
+        } else if (key == "form_id") {
+            record.formId = reader.readValueText().toInt();
+        } else if (key == "encrypted") {
+            encrypted = reader.readNext() == JsonStreamReader::Bool && reader.boolValue();
+        } else {
+            reader.skipCurrentValue();  // 不认识的字段直接跳过
+        }
+    }
+
+    if (reader.tokenType() != JsonStreamReader::EndObject
+        || reader.readNext() != JsonStreamReader::EndDocument) {
+        record.error = reader.hasError() ? reader.errorString() : QString("记录格式错误");
+        return false;
+    }
+    if (record.entry.website.isEmpty() || record.entry.username.isEmpty()) {
+        record.error = "缺少website或username";
+        return false;
+    }
+
+    if (!encrypted) {
+        record.entry.account = Encryption::encrypt(record.entry.account);
+        record.entry.password = Encryption::encrypt(record.entry.password);
+    }
+    return true;
+}
+
+// 在线程池中解析一块连续的行，空行不产生记录
+static QList<ImportRecord> parseJsonLinesBlock(const QList<QByteArray> &lines, int firstLineNumber)
+{
+    QList<ImportRecord> records;
+    for (int i = 0; i < lines.size(); ++i) {
+        QByteArray line = lines.at(i).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        ImportRecord record = makeImportRecord(firstLineNumber + i);
+        record.valid = parseJsonLinesRecord(line, record);
+        records.append(record);
+    }
+    return records;
+}
+
+// 导入记录归入的表单：按表单名称对应，不存在时自动创建；名称为空时按表单ID，
+// 两者都对应不上的记录导入到默认表单（与CSV导入相同）
+class ImportFormMapper
+{
+public:
+    ImportFormMapper(StorageBackend &storage, int defaultFormId)
+        : m_storage(storage)
+        , m_defaultFormId(defaultFormId)
+    {
+        load();
+        if (m_defaultFormId <= 0) {
+            // 获取第一个表单作为默认，没有表单时创建一个默认表单
+            if (m_ids.isEmpty()) {
+                addForm("默认表单");
+            }
+            auto forms = m_storage.getAllForms();
+            m_defaultFormId = forms.isEmpty() ? -1 : forms.first().id;
+            load();
+        }
+    }
+
+    int formIdFor(const ImportRecord &record)
+    {
+        if (!record.formName.isEmpty()) {
+            if (!m_idsByName.contains(record.formName)) {
+                addForm(record.formName);
+                load();
+            }
+            return m_idsByName.value(record.formName, m_defaultFormId);
+        }
+        return m_ids.contains(record.formId) ? record.formId : m_defaultFormId;
+    }
+
+private:
+    void addForm(const QString &name)
+    {
+        // 直接写入存储引擎，需要让Database的表单缓存失效
+        if (m_storage.addForm(name)) {
+            Database::instance().invalidateFormCache();
+        }
+    }
+
+    void load()
+    {
+        m_idsByName.clear();
+        m_ids.clear();
+        for (const auto &form : m_storage.getAllForms()) {
+            m_idsByName.insert(form.name, form.id);
+            m_ids.insert(form.id);
+        }
+    }
+
+    StorageBackend &m_storage;
+    QHash<QString, int> m_idsByName;
+    QSet<int> m_ids;
+    int m_defaultFormId;
+};
+
+// 将一块解析好的记录在一个事务中写入数据库，返回写入的条数，事务失败（整块回滚）返回-1
+static int insertImportRecords(StorageBackend &storage, const QList<ImportRecord> &records,
+                               ImportFormMapper &forms, int *skippedCount)
+{
+    Database::Transaction transaction(&storage);
+    if (!transaction.isActive()) {
+        qDebug() << "无法开始导入事务";
+        return -1;
+    }
+
+    int insertedCount = 0;
+    for (const auto &record : records) {
+        if (!record.valid) {
+            qDebug() << "跳过第" << record.position << "条记录:" << record.error;
+            (*skippedCount)++;
+            continue;
+        }
+
+        const PasswordEntry &pwd = record.entry;
+        if (storage.addPassword(forms.formIdFor(record), pwd.website, pwd.username,
+                                pwd.account, pwd.password, pwd.notes)) {
+            insertedCount++;
+        }
+    }
+    if (!transaction.commit()) {
+        qDebug() << "写入导入记录失败，本块" << insertedCount << "条记录已回滚";
+        return -1;
+    }
+    return insertedCount;
+}
+
+ImportExportWorker::ImportExportWorker(QObject *parent)
+    : QObject(parent)
+    , m_operationType(ImportOperation)
+    , m_exportEncrypted(false)  // 默认导出未保密版
+    , m_formId(-1)  // 默认-1表示所有表单
+    , m_cancelRequested(0)
+    , m_storage(nullptr)
+{
+}
+
+void ImportExportWorker::startOperation()
+{
+    qDebug() << "Worker thread started:" << QThread::currentThread()->objectName();
+
+    bool success = false;
+    QString message;
+
+    // 导入导出在本线程自己的连接上读写，不与主线程共用默认连接和它上面的事务
+    QScopedPointer<Database::ThreadStorage> threadStorage;
+    if (m_operationType == ImportOperation || m_operationType == ExportOperation
+        || m_operationType == ExportSelectedOperation) {
+        threadStorage.reset(new Database::ThreadStorage("worker"));
+        m_storage = threadStorage->storage();
+        if (!m_storage) {
+            emit errorOccurred("无法打开数据库连接");
+            return;
+        }
+    }
+
+    try {
+        switch (m_operationType) {
+        case ImportOperation:
+            success = importFromFile();
+            message = success ? "导入完成" : "导入失败";
+            break;
+        case ExportOperation:
+            success = exportToCSV();
+            message = success ? "导出完成" : "导出失败";
+            break;
+        case ExportSelectedOperation:
+            success = exportSelectedToCSV(m_selectedIds);
+            message = success ? "导出完成" : "导出失败";
+            break;
+        case BackupOperation:
+            success = backupVault();
+            message = success ? "备份完成" : "备份失败";
+            break;
+        case RestoreOperation:
+            success = restoreVault();
+            message = success ? "恢复完成" : "恢复失败";
+            break;
+        case SnapshotOperation:
+            success = snapshotDatabase();
+            message = success ? "数据库快照完成" : "数据库快照失败";
+            break;
+        }
+
+        if (isCancelRequested()) {
+            success = false;
+            message = "操作已取消";
+        }
+    } catch (const std::exception &e) {
+        QString error = QString("操作异常: %1").arg(e.what());
+        emit errorOccurred(error);
+        return;
+    } catch (...) {
+        emit errorOccurred("未知异常");
+        return;
+    }
+
+    emit operationFinished(success, message);
+}
+
+bool ImportExportWorker::importFromFile()
+{
+    emit progressChanged(0, "开始导入...");
+
+    QString openError;
+    std::unique_ptr<QIODevice> file(openDataFile(m_filename, QIODevice::ReadOnly | QIODevice::Text, m_passphrase, &openError));
+    if (!file) {
+        emit errorOccurred(QString("无法打开文件: %1 (%2)").arg(m_filename).arg(openError));
+        return false;
+    }
+
+    // gzip/zstd的校验和与加密文件的认证错误可能要读到文件末尾才能发现，读取时只表现为文件结束，
+    // 所以整个导入在一个外层事务中进行（各批次是其中的保存点），文件完整读完并关闭成功后才提交；
+    // 出错或取消时全部撤销
+    Database::Transaction importTransaction(m_storage);
+    if (!importTransaction.isActive()) {
+        emit errorOccurred("无法开始导入事务");
+        return false;
+    }
+
+    // 压缩和加密文件同样按解压/解密后的内容判断格式
+    int skippedCount = 0;
+    int importedCount = 0;
+    switch (detectImportFormat(file.get())) {
+    case JsonLinesImport:
+        importedCount = importJsonLines(*file, &skippedCount);
+        break;
+    case BitwardenImport: {
+        BitwardenJsonReader reader(file.get());
+        importedCount = importWithReader(*file, reader, &skippedCount);
+        break;
+    }
+    case KeePassImport: {
+        KeePassXmlReader reader(file.get());
+        importedCount = importWithReader(*file, reader, &skippedCount);
+        break;
+    }
+    case CsvImport:
+        importedCount = importCSV(*file);
+        break;
+    }
+
+    bool fileOk = closeDataFile(file.get());
+    if (!fileOk || importedCount < 0 || isCancelRequested()) {
+        importTransaction.rollback();
+        Database::instance().invalidateFormCache();  // 撤销了导入时新建的表单
+        if (!fileOk) {
+            emit errorOccurred(QString("读取文件失败: %1，已撤销本次导入的全部记录").arg(file->errorString()));
+        }
+        return false;
+    }
+    if (!importTransaction.commit()) {
+        Database::instance().invalidateFormCache();
+        emit errorOccurred("提交导入的记录失败，已撤销本次导入的全部记录");
+        return false;
+    }
+    // 主线程在提交前可能已经缓存了表单列表，看不到本次新建的表单
+    Database::instance().invalidateFormCache();
+
+    QString message = QString("导入完成，共导入 %1 条记录").arg(importedCount);
+    if (skippedCount > 0) {
+        message += QString("，跳过 %1 条无效记录").arg(skippedCount);
+    }
+    emit progressChanged(100, message);
+    return importedCount > 0;
+}
+
+int ImportExportWorker::importCSV(QIODevice &file)
+{
+    // 压缩文件是顺序设备，不能seek，BOM由QTextStream自动识别，这里只去掉残留的U+FEFF
+    QTextStream in(&file);
+    QString firstLine = in.readLine();
+    if (firstLine.startsWith(QChar(0xFEFF))) {
+        firstLine.remove(0, 1);
+    }
+
+    // 获取文件大小用于计算进度（压缩文件按压缩后的字节数计算）
+    QFileInfo fileInfo(m_filename);
+    qint64 fileSize = fileInfo.size();
+
+    // 统计导入数量
+    int importedCount = 0;
+    int lineNumber = 0;
+
+    // 使用指定的表单ID（如果为-1则使用默认表单），整个文件只确定一次
+    int targetFormId = m_formId;
+    if (targetFormId <= 0) {
+        // 获取第一个表单作为默认
+        auto forms = m_storage->getAllForms();
+        if (!forms.isEmpty()) {
+            targetFormId = forms.first().id;
+        } else {
+            // 如果没有表单，创建一个默认表单
+            if (m_storage->addForm("默认表单")) {
+                Database::instance().invalidateFormCache();
+            }
+            forms = m_storage->getAllForms();
+            if (!forms.isEmpty()) {
+                targetFormId = forms.first().id;
+            }
+        }
+    }
+
+    // 批量插入，每批是外层导入事务中的一个保存点
+    const int BATCH_SIZE = 500;
+    Database::Transaction transaction(m_storage);
+    if (!transaction.isActive()) {
+        emit errorOccurred("无法开始导入事务");
+        return -1;
+    }
+    int batchRows = 0;
+    int lastProgress = -1;
+
+    while (!in.atEnd() && !isCancelRequested()) {
+        lineNumber++;
+        QString line = in.readLine().trimmed();
+
+        if (line.isEmpty()) continue;
+
+        // 计算进度；跨线程信号会排队到主线程，只在百分比变化或每BATCH_SIZE行时发出，不逐行发出
+        qint64 processedSize = dataFilePos(&file);
+        int progress = fileSize > 0 ? static_cast<int>(qMin<qint64>(100, (processedSize * 100) / fileSize)) : 0;
+        if (progress != lastProgress || lineNumber % BATCH_SIZE == 0) {
+            emit progressChanged(progress, QString("正在导入第 %1 行...").arg(lineNumber));
+            lastProgress = progress;
+        }
+
+        // 处理CSV行
+        QStringList fields = parseCSVLine(line);
+
+        if (fields.size() >= 5) {
+            QString website = fields[0].trimmed();
+            QString username = fields[1].trimmed();
+            QString account = fields[2].trimmed();  // 账号字段
+            QString password = fields[3].trimmed();  // CSV中的明文密码
+            QString notes = fields[4].trimmed();
+
+            if (!website.isEmpty() && !username.isEmpty()) {
+                // 对账号和密码进行加密后再存储
+                QString encryptedAccount = Encryption::encrypt(account);
+                QString encryptedPassword = Encryption::encrypt(password);
+
+                // 重复的记录违反唯一约束，不计入导入数量
+                if (m_storage->addPassword(targetFormId, website, username,
+                                           encryptedAccount, encryptedPassword, notes)) {
+                    importedCount++;
+                }
+
+                // 每批提交一次
+                if (++batchRows == BATCH_SIZE) {
+                    if (!transaction.restart()) {
+                        emit errorOccurred("写入数据库失败");
+                        return -1;
+                    }
+                    batchRows = 0;
+                }
+            }
+        }
+    }
+
+    // 提交最后一批
+    if (!transaction.commit()) {
+        emit errorOccurred("写入数据库失败");
+        return -1;
+    }
+    return importedCount;
+}
+
+int ImportExportWorker::importJsonLines(QIODevice &file, int *skippedCount)
+{
+    QFileInfo fileInfo(m_filename);
+    qint64 fileSize = fileInfo.size();
+
+    ImportFormMapper forms(*m_storage, m_formId);
+
+    // 每行一条记录，读取在当前线程按顺序进行，解析和加密交给线程池并行处理，
+    // 解析结果按提交顺序写入数据库，每块提交一次事务，在途的块数量有上限
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int maxInFlight = qMax(2, pool->maxThreadCount() * 2);
+    QQueue<QFuture<QList<ImportRecord>>> pending;
+    int lineNumber = 0;
+    int importedCount = 0;
+    bool exhausted = false;
+    bool writeFailed = false;
+
+    while (!pending.isEmpty() || (!exhausted && !isCancelRequested() && !writeFailed)) {
+        while (!exhausted && !isCancelRequested() && !writeFailed && pending.size() < maxInFlight) {
+            QList<QByteArray> lines;
+            int firstLineNumber = lineNumber + 1;
+            while (lines.size() < IMPORT_BLOCK_SIZE && !file.atEnd()) {
+                lines.append(file.readLine());
+                lineNumber++;
+            }
+            if (lines.isEmpty()) {
+                exhausted = true;
+                break;
+            }
+            pending.enqueue(QtConcurrent::run(pool, [lines, firstLineNumber]() {
+                return parseJsonLinesBlock(lines, firstLineNumber);
+            }));
+        }
+
+        if (pending.isEmpty()) {
+            break;
+        }
+
+        QList<ImportRecord> records = pending.dequeue().result();
+        if (isCancelRequested() || writeFailed) {
+            continue;  // 取消或出错后只等待已提交的任务结束
+        }
+
+        int insertedCount = insertImportRecords(*m_storage, records, forms, skippedCount);
+        if (insertedCount < 0) {
+            emit errorOccurred("写入数据库失败");
+            writeFailed = true;
+            continue;
+        }
+        importedCount += insertedCount;
+
+        qint64 processedSize = dataFilePos(&file);
+        int progress = fileSize > 0 ? static_cast<int>(qMin<qint64>(99, (processedSize * 100) / fileSize)) : 0;
+        emit progressChanged(progress, QString("正在导入第 %1 行...").arg(records.isEmpty() ? lineNumber : records.last().position));
+    }
+
+    return writeFailed ? -1 : importedCount;
+}
+
+int ImportExportWorker::importWithReader(QIODevice &file, ImportReader &reader, int *skippedCount)
+{
+    QFileInfo fileInfo(m_filename);
+    qint64 fileSize = fileInfo.size();
+    ImportFormMapper forms(*m_storage, m_formId);
+
+    // 流式解析只能按顺序进行，每凑满一块记录就在一个事务中写入数据库，内存中最多保留一块
+    int importedCount = 0;
+    bool more = true;
+    while (more && !isCancelRequested()) {
+        QList<ImportRecord> records;
+        ImportRecord record;
+        while (records.size() < IMPORT_BLOCK_SIZE && (more = reader.readNext(record))) {
+            records.append(record);
+        }
+        if (records.isEmpty()) {
+            break;
+        }
+
+        int insertedCount = insertImportRecords(*m_storage, records, forms, skippedCount);
+        if (insertedCount < 0) {
+            emit errorOccurred("写入数据库失败");
+            return -1;
+        }
+        importedCount += insertedCount;
+
+        qint64 processedSize = dataFilePos(&file);
+        int progress = fileSize > 0 ? static_cast<int>(qMin<qint64>(99, (processedSize * 100) / fileSize)) : 0;
+        emit progressChanged(progress, QString("正在导入第 %1 条...").arg(records.last().position));
+    }
+
+    if (reader.hasError()) {
+        emit errorOccurred(QString("解析文件失败: %1").arg(reader.errorString()));
+        return -1;
+    }
+    return importedCount;
+}
+
+bool ImportExportWorker::exportToCSV()
+{
+    emit progressChanged(0, "开始导出...");
+
+    QString openError;
+    std::unique_ptr<QIODevice> file(openDataFile(m_filename, QIODevice::WriteOnly | QIODevice::Text, m_passphrase, &openError));
+    if (!file) {
+        emit errorOccurred(QString("无法创建文件: %1 (%2)").arg(m_filename).arg(openError));
+        return false;
+    }
+
+    // 获取指定表单的密码（如果m_formId为-1则获取所有），按ID游标分块读取
+    int totalCount = m_storage->countPasswords(m_formId);
+    int lastId = 0;
+    auto fetchNextBlock = [this, &lastId]() {
+        auto block = m_storage->getPasswordsAfter(m_formId, lastId, EXPORT_BLOCK_SIZE);
+        if (!block.isEmpty()) {
+            lastId = block.last().id;
+        }
+        return block;
+    };
+
+    int exportedCount = writeExportBlocks(*file, fetchNextBlock, totalCount);
+
+    if (!closeDataFile(file.get())) {
+        emit errorOccurred(QString("写入文件失败: %1").arg(file->errorString()));
+        exportedCount = -1;
+    }
+
+    if (exportedCount < 0 || isCancelRequested()) {
+        // 取消或写入失败时删除写了一半的文件
+        QFile::remove(m_filename);
+        return false;
+    }
+
+    QString exportType = m_exportEncrypted ? "保密版" : "未保密版";
+    QString formInfo = (m_formId >= 0) ?
+                           QString("表单ID:%1").arg(m_formId) :
+                           "所有表单";
+    emit progressChanged(100, QString("导出(%1)完成，共导出 %2 条记录 (%3)").arg(exportType).arg(exportedCount).arg(formInfo));
+    return exportedCount > 0;
+}
+
+bool ImportExportWorker::exportSelectedToCSV(const QList<int> &selectedIds)
+{
+    emit progressChanged(0, "开始导出选中的记录...");
+
+    QString openError;
+    std::unique_ptr<QIODevice> file(openDataFile(m_filename, QIODevice::WriteOnly | QIODevice::Text, m_passphrase, &openError));
+    if (!file) {
+        emit errorOccurred(QString("无法创建文件: %1 (%2)").arg(m_filename).arg(openError));
+        return false;
+    }
+
+    // 主线程只传入选中记录的ID，数据在工作线程中按ID分批读取
+    // 结果按ID递增排列，与表格中的显示顺序一致
+    QList<int> sortedIds = selectedIds;
+    std::sort(sortedIds.begin(), sortedIds.end());
+
+    int offset = 0;
+    auto fetchNextBlock = [this, &sortedIds, &offset]() {
+        QList<PasswordEntry> block;
+        if (offset < sortedIds.size()) {
+            block = m_storage->getPasswordsByIds(sortedIds.mid(offset, EXPORT_BLOCK_SIZE));
+            offset += EXPORT_BLOCK_SIZE;
+        }
+        return block;
+    };
+
+    int exportedCount = writeExportBlocks(*file, fetchNextBlock, sortedIds.size());
+
+    if (!closeDataFile(file.get())) {
+        emit errorOccurred(QString("写入文件失败: %1").arg(file->errorString()));
+        exportedCount = -1;
+    }
+
+    if (exportedCount < 0 || isCancelRequested()) {
+        // 取消或写入失败时删除写了一半的文件
+        QFile::remove(m_filename);
+        return false;
+    }
+
+    QString exportType = m_exportEncrypted ? "保密版" : "未保密版";
+    QString formInfo = (m_formId >= 0) ?
+                           QString("表单ID:%1").arg(m_formId) :
+                           "所有表单";
+    emit progressChanged(100, QString("导出(%1)完成，共导出 %2 条记录 (%3)").arg(exportType).arg(exportedCount).arg(formInfo));
+    return exportedCount > 0;
+}
+
+int ImportExportWorker::writeExportBlocks(QIODevice &file,
+                                          const std::function<QList<PasswordEntry>()> &fetchNextBlock,
+                                          int totalCount)
+{
+    // JSON Lines每行一条完整记录，不需要表头；CSV写入UTF-8 BOM和表头，增加Account列
+    const bool jsonLines = isJsonLinesFileName(m_filename);
+    QHash<int, QString> formNames;
+    if (jsonLines) {
+        for (const auto &form : m_storage->getAllForms()) {
+            formNames.insert(form.id, form.name);
+        }
+    } else {
+        file.write("\xEF\xBB\xBF");
+        file.write("Website,Username,Account,Password,Notes\n");
+    }
+
+    // 数据库读取和文件写入都在当前线程按顺序进行，解密和转义交给线程池并行处理
+    // 队列中的块按提交顺序写出，因此结果与逐行串行导出完全一致
+    // 同时在途的块数量有上限，内存占用不随记录总数增长
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int maxInFlight = qMax(2, pool->maxThreadCount() * 2);
+    // 写入加密文件时由文件本身保护内容，账号和密码按明文写入，导入时同普通CSV
+    const bool exportEncrypted = m_exportEncrypted && m_passphrase.isEmpty();
+    QString exportType = m_exportEncrypted ? "保密版" : "未保密版";
+
+    QQueue<QPair<int, QFuture<QByteArray>>> pending;
+    int exportedCount = 0;
+    bool exhausted = false;
+    bool writeFailed = false;
+
+    while (!pending.isEmpty() || (!exhausted && !isCancelRequested() && !writeFailed)) {
+        // 补充在途的块
+        while (!exhausted && !isCancelRequested() && !writeFailed && pending.size() < maxInFlight) {
+            QList<PasswordEntry> block = fetchNextBlock();
+            if (block.isEmpty()) {
+                exhausted = true;
+                break;
+            }
+            int blockSize = block.size();
+            pending.enqueue(qMakePair(blockSize, QtConcurrent::run(pool, [block, jsonLines, formNames, exportEncrypted]() {
+                return jsonLines ? formatJsonLinesBlock(block, formNames, exportEncrypted)
+                                 : formatCSVBlock(block, exportEncrypted);
+            })));
+        }
+
+        if (pending.isEmpty()) {
+            break;
+        }
+
+        // 按顺序等待并写出最早提交的块
+        auto next = pending.dequeue();
+        QByteArray data = next.second.result();
+        if (isCancelRequested() || writeFailed) {
+            continue;  // 取消或出错后只等待已提交的任务结束，不再写文件
+        }
+
+        if (file.write(data) != data.size()) {
+            emit errorOccurred(QString("写入文件失败: %1").arg(file.errorString()));
+            writeFailed = true;
+            continue;
+        }
+
+        exportedCount += next.first;
+        int progress = totalCount > 0 ? static_cast<int>((static_cast<qint64>(exportedCount) * 100) / totalCount) : 0;
+        emit progressChanged(qMin(progress, 99), QString("正在导出(%1)第 %2/%3 条...").arg(exportType).arg(exportedCount).arg(totalCount));
+    }
+
+    return writeFailed ? -1 : exportedCount;
+}
+
+bool ImportExportWorker::backupVault()
+{
+    emit progressChanged(0, "开始备份...");
+
+    auto progress = [this](qint64 done, qint64 total) {
+        int percent = total > 0 ? static_cast<int>(qMin<qint64>(99, done * 100 / total)) : 0;
+        emit progressChanged(percent, QString("正在备份第 %1/%2 条...").arg(done).arg(total));
+        return !isCancelRequested();
+    };
+
+    // 在本线程的独立连接上读写，默认连接属于主线程
+    QString connectionName = Database::instance().openThreadConnection("backup");
+    if (connectionName.isEmpty()) {
+        emit errorOccurred("备份失败: 无法打开数据库连接");
+        return false;
+    }
+
+    QString error;
+    bool ok = VaultBackup::backup(QSqlDatabase::database(connectionName, false), m_filename, true, progress, &error);
+    Database::closeThreadConnection(connectionName);
+    if (!ok) {
+        if (!isCancelRequested()) {
+            emit errorOccurred(QString("备份失败: %1").arg(error));
+        }
+        return false;
+    }
+
+    emit progressChanged(100, "备份完成");
+    return true;
+}
+
+bool ImportExportWorker::restoreVault()
+{
+    emit progressChanged(0, "开始恢复...");
+
+    auto progress = [this](qint64 done, qint64 total) {
+        int percent = total > 0 ? static_cast<int>(qMin<qint64>(99, done * 100 / total)) : 0;
+        emit progressChanged(percent, QString("正在恢复... %1%").arg(percent));
+        return !isCancelRequested();
+    };
+
+    // 在本线程的独立连接上读写，默认连接属于主线程
+    QString connectionName = Database::instance().openThreadConnection("restore");
+    if (connectionName.isEmpty()) {
+        emit errorOccurred("恢复失败: 无法打开数据库连接");
+        return false;
+    }
+
+    QString error;
+    bool ok = VaultBackup::restore(QSqlDatabase::database(connectionName, false), m_filename, progress, &error);
+    Database::closeThreadConnection(connectionName);
+    if (!ok) {
+        if (!isCancelRequested()) {
+            emit errorOccurred(QString("恢复失败: %1").arg(error));
+        }
+        return false;
+    }
+
+    // 恢复时直接替换了forms表
+    Database::instance().invalidateFormCache();
+    emit progressChanged(100, "恢复完成");
+    return true;
+}
+
+bool ImportExportWorker::snapshotDatabase()
+{
+    emit progressChanged(0, "开始生成数据库快照...");
+
+    // 备份在本线程的独立连接上分步进行，主线程的连接可以继续正常读写
+    auto progress = [this](int remaining, int total) {
+        int copied = total - remaining;
+        int percent = total > 0 ? static_cast<int>(qMin<qint64>(99, static_cast<qint64>(copied) * 100 / total)) : 0;
+        emit progressChanged(percent, QString("正在复制数据库页面 %1/%2...").arg(copied).arg(total));
+        return !isCancelRequested();
+    };
+
+    if (!Database::instance().backupTo(m_filename, progress)) {
+        if (!isCancelRequested()) {
+            emit errorOccurred(QString("无法生成数据库快照: %1").arg(m_filename));
+        }
+        return false;
+    }
+
+    emit progressChanged(100, "数据库快照完成");
+    return true;
+}
@@ -1,51 +1,80 @@
-#ifndef IMPORTEXPORTWORKER_H
-#define IMPORTEXPORTWORKER_H
-
-#include <QObject>
-#include <QThread>
-#include <QList>
-#include <QSqlDatabase>
-#include <QSqlQuery>
-#include "database.h"
-
-              class ImportExportWorker : public QObject
-{
-    Q_OBJECT
-
-public:
-    enum OperationType {
-        ImportOperation,
-        ExportOperation,
-        ExportSelectedOperation
-    };
-
-    explicit ImportExportWorker(QObject *parent = nullptr);
-
-    void setOperationType(OperationType type) { m_operationType = type; }
-    void setFilename(const QString &filename) { m_filename = filename; }
-    void setSelectedRows(const QList<int> &selectedRows) { m_selectedRows = selectedRows; }
-    void setExportEncrypted(bool encrypted) { m_exportEncrypted = encrypted; }
-    void setFormId(int formId) { m_formId = formId; }  // 新增
-
-public slots:
-    void startOperation();
-
-signals:
-    void progressChanged(int percent, const QString &message);
-    void operationFinished(bool success, const QString &message);
-    void errorOccurred(const QString &error);
-
-private:
-    OperationType m_operationType;
-    QString m_filename;
-    QList<int> m_selectedRows;
-    bool m_exportEncrypted;
-    int m_formId;  // 新增
-
-    bool importFromCSV();
-    bool exportToCSV();
-    bool exportSelectedToCSV(const QList<int> &selectedRows);
-};
-
-#endif // IMPORTEXPORTWORKER_H
-
+#ifndef IMPORTEXPORTWORKER_H
+#define IMPORTEXPORTWORKER_H
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QAtomicInt>
+#include <QIODevice>
+#include <functional>
+#include "database.h"
+
+class ImportReader;
+
+class ImportExportWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum OperationType {
+        ImportOperation,
+        ExportOperation,
+        ExportSelectedOperation,
+        BackupOperation,   // 二进制备份整个密码库
+        RestoreOperation,  // 从二进制备份恢复（替换现有数据）
+        SnapshotOperation  // 数据库文件热备份
+    };
+
+    explicit ImportExportWorker(QObject *parent = nullptr);
+
+    void setOperationType(OperationType type) { m_operationType = type; }
+    OperationType operationType() const { return m_operationType; }
+    void setFilename(const QString &filename) { m_filename = filename; }
+    void setSelectedIds(const QList<int> &selectedIds) { m_selectedIds = selectedIds; }  // 选中记录的数据库ID
+    void setExportEncrypted(bool encrypted) { m_exportEncrypted = encrypted; }
+    void setPassphrase(const QString &passphrase) { m_passphrase = passphrase; }  // 非空时导出为加密文件
+    void setFormId(int formId) { m_formId = formId; }  // 新增
+
+    // 请求取消，可以从任意线程调用，工作线程会在下一条记录处停止
+    void requestCancel() { m_cancelRequested.storeRelease(1); }
+    bool isCancelRequested() const { return m_cancelRequested.loadAcquire() != 0; }
+
+public slots:
+    void startOperation();
+
+signals:
+    void progressChanged(int percent, const QString &message);
+    void operationFinished(bool success, const QString &message);
+    void errorOccurred(const QString &error);
+
+private:
+    OperationType m_operationType;
+    QString m_filename;
+    QList<int> m_selectedIds;
+    bool m_exportEncrypted;
+    QString m_passphrase;
+    int m_formId;  // 新增
+    QAtomicInt m_cancelRequested;
+    StorageBackend *m_storage;  // 本线程使用的存储引擎，只在导入导出期间有效
+
+    // 导入CSV、JSON Lines、KeePass XML或Bitwarden JSON（按文件内容判断），返回是否导入了记录
+    bool importFromFile();
+    int importCSV(QIODevice &file);
+    int importJsonLines(QIODevice &file, int *skippedCount);
+    int importWithReader(QIODevice &file, ImportReader &reader, int *skippedCount);  // 解析出错返回-1
+    bool exportToCSV();
+    bool exportSelectedToCSV(const QList<int> &selectedIds);
+    bool backupVault();
+    bool restoreVault();
+    bool snapshotDatabase();
+    // 分块并行格式化（CSV或JSON Lines，按文件扩展名）并按顺序写出，返回导出条数，写入失败返回-1
+    int writeExportBlocks(QIODevice &file, const std::function<QList<PasswordEntry>()> &fetchNextBlock, int totalCount);
+
+    static const int EXPORT_BLOCK_SIZE = 2000;  // 每个导出块的记录数
+    static const int IMPORT_BLOCK_SIZE = 1000;  // 导入时每块的行数/记录数
+};
+
+#endif // IMPORTEXPORTWORKER_H
+
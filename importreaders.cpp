@@ -0,0 +1,341 @@
+#include "importreaders.h"
+#include "encryption.h"
+#include <QDebug>
+
+// 网址不作为网站名称时追加到备注中，避免丢失
+static QString appendNoteLine(const QString &notes, const QString &line)
+{
+    if (line.isEmpty()) {
+        return notes;
+    }
+    return notes.isEmpty() ? line : notes + "\n" + line;
+}
+
+// 填写记录内容，账号和密码按数据库中的形式加密
+static void fillRecord(ImportRecord &record, const QString &title, const QString &url,
+                       const QString &username, const QString &password, const QString &notes)
+{
+    record.entry.website = title.isEmpty() ? url : title;
+    record.entry.username = username;
+    record.entry.account = Encryption::encrypt(username);
+    record.entry.password = Encryption::encrypt(password);
+    record.entry.notes = notes;
+    if (!url.isEmpty() && url != record.entry.website) {
+        record.entry.notes = appendNoteLine(notes, QString("URL: %1").arg(url));
+    }
+
+    record.valid = !record.entry.website.isEmpty();
+    if (!record.valid) {
+        record.error = "缺少标题和网址";
+    }
+}
+
+// ---------- KeePass XML ----------
+
+KeePassXmlReader::KeePassXmlReader(QIODevice *device)
+    : m_xml(device)
+    , m_recycleBinEnabled(true)  // KeePass默认启用回收站
+{
+}
+
+void KeePassXmlReader::setError(const QString &error)
+{
+    m_error = QString("%1（第 %2 行）").arg(error).arg(m_xml.lineNumber());
+    qDebug() << "KeePass XML解析失败:" << m_error;
+}
+
+bool KeePassXmlReader::readNext(ImportRecord &record)
+{
+    while (!m_xml.atEnd()) {
+        QXmlStreamReader::TokenType token = m_xml.readNext();
+
+        if (token == QXmlStreamReader::StartElement) {
+            QString name = m_xml.name().toString();
+            QString parent = m_path.isEmpty() ? QString() : m_path.last();
+
+            if (m_path.isEmpty() && name != "KeePassFile") {
+                setError("不是KeePass导出的XML文件");
+                return false;
+            }
+
+            if (parent == "Meta" && name == "RecycleBinUUID") {
+                m_recycleBinUuid = m_xml.readElementText();
+                continue;
+            }
+            if (parent == "Meta" && name == "RecycleBinEnabled") {
+                m_recycleBinEnabled = m_xml.readElementText().compare("True", Qt::CaseInsensitive) == 0;
+                continue;
+            }
+            if (parent == "Group" && name == "Name") {
+                m_groups.last() = m_xml.readElementText();
+                continue;
+            }
+            if (parent == "Group" && name == "UUID") {
+                QString uuid = m_xml.readElementText();
+                if (m_recycleBinEnabled && !uuid.isEmpty() && uuid == m_recycleBinUuid) {
+                    // 回收站中的条目不导入，直接跳过整个分组
+                    m_xml.skipCurrentElement();
+                    m_path.removeLast();
+                    m_groups.removeLast();
+                }
+                continue;
+            }
+            if (parent == "Group" && name == "Entry") {
+                readEntry(record);
+                return !hasError();
+            }
+
+            m_path.append(name);
+            if (name == "Group") {
+                m_groups.append(QString());
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (!m_path.isEmpty() && m_path.takeLast() == "Group") {
+                m_groups.removeLast();
+            }
+        }
+    }
+
+    if (m_xml.hasError()) {
+        setError(m_xml.errorString());
+    }
+    return false;
+}
+
+void KeePassXmlReader::readEntry(ImportRecord &record)
+{
+    record = makeImportRecord(static_cast<int>(m_xml.lineNumber()));
+    record.formName = m_groups.isEmpty() ? QString() : m_groups.last();
+
+    QHash<QString, QString> fields;
+    bool protectedValue = false;
+
+    // 只读取当前条目的String字段，History（历史版本）、Times、AutoType等整体跳过
+    while (m_xml.readNextStartElement()) {
+        if (m_xml.name() != QLatin1String("String")) {
+            m_xml.skipCurrentElement();
+            continue;
+        }
+
+        QString key;
+        QString value;
+        while (m_xml.readNextStartElement()) {
+            if (m_xml.name() == QLatin1String("Key")) {
+                key = m_xml.readElementText();
+            } else if (m_xml.name() == QLatin1String("Value")) {
+                if (m_xml.attributes().value("Protected") == QLatin1String("True")) {
+                    protectedValue = true;
+                }
+                value = m_xml.readElementText();
+            } else {
+                m_xml.skipCurrentElement();
+            }
+        }
+        fields.insert(key, value);
+    }
+
+    if (m_xml.hasError()) {
+        setError(m_xml.errorString());
+        return;
+    }
+
+    fillRecord(record, fields.value("Title"), fields.value("URL"), fields.value("UserName"),
+               fields.value("Password"), fields.value("Notes"));
+    if (protectedValue) {
+        // 数据库内部XML中的受保护字段经过加密，只能导入KeePass“导出为XML”生成的明文文件
+        record.valid = false;
+        record.error = "字段内容已加密，请在KeePass中导出为未加密的XML文件";
+    }
+}
+
+// ---------- Bitwarden JSON ----------
+
+BitwardenJsonReader::BitwardenJsonReader(QIODevice *device)
+    : m_json(device)
+    , m_inItems(false)
+    , m_itemCount(0)
+{
+}
+
+void BitwardenJsonReader::setError(const QString &error)
+{
+    m_error = error;
+    qDebug() << "Bitwarden JSON解析失败:" << m_error;
+}
+
+bool BitwardenJsonReader::readNext(ImportRecord &record)
+{
+    for (;;) {
+        JsonStreamReader::TokenType token = m_json.readNext();
+
+        if (m_inItems) {
+            if (token == JsonStreamReader::StartObject) {
+                readItem(record);
+                return !hasError();
+            }
+            if (token == JsonStreamReader::EndArray) {
+                m_inItems = false;
+                continue;
+            }
+            setError(m_json.hasError() ? m_json.errorString() : QString("items中的条目格式错误"));
+            return false;
+        }
+
+        switch (token) {
+        case JsonStreamReader::StartObject:
+        case JsonStreamReader::EndObject:
+            continue;  // 最外层对象
+        case JsonStreamReader::Name: {
+            QString key = m_json.text();
+            if (key == "encrypted") {
+                if (m_json.readNext() == JsonStreamReader::Bool && m_json.boolValue()) {
+                    setError("这是加密的Bitwarden导出文件，请在Bitwarden中导出为未加密的JSON格式");
+                    return false;
+                }
+                m_json.skipCurrentValue();
+            } else if (key == "folders" || key == "collections") {
+                if (!readFolders()) {
+                    setError(m_json.hasError() ? m_json.errorString() : QString("%1格式错误").arg(key));
+                    return false;
+                }
+            } else if (key == "items") {
+                if (m_json.readNext() != JsonStreamReader::StartArray) {
+                    setError("items格式错误");
+                    return false;
+                }
+                m_inItems = true;
+            } else {
+                m_json.skipCurrentValue();
+            }
+            continue;
+        }
+        case JsonStreamReader::EndDocument:
+            return false;
+        case JsonStreamReader::Invalid:
+            setError(m_json.errorString());
+            return false;
+        default:
+            setError("不是Bitwarden导出的JSON文件");
+            return false;
+        }
+    }
+}
+
+bool BitwardenJsonReader::readFolders()
+{
+    // 文件夹和集合都是 [{"id": ..., "name": ...}] 的形式，Bitwarden导出时写在items之前
+    if (m_json.readNext() != JsonStreamReader::StartArray) {
+        return m_json.skipCurrentValue();  // null
+    }
+
+    while (m_json.readNext() == JsonStreamReader::StartObject) {
+        QString id;
+        QString name;
+        while (m_json.readNext() == JsonStreamReader::Name) {
+            QString key = m_json.text();
+            if (key == "id") {
+                id = m_json.readValueText();
+            } else if (key == "name") {
+                name = m_json.readValueText();
+            } else {
+                m_json.skipCurrentValue();
+            }
+        }
+        if (!id.isEmpty()) {
+            m_folders.insert(id, name);
+        }
+    }
+    return m_json.tokenType() == JsonStreamReader::EndArray;
+}
+
+void BitwardenJsonReader::readItem(ImportRecord &record)
+{
+    record = makeImportRecord(++m_itemCount);
+
+    int type = 0;
+    QString name;
+    QString notes;
+    QString folderId;
+    QString collectionId;
+    QString username;
+    QString password;
+    QString uri;
+    QStringList customFields;
+
+    while (m_json.readNext() == JsonStreamReader::Name) {
+        QString key = m_json.text();
+        if (key == "type") {
+            type = m_json.readValueText().toInt();
+        } else if (key == "name") {
+            name = m_json.readValueText();
+        } else if (key == "notes") {
+            notes = m_json.readValueText();
+        } else if (key == "folderId") {
+            folderId = m_json.readValueText();
+        } else if (key == "collectionIds" && m_json.readNext() == JsonStreamReader::StartArray) {
+            while (m_json.readNext() == JsonStreamReader::String) {
+                if (collectionId.isEmpty()) {
+                    collectionId = m_json.text();  // 属于多个集合时取第一个
+                }
+            }
+        } else if (key == "login" && m_json.readNext() == JsonStreamReader::StartObject) {
+            while (m_json.readNext() == JsonStreamReader::Name) {
+                QString loginKey = m_json.text();
+                if (loginKey == "username") {
+                    username = m_json.readValueText();
+                } else if (loginKey == "password") {
+                    password = m_json.readValueText();
+                } else if (loginKey == "uris" && m_json.readNext() == JsonStreamReader::StartArray) {
+                    while (m_json.readNext() == JsonStreamReader::StartObject) {
+                        while (m_json.readNext() == JsonStreamReader::Name) {
+                            if (m_json.text() == "uri" && uri.isEmpty()) {
+                                uri = m_json.readValueText();  // 只保留第一个网址
+                            } else {
+                                m_json.skipCurrentValue();
+                            }
+                        }
+                    }
+                } else {
+                    m_json.skipCurrentValue();
+                }
+            }
+        } else if (key == "fields" && m_json.readNext() == JsonStreamReader::StartArray) {
+            // 自定义字段追加到备注中
+            while (m_json.readNext() == JsonStreamReader::StartObject) {
+                QString fieldName;
+                QString fieldValue;
+                while (m_json.readNext() == JsonStreamReader::Name) {
+                    QString fieldKey = m_json.text();
+                    if (fieldKey == "name") {
+                        fieldName = m_json.readValueText();
+                    } else if (fieldKey == "value") {
+                        fieldValue = m_json.readValueText();
+                    } else {
+                        m_json.skipCurrentValue();
+                    }
+                }
+                customFields.append(QString("%1: %2").arg(fieldName, fieldValue));
+            }
+        } else {
+            // 其他字段，以及值为null的collectionIds/login/fields
+            m_json.skipCurrentValue();
+        }
+    }
+
+    if (m_json.hasError()) {
+        setError(m_json.errorString());
+        return;
+    }
+
+    record.formName = m_folders.value(folderId.isEmpty() ? collectionId : folderId);
+    for (const QString &field : customFields) {
+        notes = appendNoteLine(notes, field);
+    }
+    fillRecord(record, name, uri, username, password, notes);
+
+    // 1：登录，2：安全笔记；银行卡和身份信息没有对应的字段
+    if (type != 1 && type != 2) {
+        record.valid = false;
+        record.error = QString("不支持的条目类型 %1（只导入登录和安全笔记）").arg(type);
+    }
+}
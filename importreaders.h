@@ -0,0 +1,87 @@
+#ifndef IMPORTREADERS_H
+#define IMPORTREADERS_H
+
+#include <QIODevice>
+#include <QXmlStreamReader>
+#include <QStringList>
+#include <QHash>
+#include "database.h"
+#include "jsonstreamreader.h"
+
+// 导入时解析出的一条记录，账号和密码已经是数据库中的加密形式
+struct ImportRecord {
+    int position;     // 行号（JSON Lines、XML）或条目序号（Bitwarden），用于提示
+    bool valid;
+    QString error;    // 记录无效的原因
+    QString formName; // 所属表单名称，空表示未指定
+    int formId;       // 所属表单ID，-1表示未指定
+    PasswordEntry entry;
+};
+
+inline ImportRecord makeImportRecord(int position)
+{
+    ImportRecord record;
+    record.position = position;
+    record.valid = false;
+    record.formId = -1;
+    record.entry.id = -1;
+    record.entry.form_id = -1;
+    return record;
+}
+
+// 其他密码管理器导出文件的流式读取接口：每次读取一条记录，内存占用与文件大小无关
+class ImportReader
+{
+public:
+    virtual ~ImportReader() {}
+    // 读取下一条记录，文件结束或出错时返回false（用hasError()区分）
+    virtual bool readNext(ImportRecord &record) = 0;
+    virtual bool hasError() const = 0;
+    virtual QString errorString() const = 0;
+};
+
+// KeePass 2.x 导出的XML文件（KeePassFile）：分组对应表单，跳过历史记录和回收站
+class KeePassXmlReader : public ImportReader
+{
+public:
+    explicit KeePassXmlReader(QIODevice *device);
+
+    bool readNext(ImportRecord &record) override;
+    bool hasError() const override { return !m_error.isEmpty(); }
+    QString errorString() const override { return m_error; }
+
+private:
+    void readEntry(ImportRecord &record);
+    void setError(const QString &error);
+
+    QXmlStreamReader m_xml;
+    QStringList m_path;    // 当前所在的元素路径
+    QStringList m_groups;  // 当前所在的分组名称
+    QString m_recycleBinUuid;
+    bool m_recycleBinEnabled;
+    QString m_error;
+};
+
+// Bitwarden导出的未加密JSON文件：文件夹（组织导出为集合）对应表单，导入登录和安全笔记条目
+class BitwardenJsonReader : public ImportReader
+{
+public:
+    explicit BitwardenJsonReader(QIODevice *device);
+
+    bool readNext(ImportRecord &record) override;
+    bool hasError() const override { return !m_error.isEmpty(); }
+    QString errorString() const override { return m_error; }
+
+private:
+    bool readFolders();
+    void readItem(ImportRecord &record);
+    void setError(const QString &error);
+
+    JsonStreamReader m_json;
+    QHash<QString, QString> m_folders;  // 文件夹/集合ID -> 名称
+    bool m_inItems;
+    int m_itemCount;
+    QString m_error;
+};
+
+#endif // IMPORTREADERS_H
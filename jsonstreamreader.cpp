@@ -0,0 +1,381 @@
+#include "jsonstreamreader.h"
+
+static const int READ_CHUNK_SIZE = 64 * 1024;
+static const int MAX_DEPTH = 512;
+
+JsonStreamReader::JsonStreamReader(QIODevice *device)
+    : m_device(device)
+    , m_pos(0)
+    , m_consumed(0)
+    , m_state(ExpectTopValue)
+    , m_token(NoToken)
+    , m_number(0)
+    , m_bool(false)
+{
+}
+
+JsonStreamReader::JsonStreamReader(const QByteArray &data)
+    : m_device(nullptr)
+    , m_data(data)
+    , m_pos(0)
+    , m_consumed(0)
+    , m_state(ExpectTopValue)
+    , m_token(NoToken)
+    , m_number(0)
+    , m_bool(false)
+{
+}
+
+// 保证缓冲区中至少还有count个未读字节，设备读完时返回false
+bool JsonStreamReader::fill(int count)
+{
+    if (m_data.size() - m_pos >= count) {
+        return true;
+    }
+    if (!m_device) {
+        return false;
+    }
+
+    // 丢弃已读部分，再从设备补充数据
+    if (m_pos > 0) {
+        m_data.remove(0, m_pos);
+        m_consumed += m_pos;
+        m_pos = 0;
+    }
+    while (m_data.size() < count) {
+        QByteArray chunk = m_device->read(qMax(READ_CHUNK_SIZE, count - m_data.size()));
+        if (chunk.isEmpty()) {
+            return false;
+        }
+        m_data.append(chunk);
+    }
+    return true;
+}
+
+int JsonStreamReader::peekByte()
+{
+    if (!fill(1)) {
+        return -1;
+    }
+    return static_cast<unsigned char>(m_data.at(m_pos));
+}
+
+void JsonStreamReader::skipWhitespace()
+{
+    for (;;) {
+        int c = peekByte();
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            m_pos++;
+        } else if (c == 0xEF && m_consumed + m_pos == 0 && fill(3)
+                   && m_data.at(m_pos + 1) == '\xBB' && m_data.at(m_pos + 2) == '\xBF') {
+            m_pos += 3;  // 文件开头的UTF-8 BOM
+        } else {
+            return;
+        }
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReader::raiseError(const QString &error)
+{
+    m_error = QString("%1（位置 %2）").arg(error).arg(offset());
+    m_state = Finished;
+    m_token = Invalid;
+    return m_token;
+}
+
+void JsonStreamReader::valueDone()
+{
+    if (m_stack.isEmpty()) {
+        m_state = ExpectTopEnd;
+    } else {
+        m_state = m_stack.last() == '{' ? ExpectObjectNext : ExpectArrayNext;
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readNext()
+{
+    if (m_state == Finished) {
+        return m_token;
+    }
+
+    for (;;) {
+        skipWhitespace();
+        int c = peekByte();
+
+        switch (m_state) {
+        case ExpectTopValue:
+        case ExpectObjectValue:
+        case ExpectArrayValue:
+            if (c < 0) {
+                return raiseError("JSON数据不完整");
+            }
+            return readValue();
+
+        case ExpectFirstValue:
+            if (c == ']') {
+                m_pos++;
+                m_stack.removeLast();
+                valueDone();
+                m_token = EndArray;
+                return m_token;
+            }
+            if (c < 0) {
+                return raiseError("JSON数据不完整");
+            }
+            return readValue();
+
+        case ExpectFirstName:
+        case ExpectName:
+            if (c == '}' && m_state == ExpectFirstName) {
+                m_pos++;
+                m_stack.removeLast();
+                valueDone();
+                m_token = EndObject;
+                return m_token;
+            }
+            if (c != '"') {
+                return raiseError("对象中缺少字段名");
+            }
+            if (!readString(m_text)) {
+                return m_token;
+            }
+            skipWhitespace();
+            if (peekByte() != ':') {
+                return raiseError("字段名后缺少冒号");
+            }
+            m_pos++;
+            m_state = ExpectObjectValue;
+            m_token = Name;
+            return m_token;
+
+        case ExpectObjectNext:
+        case ExpectArrayNext: {
+            char close = m_state == ExpectObjectNext ? '}' : ']';
+            if (c == ',') {
+                m_pos++;
+                m_state = m_state == ExpectObjectNext ? ExpectName : ExpectArrayValue;
+                continue;
+            }
+            if (c == close) {
+                m_pos++;
+                m_stack.removeLast();
+                valueDone();
+                m_token = close == '}' ? EndObject : EndArray;
+                return m_token;
+            }
+            return raiseError(c < 0 ? QString("JSON数据不完整") : QString("缺少逗号或结束括号"));
+        }
+
+        case ExpectTopEnd:
+            if (c >= 0) {
+                return raiseError("JSON数据之后还有多余的内容");
+            }
+            m_state = Finished;
+            m_token = EndDocument;
+            return m_token;
+
+        case Finished:
+            return m_token;
+        }
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readValue()
+{
+    int c = peekByte();
+    switch (c) {
+    case '{':
+    case '[':
+        if (m_stack.size() >= MAX_DEPTH) {
+            return raiseError("JSON嵌套层数过多");
+        }
+        m_pos++;
+        m_stack.append(static_cast<char>(c));
+        m_state = c == '{' ? ExpectFirstName : ExpectFirstValue;
+        m_token = c == '{' ? StartObject : StartArray;
+        return m_token;
+    case '"':
+        if (!readString(m_text)) {
+            return m_token;
+        }
+        valueDone();
+        m_token = String;
+        return m_token;
+    case 't':
+        return readLiteral("true", Bool, true);
+    case 'f':
+        return readLiteral("false", Bool, false);
+    case 'n':
+        return readLiteral("null", Null, false);
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return readNumber();
+        }
+        return raiseError("无法识别的JSON值");
+    }
+}
+
+bool JsonStreamReader::readHex4(uint &value)
+{
+    if (!fill(4)) {
+        return false;
+    }
+    bool ok;
+    value = m_data.mid(m_pos, 4).toUInt(&ok, 16);
+    m_pos += 4;
+    return ok;
+}
+
+bool JsonStreamReader::readString(QString &out)
+{
+    m_pos++;  // 开头的引号
+    QByteArray utf8;
+
+    for (;;) {
+        if (!fill(1)) {
+            raiseError("字符串没有结束");
+            return false;
+        }
+
+        // 先整段复制不需要转义的字节
+        int start = m_pos;
+        while (m_pos < m_data.size()) {
+            unsigned char c = static_cast<unsigned char>(m_data.at(m_pos));
+            if (c == '"' || c == '\\' || c < 0x20) {
+                break;
+            }
+            m_pos++;
+        }
+        utf8.append(m_data.constData() + start, m_pos - start);
+        if (m_pos == m_data.size()) {
+            continue;
+        }
+
+        char c = m_data.at(m_pos++);
+        if (c == '"') {
+            out = QString::fromUtf8(utf8);
+            return true;
+        }
+        if (c != '\\') {
+            raiseError("字符串中包含未转义的控制字符");
+            return false;
+        }
+
+        if (!fill(1)) {
+            raiseError("字符串没有结束");
+            return false;
+        }
+        char escape = m_data.at(m_pos++);
+        switch (escape) {
+        case '"': utf8.append('"'); break;
+        case '\\': utf8.append('\\'); break;
+        case '/': utf8.append('/'); break;
+        case 'b': utf8.append('\b'); break;
+        case 'f': utf8.append('\f'); break;
+        case 'n': utf8.append('\n'); break;
+        case 'r': utf8.append('\r'); break;
+        case 't': utf8.append('\t'); break;
+        case 'u': {
+            uint code;
+            if (!readHex4(code)) {
+                raiseError("无效的\\u转义");
+                return false;
+            }
+            // 代理对：高位代理后面必须跟着\u低位代理
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                uint low;
+                if (!fill(2) || m_data.at(m_pos) != '\\' || m_data.at(m_pos + 1) != 'u') {
+                    raiseError("不完整的UTF-16代理对");
+                    return false;
+                }
+                m_pos += 2;
+                if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                    raiseError("不完整的UTF-16代理对");
+                    return false;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                raiseError("不完整的UTF-16代理对");
+                return false;
+            }
+            const char32_t ucs4 = code;
+            utf8.append(QString::fromUcs4(&ucs4, 1).toUtf8());
+            break;
+        }
+        default:
+            raiseError("无效的转义字符");
+            return false;
+        }
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readNumber()
+{
+    QByteArray literal;
+    for (;;) {
+        int c = peekByte();
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            literal.append(static_cast<char>(c));
+            m_pos++;
+        } else {
+            break;
+        }
+    }
+
+    bool ok;
+    m_number = literal.toDouble(&ok);
+    if (!ok) {
+        return raiseError("无效的数字");
+    }
+    m_text = QString::fromLatin1(literal);
+    valueDone();
+    m_token = Number;
+    return m_token;
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readLiteral(const char *literal, TokenType type, bool value)
+{
+    int length = static_cast<int>(qstrlen(literal));
+    if (!fill(length) || qstrncmp(m_data.constData() + m_pos, literal, length) != 0) {
+        return raiseError("无法识别的JSON值");
+    }
+    m_pos += length;
+    m_bool = value;
+    m_text = QString::fromLatin1(literal);
+    valueDone();
+    m_token = type;
+    return m_token;
+}
+
+bool JsonStreamReader::skipCurrentValue()
+{
+    if (m_token == Name) {
+        readNext();
+    }
+    if (m_token == StartObject || m_token == StartArray) {
+        int level = depth();
+        while (readNext() != Invalid) {
+            if ((m_token == EndObject || m_token == EndArray) && depth() < level) {
+                break;
+            }
+        }
+    }
+    return !hasError();
+}
+
+QString JsonStreamReader::readValueText()
+{
+    readNext();
+    switch (m_token) {
+    case String:
+    case Number:
+    case Bool:
+        return m_text;
+    case StartObject:
+    case StartArray:
+        skipCurrentValue();
+        return QString();
+    default:
+        return QString();
+    }
+}
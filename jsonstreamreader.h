@@ -0,0 +1,88 @@
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// 增量JSON读取器，用法与QXmlStreamReader类似：每次readNext()返回一个记号
+// 从设备读取时只缓存一小段数据，不需要把整个文件读入内存或构造QJsonDocument
+class JsonStreamReader
+{
+public:
+    enum TokenType {
+        NoToken,
+        Invalid,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        Name,
+        String,
+        Number,
+        Bool,
+        Null,
+        EndDocument
+    };
+
+    explicit JsonStreamReader(QIODevice *device);
+    explicit JsonStreamReader(const QByteArray &data);
+
+    TokenType readNext();
+    TokenType tokenType() const { return m_token; }
+    bool atEnd() const { return m_token == EndDocument || m_token == Invalid; }
+    bool hasError() const { return m_token == Invalid; }
+    QString errorString() const { return m_error; }
+
+    QString text() const { return m_text; }  // Name/String的内容，Number的原文
+    double numberValue() const { return m_number; }
+    bool boolValue() const { return m_bool; }
+    int depth() const { return m_stack.size(); }  // 当前所在的对象/数组层数
+    qint64 offset() const { return m_consumed + m_pos; }  // 已读取的字节数
+
+    // 跳过当前值：当前为Name时跳过它的值，为StartObject/StartArray时跳到对应的结束记号
+    bool skipCurrentValue();
+    // 读取Name之后的值，字符串/数字/布尔值转为文本，对象和数组被跳过并返回空串
+    QString readValueText();
+
+private:
+    enum State {
+        ExpectTopValue,
+        ExpectTopEnd,
+        ExpectFirstName,    // '{' 之后
+        ExpectName,         // 对象中 ',' 之后
+        ExpectObjectValue,  // ':' 之后
+        ExpectObjectNext,   // 对象中的值之后
+        ExpectFirstValue,   // '[' 之后
+        ExpectArrayValue,   // 数组中 ',' 之后
+        ExpectArrayNext,    // 数组中的值之后
+        Finished
+    };
+
+    bool fill(int count);
+    int peekByte();
+    void skipWhitespace();
+    TokenType readValue();
+    bool readString(QString &out);
+    bool readHex4(uint &value);
+    TokenType readNumber();
+    TokenType readLiteral(const char *literal, TokenType type, bool value);
+    void valueDone();
+    TokenType raiseError(const QString &error);
+
+    QIODevice *m_device;
+    QByteArray m_data;
+    int m_pos;
+    qint64 m_consumed;  // 已从缓冲区丢弃的字节数
+
+    State m_state;
+    QVector<char> m_stack;
+    TokenType m_token;
+    QString m_text;
+    double m_number;
+    bool m_bool;
+    QString m_error;
+};
+
+#endif // JSONSTREAMREADER_H
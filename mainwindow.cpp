@@ -1,1735 +1,2012 @@
-#include "mainwindow.h"
-#include "database.h"
-#include "encryption.h"
-#include "importexportworker.h"
-#include "formtabwidget.h"
-#include "formselectdialog.h"
-#include <QVBoxLayout>
-#include <QHBoxLayout>
-#include <QTableView>
-#include <QHeaderView>
-#include <QPushButton>
-#include <QLineEdit>
-#include <QMenuBar>
-#include <QMenu>
-#include <QAction>
-#include <QMessageBox>
-#include <QFileDialog>
-#include <QStandardItemModel>
-#include <QInputDialog>
-#include <QStatusBar>
-#include <QTextStream>
-#include <QDebug>
-#include <QCheckBox>
-#include <QItemSelectionModel>
-#include <QAbstractItemView>
-#include <QFileInfo>
-#include <QProgressDialog>
-#include <QApplication>
-#include <QRadioButton>
-#include <QButtonGroup>
-#include <QGroupBox>
-#include <QDialogButtonBox>
-#include <QToolButton>
-#include <QStandardPaths>
-
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), model(new QStandardItemModel(this)),
-    progressDialog(nullptr), workerThread(nullptr), worker(nullptr),
-    operationInProgress(false), multiSelectMode(false),
-    lastSelectedRow(-1), isAllSelected(false),
-    currentFormId(-1)
-{
-    qDebug() << "MainWindow构造函数开始";
-
-    // 先初始化数据库
-    if (!Database::instance().init()) {
-        QMessageBox::critical(this, "数据库错误",
-                              "无法初始化数据库，程序可能无法正常工作。\n请检查SQLite驱动是否可用。");
-        // 这里不退出，尝试继续运行，但可能功能受限
-    } else {
-        qDebug() << "数据库初始化成功";
-    }
-
-    setupUI();
-    loadForms();  // 先加载表单
-    loadPasswords();  // 然后加载当前表单的密码
-}
-
-MainWindow::~MainWindow()
-{
-    // 清理多线程资源
-    if (workerThread && workerThread->isRunning()) {
-        workerThread->quit();
-        workerThread->wait();
-    }
-
-    delete worker;
-    delete workerThread;
-    delete progressDialog;
-}
-
-void MainWindow::setupUI()
-{
-    setWindowTitle("个人密码管理器（多线程+表单）");
-    resize(1000, 700);
-
-    // 中央部件
-    QWidget *centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
-
-    // 主布局
-    QVBoxLayout *mainLayout = new QVBoxLayout(centralWidget);
-
-    // 搜索栏
-    QHBoxLayout *searchLayout = new QHBoxLayout();
-    searchEdit = new QLineEdit();
-    searchEdit->setPlaceholderText("搜索网站、用户名...");
-    searchButton = new QPushButton("搜索");
-
-    // 新增：选择表单按钮
-    selectFormsButton = new QToolButton();
-    selectFormsButton->setText("▼");  // 实心倒三角
-    selectFormsButton->setToolTip("选择搜索表单");
-    selectFormsButton->setPopupMode(QToolButton::InstantPopup);
-
-    // 创建下拉菜单
-    QMenu *formSelectMenu = new QMenu(this);
-    QAction *selectFormsAction = new QAction("选择表单...", this);
-    connect(selectFormsAction, &QAction::triggered, this, &MainWindow::onSelectFormsClicked);
-    formSelectMenu->addAction(selectFormsAction);
-    selectFormsButton->setMenu(formSelectMenu);
-
-    // 连接搜索按钮的点击事件
-    connect(searchButton, &QPushButton::clicked, this, &MainWindow::searchPasswords);
-
-    // 连接回车键事件
-    connect(searchEdit, &QLineEdit::returnPressed, this, &MainWindow::searchPasswords);
-
-    searchLayout->addWidget(searchEdit);
-    searchLayout->addWidget(selectFormsButton);
-    searchLayout->addWidget(searchButton);
-    searchLayout->addStretch();
-
-    // 表单标签栏
-    formTabWidget = new FormTabWidget();
-    connect(formTabWidget, &FormTabWidget::formAdded, this, &MainWindow::onFormAdded);
-    connect(formTabWidget, &FormTabWidget::formRemoved, this, &MainWindow::onFormRemoved);
-    connect(formTabWidget, &FormTabWidget::formRenamed, this, &MainWindow::onFormRenamed);
-    connect(formTabWidget, &FormTabWidget::currentFormChanged, this, &MainWindow::onCurrentFormChanged);
-    connect(formTabWidget, &FormTabWidget::formSelectionChanged, this, &MainWindow::onFormSelectionChanged);
-
-    mainLayout->addLayout(searchLayout);
-    mainLayout->addWidget(formTabWidget);
-
-    // 表格
-    tableView = new QTableView();
-    setupTable();
-    mainLayout->addWidget(tableView);
-
-    // 按钮栏
-    addButton = new QPushButton("添加密码");
-    editButton = new QPushButton("编辑");
-    deleteButton = new QPushButton("删除");
-    exportButton = new QPushButton("导出");
-    importButton = new QPushButton("导入");
-    testButton = new QPushButton("测试数据库");
-
-    // 多选和全选按钮
-    multiSelectButton = new QPushButton("多选");
-    selectAllButton = new QPushButton("全选");
-    selectAllButton->setEnabled(false);
-
-    connect(multiSelectButton, &QPushButton::clicked, this, &MainWindow::toggleMultiSelectMode);
-    connect(selectAllButton, &QPushButton::clicked, this, &MainWindow::selectAll);
-
-    // 显示/隐藏密码按钮
-    showPasswordButton = new QPushButton("显示密码");
-    connect(showPasswordButton, &QPushButton::clicked, [this]() {
-        bool isHidden = tableView->isColumnHidden(4);  // 第4列是密码列
-        tableView->setColumnHidden(4, !isHidden);
-        if (isHidden) {
-            this->showPasswordButton->setText("隐藏密码");
-        } else {
-            this->showPasswordButton->setText("显示密码");
-        }
-    });
-
-    connect(addButton, &QPushButton::clicked, this, &MainWindow::addPassword);
-    connect(editButton, &QPushButton::clicked, this, &MainWindow::editPassword);
-    connect(deleteButton, &QPushButton::clicked, this, &MainWindow::deletePassword);
-    connect(exportButton, &QPushButton::clicked, this, &MainWindow::exportPasswords);
-    connect(importButton, &QPushButton::clicked, this, &MainWindow::importPasswords);
-    connect(testButton, &QPushButton::clicked, this, &MainWindow::testDatabase);
-
-    // 第一行按钮
-    QHBoxLayout *buttonLayout1 = new QHBoxLayout();
-    buttonLayout1->addWidget(addButton);
-    buttonLayout1->addWidget(editButton);
-    buttonLayout1->addWidget(deleteButton);
-    buttonLayout1->addStretch();
-    buttonLayout1->addWidget(multiSelectButton);
-    buttonLayout1->addWidget(selectAllButton);
-    buttonLayout1->addStretch();
-    buttonLayout1->addWidget(showPasswordButton);
-
-    // 第二行按钮
-    QHBoxLayout *buttonLayout2 = new QHBoxLayout();
-    buttonLayout2->addStretch();
-    buttonLayout2->addWidget(exportButton);
-    buttonLayout2->addWidget(importButton);
-    buttonLayout2->addWidget(testButton);
-    buttonLayout2->addStretch();
-
-    // 添加到主布局
-    mainLayout->addLayout(buttonLayout1);
-    mainLayout->addLayout(buttonLayout2);
-
-    // 菜单栏
-    menuBar = new QMenuBar(this);
-    setMenuBar(menuBar);
-
-    QMenu *fileMenu = menuBar->addMenu("文件");
-    QAction *exportAction = fileMenu->addAction("导出密码");
-    QAction *importAction = fileMenu->addAction("导入密码");
-    fileMenu->addSeparator();
-    QAction *exitAction = fileMenu->addAction("退出");
-
-    connect(exportAction, &QAction::triggered, this, &MainWindow::exportPasswords);
-    connect(importAction, &QAction::triggered, this, &MainWindow::importPasswords);
-    connect(exitAction, &QAction::triggered, this, &QMainWindow::close);
-
-    QMenu *helpMenu = menuBar->addMenu("帮助");
-    QAction *aboutAction = helpMenu->addAction("关于");
-    connect(aboutAction, &QAction::triggered, this, &MainWindow::showAbout);
-
-    // 状态栏
-    statusBar = new QStatusBar();
-    setStatusBar(statusBar);
-    statusBar->showMessage("就绪");
-}
-
-void MainWindow::createProgressDialog()
-{
-    // 如果已经存在，先删除
-    if (progressDialog) {
-        delete progressDialog;
-        progressDialog = nullptr;
-    }
-
-    // 创建新的进度对话框
-    progressDialog = new QProgressDialog(this);
-    progressDialog->setWindowTitle("操作进度");
-    progressDialog->setLabelText("正在处理...");
-    progressDialog->setCancelButtonText("取消");
-    progressDialog->setRange(0, 100);
-    progressDialog->setValue(0);
-
-    // 修改为无模态，不阻塞主窗口
-    progressDialog->setModal(false);
-
-    // 设置为非置顶窗口
-    progressDialog->setWindowFlags(Qt::Dialog | Qt::CustomizeWindowHint | Qt::WindowTitleHint);
-
-    // 不自动关闭和重置，由我们手动控制
-    progressDialog->setAutoClose(false);
-    progressDialog->setAutoReset(false);
-
-    // 设置最小化时不显示进度对话框
-    progressDialog->setAttribute(Qt::WA_ShowWithoutActivating, false);
-
-    connect(progressDialog, &QProgressDialog::canceled, this, &MainWindow::cancelOperation);
-}
-
-void MainWindow::setupTable()
-{
-    model->setColumnCount(9);  // 修改：增加一列表单ID，现在是9列
-    model->setHeaderData(0, Qt::Horizontal, "ID");
-    model->setHeaderData(1, Qt::Horizontal, "网站/应用");
-    model->setHeaderData(2, Qt::Horizontal, "用户名");
-    model->setHeaderData(3, Qt::Horizontal, "账号");
-    model->setHeaderData(4, Qt::Horizontal, "密码");
-    model->setHeaderData(5, Qt::Horizontal, "备注");
-    model->setHeaderData(6, Qt::Horizontal, "加密账号密码");
-    model->setHeaderData(7, Qt::Horizontal, "表单ID");
-    model->setHeaderData(8, Qt::Horizontal, "选择");
-
-    tableView->setModel(model);
-    tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
-    tableView->horizontalHeader()->setStretchLastSection(true);
-    tableView->setAlternatingRowColors(true);
-
-    // 设置列宽
-    tableView->setColumnWidth(1, 150);
-    tableView->setColumnWidth(2, 120);
-    tableView->setColumnWidth(3, 120);
-    tableView->setColumnWidth(4, 100);
-    tableView->setColumnWidth(5, 200);
-    tableView->setColumnWidth(8, 60);
-
-    // 隐藏列
-    tableView->setColumnHidden(0, true);
-    tableView->setColumnHidden(6, true);
-    tableView->setColumnHidden(7, true);
-    tableView->setColumnHidden(8, !multiSelectMode);
-
-    // 连接信号
-    connect(tableView, &QTableView::clicked, this, &MainWindow::onTableViewClicked);
-    connect(tableView, &QTableView::doubleClicked, this, &MainWindow::onItemDoubleClicked);
-}
-
-void MainWindow::onTableViewClicked(const QModelIndex &index)
-{
-    // 获取当前选中模型
-    QItemSelectionModel *selectionModel = tableView->selectionModel();
-
-    if (!selectionModel) {
-        return;
-    }
-
-    // 获取当前点击的行
-    int clickedRow = index.row();
-
-    // 检查是否点击了表格的空白区域（无效行）
-    if (clickedRow < 0 || clickedRow >= model->rowCount()) {
-        // 点击了表格的空白区域，清除选中
-        if (multiSelectMode) {
-            // 在多选模式下，清除所有复选框的选中状态
-            clearAllCheckboxes();
-            statusBar->showMessage("已清除所有选择");
-        } else {
-            // 在普通模式下，清除行选择
-            selectionModel->clearSelection();
-            lastSelectedRow = -1;
-            statusBar->showMessage("已清除选择");
-        }
-        return;
-    }
-
-    // 如果点击的是有效的行
-    if (multiSelectMode) {
-        // 在多选模式下，不处理点击选中逻辑，由复选框控制
-        // 只是更新状态栏显示信息
-        QString website = model->item(clickedRow, 1)->text();
-        QString username = model->item(clickedRow, 2)->text();
-        statusBar->showMessage(QString("已选择行: %1 - %2").arg(website).arg(username));
-    } else {
-        // 在普通模式下
-        // 如果点击的是上次选中的同一行，取消选中
-        if (clickedRow == lastSelectedRow) {
-            selectionModel->clearSelection();
-            lastSelectedRow = -1;
-            statusBar->showMessage("已取消选择");
-        } else {
-            // 否则，选中新的一行
-            tableView->selectRow(clickedRow);
-            lastSelectedRow = clickedRow;
-
-            QString website = model->item(clickedRow, 1)->text();
-            QString username = model->item(clickedRow, 2)->text();
-            statusBar->showMessage(QString("已选择: %1 - %2").arg(website).arg(username));
-        }
-    }
-}
-
-void MainWindow::clearAllCheckboxes()
-{
-    // 清除所有复选框的选中状态
-    for (int i = 0; i < model->rowCount(); ++i) {
-        QStandardItem* checkItem = model->item(i, 8);  // 第8列是选择框
-        if (checkItem) {
-            checkItem->setCheckState(Qt::Unchecked);
-        }
-    }
-
-    // 更新全选状态和按钮文字
-    isAllSelected = false;
-    updateSelectAllButtonText();
-}
-
-void MainWindow::onItemDoubleClicked(const QModelIndex &index)
-{
-    if (multiSelectMode) {
-        // 多选模式下，不允许直接编辑单元格
-        QMessageBox::information(this, "提示", "多选模式下请使用编辑按钮进行编辑");
-        return;
-    }
-
-    int row = index.row();
-    int column = index.column();
-
-    // 检查是否点击了有效单元格
-    if (row < 0 || row >= model->rowCount()) {
-        return;
-    }
-
-    // 检查是否点击了可编辑的列（网站、用户名、账号、密码、备注）
-    if (column >= 1 && column <= 5) {
-        editField(row, column);
-    } else {
-        // 如果点击了ID列或加密密码列或表单ID列，提示不可编辑
-        if (column == 0 || column == 6 || column == 7) {
-            QMessageBox::information(this, "提示", "此列不可编辑");
-        }
-    }
-}
-
-bool MainWindow::editField(int row, int column)
-{
-    // 从第0列获取ID
-    QStandardItem* idItem = model->item(row, 0);
-    if (!idItem) {
-        statusBar->showMessage("获取记录ID失败");
-        return false;
-    }
-
-    int id = idItem->data(Qt::UserRole + 1).toInt();
-
-    // 获取表单ID
-    int form_id = model->item(row, 7)->text().toInt();
-
-    // 获取当前单元格的值
-    QString currentValue = model->item(row, column)->text();
-
-    // 根据列设置对话框标题和标签
-    QString title, label;
-    switch(column) {
-    case 1: // 网站
-        title = "编辑网站";
-        label = "网站/应用:";
-        break;
-    case 2: // 用户名
-        title = "编辑用户名";
-        label = "用户名:";
-        break;
-    case 3: // 账号
-        title = "编辑账号";
-        label = "账号(6-20位):";
-        break;
-    case 4: // 密码
-        title = "编辑密码";
-        label = "密码(6-20位):";
-        break;
-    case 5: // 备注
-        title = "编辑备注";
-        label = "备注:";
-        break;
-    default:
-        title = "编辑";
-        label = "值:";
-        break;
-    }
-
-    bool ok;
-    QString newValue;
-
-    // 对于账号和密码字段，需要循环验证直到输入正确或用户取消
-    if (column == 3 || column == 4) { // 账号或密码列
-        while (true) {
-            newValue = QInputDialog::getText(this, title, label,
-                                             QLineEdit::Normal, currentValue, &ok);
-
-            if (!ok) {
-                statusBar->showMessage("已取消编辑");
-                return false;
-            }
-
-            // 验证长度
-            if (newValue.length() >= 6 && newValue.length() <= 20) {
-                break; // 验证通过，退出循环
-            } else {
-                // 验证失败，显示错误提示，然后重新输入
-                QMessageBox::warning(this, "输入错误", "请输入正确格式(6-20位)!");
-                currentValue = newValue; // 使用上次输入的值作为新对话框的初始值
-            }
-        }
-    } else {
-        // 其他字段直接输入
-        newValue = QInputDialog::getText(this, title, label,
-                                         QLineEdit::Normal, currentValue, &ok);
-
-        if (!ok) {
-            statusBar->showMessage("已取消编辑");
-            return false;
-        }
-    }
-
-    // 如果值没有变化，直接返回
-    if (newValue == currentValue) {
-        statusBar->showMessage("值未变化");
-        return true;
-    }
-
-    // 获取该行的所有数据
-    QString website = model->item(row, 1)->text();
-    QString username = model->item(row, 2)->text();
-    QString account = model->item(row, 3)->text(); // 明文账号
-    QString password = model->item(row, 4)->text(); // 明文密码
-    QString notes = model->item(row, 5)->text();
-
-    // 根据编辑的列更新对应的值
-    switch(column) {
-    case 1: // 网站
-        website = newValue;
-        break;
-    case 2: // 用户名
-        username = newValue;
-        break;
-    case 3: // 账号
-        account = newValue;
-        break;
-    case 4: // 密码
-        password = newValue;
-        break;
-    case 5: // 备注
-        notes = newValue;
-        break;
-    }
-
-    // 加密账号和密码
-    QString encryptedAccount = Encryption::encrypt(account);
-    QString encryptedPassword = Encryption::encrypt(password);
-
-    // 更新数据库，传入表单ID
-    if (Database::instance().updatePassword(id, form_id, website, username, encryptedAccount, encryptedPassword, notes)) {
-        // 更新模型中的数据
-        model->item(row, column)->setText(newValue);
-
-        // 如果是账号或密码列，还需要更新加密列
-        if (column == 3 || column == 4) {
-            QString encryptedData = encryptedAccount + "|" + encryptedPassword;
-            model->item(row, 6)->setText(encryptedData);
-        }
-
-        statusBar->showMessage("编辑成功");
-        return true;
-    } else {
-        statusBar->showMessage("编辑失败，可能是新的网站、用户名和账号组合已存在");
-        return false;
-    }
-}
-
-void MainWindow::clearSelection()
-{
-    QItemSelectionModel *selectionModel = tableView->selectionModel();
-    if (selectionModel) {
-        selectionModel->clearSelection();
-    }
-    lastSelectedRow = -1;
-
-    // 在多选模式下，还需要清除所有复选框的选择
-    if (multiSelectMode) {
-        clearAllCheckboxes();
-    }
-}
-
-void MainWindow::loadForms()
-{
-    qDebug() << "开始加载表单";
-
-    auto forms = Database::instance().getAllForms();
-    qDebug() << "获取到表单数量:" << forms.size();
-
-    formTabWidget->clear();  // 清空标签栏
-
-    if (forms.isEmpty()) {
-        // 如果没有表单，创建一个默认表单
-        qDebug() << "没有表单，创建默认表单";
-        if (Database::instance().addForm("默认表单")) {
-            forms = Database::instance().getAllForms();
-            qDebug() << "重新获取表单数量:" << forms.size();
-        } else {
-            qDebug() << "创建默认表单失败";
-        }
-    }
-
-    for (const auto &form : forms) {
-        qDebug() << "添加表单:" << form.id << form.name;
-        formTabWidget->addForm(form.id, form.name, currentFormId == -1 || form.id == currentFormId);
-        if (currentFormId == -1) {
-            currentFormId = form.id;
-            qDebug() << "设置当前表单ID为:" << currentFormId;
-        }
-    }
-
-    // 默认在所有表单中搜索
-    selectedFormIdsForSearch = formTabWidget->allFormIds();
-
-    // 如果当前表单ID仍然为-1，设置为第一个表单的ID
-    if (currentFormId == -1 && !forms.isEmpty()) {
-        currentFormId = forms.first().id;
-        qDebug() << "重新设置当前表单ID为第一个表单:" << currentFormId;
-    }
-
-    qDebug() << "表单加载完成，当前表单ID:" << currentFormId;
-}
-
-void MainWindow::loadPasswords()
-{
-    qDebug() << "开始加载密码，当前表单ID:" << currentFormId;
-
-    // 断开之前的连接，避免重复连接
-    disconnect(model, &QStandardItemModel::itemChanged, this, &MainWindow::onCheckboxStateChanged);
-
-    model->removeRows(0, model->rowCount());
-
-    // 检查数据库连接
-    if (!Database::instance().init()) {
-        qDebug() << "数据库初始化失败";
-        statusBar->showMessage("数据库初始化失败");
-        return;
-    }
-
-    // 如果当前表单ID为-1，尝试获取第一个表单
-    if (currentFormId == -1) {
-        auto forms = Database::instance().getAllForms();
-        if (!forms.isEmpty()) {
-            currentFormId = forms.first().id;
-            qDebug() << "设置当前表单ID为第一个表单:" << currentFormId;
-
-            // 更新标签栏当前选中项
-            formTabWidget->setCurrentForm(currentFormId);
-        } else {
-            qDebug() << "没有可用的表单";
-            statusBar->showMessage("没有可用的表单");
-            return;
-        }
-    }
-
-    auto passwords = Database::instance().getAllPasswords(currentFormId);
-    qDebug() << "获取到密码记录数量:" << passwords.size();
-
-    for (const auto &pwd : passwords) {
-        QList<QStandardItem*> row;
-
-        // 第0列：隐藏的ID
-        QStandardItem* idItem = new QStandardItem();
-        idItem->setData(pwd.id, Qt::UserRole + 1);
-        row << idItem;
-
-        // 第1列：网站
-        QStandardItem* websiteItem = new QStandardItem(pwd.website);
-        websiteItem->setEditable(false);
-        row << websiteItem;
-
-        // 第2列：用户名
-        QStandardItem* usernameItem = new QStandardItem(pwd.username);
-        usernameItem->setEditable(false);
-        row << usernameItem;
-
-        // 第3列：账号（解密后）
-        QString decryptedAccount = Encryption::decrypt(pwd.account);
-        QStandardItem* accountItem = new QStandardItem(decryptedAccount);
-        accountItem->setEditable(false);
-        row << accountItem;
-
-        // 第4列：密码（解密后）
-        QString decryptedPassword = Encryption::decrypt(pwd.password);
-        QStandardItem* passwordItem = new QStandardItem(decryptedPassword);
-        passwordItem->setEditable(false);
-        row << passwordItem;
-
-        // 第5列：备注
-        QStandardItem* notesItem = new QStandardItem(pwd.notes);
-        notesItem->setEditable(false);
-        row << notesItem;
-
-        // 第6列：加密账号和密码
-        QStandardItem* encryptedItem = new QStandardItem(pwd.account + "|" + pwd.password);
-        encryptedItem->setEditable(false);
-        row << encryptedItem;
-
-        // 第7列：表单ID
-        QStandardItem* formIdItem = new QStandardItem(QString::number(pwd.form_id));
-        formIdItem->setEditable(false);
-        row << formIdItem;
-
-        // 第8列：选择框
-        QStandardItem* checkItem = new QStandardItem();
-        checkItem->setCheckable(true);
-        checkItem->setEditable(false);
-        checkItem->setCheckState(Qt::Unchecked);
-        row << checkItem;
-
-        model->appendRow(row);
-    }
-
-    statusBar->showMessage(QString("表单 '%1' 加载了 %2 条记录").arg(formTabWidget->currentFormName()).arg(passwords.size()));
-
-    // 重置全选状态
-    isAllSelected = false;
-    updateSelectAllButtonText();
-
-    // 清除选中状态
-    clearSelection();
-
-    // 连接复选框状态改变信号
-    connect(model, &QStandardItemModel::itemChanged, this, &MainWindow::onCheckboxStateChanged);
-
-    qDebug() << "密码加载完成";
-}
-
-void MainWindow::updateButtonStates()
-{
-    // 更新按钮状态
-    if (multiSelectMode) {
-        selectAllButton->setEnabled(true);
-        deleteButton->setText("批量删除");
-        exportButton->setText("批量导出");
-        tableView->setSelectionMode(QAbstractItemView::MultiSelection);
-    } else {
-        selectAllButton->setEnabled(false);
-        deleteButton->setText("删除");
-        exportButton->setText("导出");
-        tableView->setSelectionMode(QAbstractItemView::SingleSelection);
-    }
-}
-
-void MainWindow::toggleMultiSelectMode()
-{
-    multiSelectMode = !multiSelectMode;
-
-    if (multiSelectMode) {
-        multiSelectButton->setText("取消多选");
-        tableView->setColumnHidden(8, false);  // 显示选择框列
-    } else {
-        multiSelectButton->setText("多选");
-        tableView->setColumnHidden(8, true);   // 隐藏选择框列
-
-        // 清除所有复选框的选择状态
-        clearAllCheckboxes();
-    }
-
-    // 清除当前选中状态
-    clearSelection();
-
-    updateButtonStates();
-}
-
-void MainWindow::updateSelectAllButtonText()
-{
-    if (isAllSelected) {
-        selectAllButton->setText("取消全选");
-    } else {
-        selectAllButton->setText("全选");
-    }
-}
-
-void MainWindow::selectAll()
-{
-    if (!multiSelectMode) {
-        return;
-    }
-
-    // 切换全选状态
-    isAllSelected = !isAllSelected;
-
-    // 根据全选状态设置所有复选框
-    Qt::CheckState newState = isAllSelected ? Qt::Checked : Qt::Unchecked;
-
-    for (int i = 0; i < model->rowCount(); ++i) {
-        QStandardItem* checkItem = model->item(i, 8);  // 第8列是选择框
-        if (checkItem) {
-            checkItem->setCheckState(newState);
-        }
-    }
-
-    // 更新按钮文字
-    updateSelectAllButtonText();
-
-    // 更新状态栏
-    if (isAllSelected) {
-        statusBar->showMessage(QString("已全选 %1 条记录").arg(model->rowCount()));
-    } else {
-        statusBar->showMessage("已取消全选");
-    }
-}
-
-void MainWindow::onCheckboxStateChanged()
-{
-    if (!multiSelectMode) {
-        return;
-    }
-
-    // 计算当前选中数量
-    int selectedCount = 0;
-    for (int i = 0; i < model->rowCount(); ++i) {
-        QStandardItem* checkItem = model->item(i, 8);  // 第8列是选择框
-        if (checkItem && checkItem->checkState() == Qt::Checked) {
-            selectedCount++;
-        }
-    }
-
-    // 更新全选状态
-    isAllSelected = (selectedCount == model->rowCount() && model->rowCount() > 0);
-    updateSelectAllButtonText();
-
-    if (selectedCount > 0) {
-        statusBar->showMessage(QString("已选中 %1 条记录").arg(selectedCount));
-    } else {
-        statusBar->showMessage("就绪");
-    }
-}
-
-void MainWindow::addPassword()
-{
-    qDebug() << "开始添加密码，当前表单ID:" << currentFormId;
-
-    // 清除当前选中状态
-    clearSelection();
-
-    if (currentFormId == -1) {
-        qDebug() << "当前表单ID为-1，尝试创建默认表单";
-        QMessageBox::warning(this, "警告", "没有可用表单，正在创建默认表单...");
-
-        // 尝试创建默认表单
-        if (Database::instance().addForm("默认表单")) {
-            loadForms(); // 重新加载表单
-            if (currentFormId == -1) {
-                QMessageBox::critical(this, "错误", "创建默认表单失败，无法添加密码");
-                return;
-            }
-        } else {
-            QMessageBox::critical(this, "错误", "无法创建表单，请检查数据库连接");
-            return;
-        }
-    }
-
-    // 简单对话框添加
-    bool ok;
-    QString website = QInputDialog::getText(this, "添加密码", "网站/应用:", QLineEdit::Normal, "", &ok);
-    if (!ok || website.isEmpty()) {
-        statusBar->showMessage("已取消添加");
-        return;
-    }
-
-    QString username = QInputDialog::getText(this, "添加密码", "用户名:", QLineEdit::Normal, "", &ok);
-    if (!ok) {
-        statusBar->showMessage("已取消添加");
-        return;
-    }
-
-    // 账号输入 - 循环验证
-    QString account;
-    QString accountTemp = "";
-    while (true) {
-        account = QInputDialog::getText(this, "添加密码", "账号(6-20位):", QLineEdit::Normal, accountTemp, &ok);
-        if (!ok) {
-            statusBar->showMessage("已取消添加");
-            return;
-        }
-
-        // 验证账号格式
-        if (account.length() >= 6 && account.length() <= 20) {
-            break; // 验证通过，退出循环
-        } else {
-            // 验证失败，显示错误提示，然后重新输入
-            QMessageBox::warning(this, "输入错误", "请输入正确格式的账号(6-20位)!");
-            accountTemp = account; // 使用上次输入的值作为新对话框的初始值
-        }
-    }
-
-    // 密码输入 - 循环验证
-    QString password;
-    QString passwordTemp = "";
-    while (true) {
-        password = QInputDialog::getText(this, "添加密码", "密码(6-20位):", QLineEdit::Normal, passwordTemp, &ok);
-        if (!ok) {
-            statusBar->showMessage("已取消添加");
-            return;
-        }
-
-        // 验证密码格式
-        if (password.length() >= 6 && password.length() <= 20) {
-            break; // 验证通过，退出循环
-        } else {
-            // 验证失败，显示错误提示，然后重新输入
-            QMessageBox::warning(this, "输入错误", "请输入正确格式的密码(6-20位)!");
-            passwordTemp = password; // 使用上次输入的值作为新对话框的初始值
-        }
-    }
-
-    QString notes = QInputDialog::getText(this, "添加密码", "备注:", QLineEdit::Normal, "", &ok);
-
-    // 加密账号和密码
-    QString encryptedAccount = Encryption::encrypt(account);
-    QString encryptedPassword = Encryption::encrypt(password);
-
-    qDebug() << "准备添加密码到数据库，表单ID:" << currentFormId;
-    qDebug() << "网站:" << website << "用户名:" << username << "账号:" << account;
-
-    if (Database::instance().addPassword(currentFormId, website, username, encryptedAccount, encryptedPassword, notes)) {
-        loadPasswords();
-        statusBar->showMessage("密码添加成功");
-        QMessageBox::information(this, "成功", "密码添加成功!");
-    } else {
-        statusBar->showMessage("密码添加失败，可能已存在相同记录");
-        QMessageBox::warning(this, "失败", "密码添加失败，可能已存在相同记录!");
-    }
-}
-
-void MainWindow::editSelectedRow(int row)
-{
-    // 从第0列获取ID
-    QStandardItem* idItem = model->item(row, 0);
-    if (!idItem) {
-        statusBar->showMessage("获取记录ID失败");
-        return;
-    }
-
-    int id = idItem->data(Qt::UserRole + 1).toInt();
-
-    // 获取表单ID
-    int form_id = model->item(row, 7)->text().toInt();
-
-    bool ok;
-    QString website = QInputDialog::getText(this, "编辑密码", "网站/应用:",
-                                            QLineEdit::Normal, model->item(row, 1)->text(), &ok);
-    if (!ok) {
-        statusBar->showMessage("已取消编辑");
-        return;
-    }
-
-    QString username = QInputDialog::getText(this, "编辑密码", "用户名:",
-                                             QLineEdit::Normal, model->item(row, 2)->text(), &ok);
-    if (!ok) {
-        statusBar->showMessage("已取消编辑");
-        return;
-    }
-
-    // 账号输入 - 循环验证
-    QString account;
-    QString accountTemp = model->item(row, 3)->text();
-    while (true) {
-        account = QInputDialog::getText(this, "编辑密码", "账号(6-20位):",
-                                        QLineEdit::Normal, accountTemp, &ok);
-        if (!ok) {
-            statusBar->showMessage("已取消编辑");
-            return;
-        }
-
-        // 验证账号格式
-        if (account.length() >= 6 && account.length() <= 20) {
-            break; // 验证通过，退出循环
-        } else {
-            // 验证失败，显示错误提示，然后重新输入
-            QMessageBox::warning(this, "输入错误", "请输入正确格式的账号(6-20位)!");
-            accountTemp = account; // 使用上次输入的值作为新对话框的初始值
-        }
-    }
-
-    // 密码输入 - 循环验证
-    QString password;
-    QString passwordTemp = model->item(row, 4)->text();
-    while (true) {
-        password = QInputDialog::getText(this, "编辑密码", "密码(6-20位):",
-                                         QLineEdit::Normal, passwordTemp, &ok);
-        if (!ok) {
-            statusBar->showMessage("已取消编辑");
-            return;
-        }
-
-        // 验证密码格式
-        if (password.length() >= 6 && password.length() <= 20) {
-            break; // 验证通过，退出循环
-        } else {
-            // 验证失败，显示错误提示，然后重新输入
-            QMessageBox::warning(this, "输入错误", "请输入正确格式的密码(6-20位)!");
-            passwordTemp = password; // 使用上次输入的值作为新对话框的初始值
-        }
-    }
-
-    QString notes = QInputDialog::getText(this, "编辑密码", "备注:",
-                                          QLineEdit::Normal, model->item(row, 5)->text(), &ok);
-
-    QString newEncryptedAccount = Encryption::encrypt(account);
-    QString newEncryptedPassword = Encryption::encrypt(password);
-
-    qDebug() << "准备更新密码，ID:" << id << "表单ID:" << form_id;
-
-    if (Database::instance().updatePassword(id, form_id, website, username, newEncryptedAccount, newEncryptedPassword, notes)) {
-        loadPasswords();
-        statusBar->showMessage("密码更新成功");
-    } else {
-        statusBar->showMessage("密码更新失败，可能是新的网站、用户名和账号组合已存在");
-    }
-}
-
-void MainWindow::editPassword()
-{
-    // 根据当前模式判断如何获取选中的行
-    if (multiSelectMode) {
-        // 在多选模式下，检查是否有选中的行
-        QList<int> selectedRows;
-        for (int i = 0; i < model->rowCount(); ++i) {
-            QStandardItem* checkItem = model->item(i, 8);  // 第8列是选择框
-            if (checkItem && checkItem->checkState() == Qt::Checked) {
-                selectedRows.append(i);
-            }
-        }
-
-        if (selectedRows.isEmpty()) {
-            QMessageBox::warning(this, "警告", "请先选择一条记录");
-            return;
-        }
-
-        if (selectedRows.size() > 1) {
-            QMessageBox::warning(this, "警告", "编辑操作只能选择一条记录");
-            return;
-        }
-
-        // 编辑选中的单条记录
-        int row = selectedRows.first();
-        editSelectedRow(row);
-    } else {
-        // 在普通模式下，使用当前选中的行
-        QItemSelectionModel *selectionModel = tableView->selectionModel();
-        if (!selectionModel || !selectionModel->hasSelection()) {
-            QMessageBox::warning(this, "警告", "请先选择一条记录");
-            return;
-        }
-
-        QModelIndexList selectedIndexes = selectionModel->selectedRows();
-        if (selectedIndexes.isEmpty()) {
-            QMessageBox::warning(this, "警告", "请先选择一条记录");
-            return;
-        }
-
-        int row = selectedIndexes.first().row();
-        editSelectedRow(row);
-    }
-}
-
-void MainWindow::deletePassword()
-{
-    if (multiSelectMode) {
-        // 批量删除模式
-        QList<int> rowsToDelete;
-        QList<int> idsToDelete;
-        QList<int> formIdsToDelete;
-
-        // 收集要删除的行和ID
-        for (int i = 0; i < model->rowCount(); ++i) {
-            QStandardItem* checkItem = model->item(i, 8);  // 第8列是选择框
-            if (checkItem && checkItem->checkState() == Qt::Checked) {
-                rowsToDelete.append(i);
-                int id = model->item(i, 0)->data(Qt::UserRole + 1).toInt();  // 获取ID
-                idsToDelete.append(id);
-                int form_id = model->item(i, 7)->text().toInt();  // 获取表单ID
-                formIdsToDelete.append(form_id);
-            }
-        }
-
-        if (rowsToDelete.isEmpty()) {
-            QMessageBox::warning(this, "警告", "请先选择要删除的记录");
-            return;
-        }
-
-        QMessageBox::StandardButton reply;
-        reply = QMessageBox::question(this, "确认批量删除",
-                                      QString("确定要删除选中的 %1 条记录吗?").arg(rowsToDelete.size()),
-                                      QMessageBox::Yes | QMessageBox::No);
-
-        if (reply == QMessageBox::Yes) {
-            bool allDeleted = true;
-            for (int i = rowsToDelete.size() - 1; i >= 0; --i) {
-                int row = rowsToDelete[i];
-                int id = idsToDelete[i];
-
-                if (!Database::instance().deletePassword(id)) {
-                    allDeleted = false;
-                } else {
-                    model->removeRow(row);
-                }
-            }
-
-            if (allDeleted) {
-                statusBar->showMessage(QString("成功删除 %1 条记录").arg(rowsToDelete.size()));
-            } else {
-                statusBar->showMessage("部分记录删除失败");
-            }
-
-            // 重置全选状态
-            isAllSelected = false;
-            updateSelectAllButtonText();
-
-            // 清除选中状态
-            clearSelection();
-        } else {
-            statusBar->showMessage("已取消删除");
-        }
-    } else {
-        // 单个删除模式
-        QItemSelectionModel *selectionModel = tableView->selectionModel();
-        if (!selectionModel || !selectionModel->hasSelection()) {
-            QMessageBox::warning(this, "警告", "请先选择一条记录");
-            return;
-        }
-
-        QModelIndexList selectedIndexes = selectionModel->selectedRows();
-        if (selectedIndexes.isEmpty()) {
-            QMessageBox::warning(this, "警告", "请先选择一条记录");
-            return;
-        }
-
-        int row = selectedIndexes.first().row();
-
-        // 从第0列获取ID
-        QStandardItem* idItem = model->item(row, 0);
-        if (!idItem) {
-            statusBar->showMessage("获取记录ID失败");
-            return;
-        }
-
-        int id = idItem->data(Qt::UserRole + 1).toInt();
-        QString website = model->item(row, 1)->text();
-        QString username = model->item(row, 2)->text();
-
-        QMessageBox::StandardButton reply;
-        reply = QMessageBox::question(this, "确认删除",
-                                      QString("确定要删除 '%1' 用户 '%2' 的密码记录吗?").arg(website).arg(username),
-                                      QMessageBox::Yes | QMessageBox::No);
-
-        if (reply == QMessageBox::Yes) {
-            if (Database::instance().deletePassword(id)) {
-                loadPasswords();  // 重新加载数据
-                statusBar->showMessage("密码删除成功");
-            } else {
-                statusBar->showMessage("密码删除失败");
-            }
-        } else {
-            statusBar->showMessage("已取消删除");
-        }
-    }
-}
-
-void MainWindow::searchPasswords()
-{
-    QString keyword = searchEdit->text().trimmed();
-    qDebug() << "开始搜索，关键词:" << keyword << "选择的表单数量:" << selectedFormIdsForSearch.size();
-
-    // 使用选中的表单ID列表进行搜索
-    auto results = Database::instance().searchPasswords(keyword, selectedFormIdsForSearch);
-    qDebug() << "搜索到记录数量:" << results.size();
-
-    // 断开之前的连接，避免重复连接
-    disconnect(model, &QStandardItemModel::itemChanged, this, &MainWindow::onCheckboxStateChanged);
-
-    model->removeRows(0, model->rowCount());
-
-    for (const auto &pwd : results) {
-        QList<QStandardItem*> row;
-
-        // 第0列：隐藏的ID
-        QStandardItem* idItem = new QStandardItem();
-        idItem->setData(pwd.id, Qt::UserRole + 1);
-        row << idItem;
-
-        // 第1列：网站
-        QStandardItem* websiteItem = new QStandardItem(pwd.website);
-        websiteItem->setEditable(false);
-        row << websiteItem;
-
-        // 第2列：用户名
-        QStandardItem* usernameItem = new QStandardItem(pwd.username);
-        usernameItem->setEditable(false);
-        row << usernameItem;
-
-        // 第3列：账号（解密后）
-        QStandardItem* accountItem = new QStandardItem(Encryption::decrypt(pwd.account));
-        accountItem->setEditable(false);
-        row << accountItem;
-
-        // 第4列：密码（解密后）
-        QStandardItem* passwordItem = new QStandardItem(Encryption::decrypt(pwd.password));
-        passwordItem->setEditable(false);
-        row << passwordItem;
-
-        // 第5列：备注
-        QStandardItem* notesItem = new QStandardItem(pwd.notes);
-        notesItem->setEditable(false);
-        row << notesItem;
-
-        // 第6列：加密账号和密码
-        QStandardItem* encryptedItem = new QStandardItem(pwd.account + "|" + pwd.password);
-        encryptedItem->setEditable(false);
-        row << encryptedItem;
-
-        // 第7列：表单ID
-        QStandardItem* formIdItem = new QStandardItem(QString::number(pwd.form_id));
-        formIdItem->setEditable(false);
-        row << formIdItem;
-
-        // 第8列：选择框
-        QStandardItem* checkItem = new QStandardItem();
-        checkItem->setCheckable(true);
-        checkItem->setEditable(false);
-        checkItem->setCheckState(Qt::Unchecked);
-        row << checkItem;
-
-        model->appendRow(row);
-    }
-
-    // 重置全选状态
-    isAllSelected = false;
-    updateSelectAllButtonText();
-
-    // 重新连接复选框状态改变信号
-    connect(model, &QStandardItemModel::itemChanged, this, &MainWindow::onCheckboxStateChanged);
-
-    // 清除选中状态
-    clearSelection();
-
-    statusBar->showMessage(QString("在 %1 个表单中找到 %2 条匹配记录").arg(selectedFormIdsForSearch.size()).arg(results.size()));
-}
-
-bool MainWindow::exportSelectedPasswords(const QString &filename)
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "无法打开文件:" << filename;
-        return false;
-    }
-
-    QTextStream out(&file);
-
-    // 写入UTF-8 BOM以确保正确识别编码（Windows系统需要）
-    out << "\xEF\xBB\xBF";
-
-    // 写入表头
-    out << "Website,Username,Account,Password,Notes\n";
-
-    int exportedCount = 0;
-
-    // 按顺序导出选中的行
-    for (int i = 0; i < model->rowCount(); ++i) {
-        QStandardItem* checkItem = model->item(i, 8);  // 第8列是选择框
-        if (checkItem && checkItem->checkState() == Qt::Checked) {
-            QString website = model->item(i, 1)->text();
-            QString username = model->item(i, 2)->text();
-            QString account = model->item(i, 3)->text();  // 账号
-            QString password = model->item(i, 4)->text();  // 明文密码
-            QString notes = model->item(i, 5)->text();
-
-            // CSV转义函数
-            auto escapeCSV = [](const QString &field) -> QString {
-                QString escaped = field;
-                bool needsQuotes = escaped.contains(',') ||
-                                   escaped.contains('"') ||
-                                   escaped.contains('\n') ||
-                                   escaped.contains('\r');
-                escaped.replace("\"", "\"\"");
-                if (needsQuotes || escaped.startsWith(' ') || escaped.endsWith(' ')) {
-                    escaped = "\"" + escaped + "\"";
-                }
-                return escaped;
-            };
-
-            out << escapeCSV(website) << ","
-                << escapeCSV(username) << ","
-                << escapeCSV(account) << ","
-                << escapeCSV(password) << ","
-                << escapeCSV(notes) << "\n";
-
-            exportedCount++;
-        }
-    }
-
-    file.close();
-    qDebug() << "导出成功，共导出" << exportedCount << "条记录";
-
-    if (exportedCount == 0) {
-        statusBar->showMessage("没有选中任何记录");
-        return false;
-    }
-
-    return true;
-}
-
-void MainWindow::exportPasswords()
-{
-    if (operationInProgress) {
-        QMessageBox::warning(this, "警告", "当前有操作正在进行，请等待完成");
-        return;
-    }
-
-    // 第一步：弹出对话框让用户选择导出类型
-    QDialog exportTypeDialog(this);
-    exportTypeDialog.setWindowTitle("选择导出类型");
-    exportTypeDialog.resize(300, 150);
-
-    QVBoxLayout *dialogLayout = new QVBoxLayout(&exportTypeDialog);
-
-    QGroupBox *groupBox = new QGroupBox("请选择导出版本:");
-    QVBoxLayout *groupLayout = new QVBoxLayout(groupBox);
-
-    QRadioButton *unencryptedButton = new QRadioButton("未保密版（密码以明文显示）");
-    QRadioButton *encryptedButton = new QRadioButton("保密版（密码以加密形式显示）");
-
-    // 默认选中未保密版
-    unencryptedButton->setChecked(true);
-
-    groupLayout->addWidget(unencryptedButton);
-    groupLayout->addWidget(encryptedButton);
-    groupBox->setLayout(groupLayout);
-
-    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
-
-    dialogLayout->addWidget(groupBox);
-    dialogLayout->addWidget(buttonBox);
-    exportTypeDialog.setLayout(dialogLayout);
-
-    connect(buttonBox, &QDialogButtonBox::accepted, &exportTypeDialog, &QDialog::accept);
-    connect(buttonBox, &QDialogButtonBox::rejected, &exportTypeDialog, &QDialog::reject);
-
-    if (exportTypeDialog.exec() != QDialog::Accepted) {
-        statusBar->showMessage("已取消导出");
-        return;
-    }
-
-    // 确定用户选择的导出类型
-    bool exportEncrypted = encryptedButton->isChecked();
-
-    // 第二步：选择保存文件位置
-    QString fileName = QFileDialog::getSaveFileName(this, "导出密码",
-                                                    "passwords_backup.csv",
-                                                    "CSV文件 (*.csv)");
-    if (fileName.isEmpty()) {
-        statusBar->showMessage("已取消导出");
-        return;
-    }
-
-    if (multiSelectMode) {
-        // 获取选中的行
-        QList<int> selectedRows;
-        for (int i = 0; i < model->rowCount(); ++i) {
-            QStandardItem* checkItem = model->item(i, 8);  // 第8列是选择框
-            if (checkItem && checkItem->checkState() == Qt::Checked) {
-                selectedRows.append(i);
-            }
-        }
-
-        if (selectedRows.isEmpty()) {
-            QMessageBox::warning(this, "警告", "没有选中任何记录，将导出当前表单全部记录");
-            startExportOperation(fileName, exportEncrypted);
-        } else {
-            startExportSelectedOperation(fileName, selectedRows, exportEncrypted);
-        }
-    } else {
-        startExportOperation(fileName, exportEncrypted);
-    }
-}
-
-void MainWindow::importPasswords()
-{
-    if (operationInProgress) {
-        QMessageBox::warning(this, "警告", "当前有操作正在进行，请等待完成");
-        return;
-    }
-
-    QString fileName = QFileDialog::getOpenFileName(this, "导入密码",
-                                                    "", "CSV文件 (*.csv)");
-    if (fileName.isEmpty()) {
-        statusBar->showMessage("已取消导入");
-        return;
-    }
-
-    QMessageBox::StandardButton reply;
-    reply = QMessageBox::question(this, "确认导入",
-                                  "导入将添加新记录，重复记录不会覆盖。确定要继续吗?",
-                                  QMessageBox::Yes | QMessageBox::No);
-
-    if (reply == QMessageBox::Yes) {
-        startImportOperation(fileName);
-    } else {
-        statusBar->showMessage("已取消导入");
-    }
-}
-
-void MainWindow::startImportOperation(const QString &filename)
-{
-    qDebug() << "开始导入操作，文件:" << filename << "当前表单ID:" << currentFormId;
-
-    operationInProgress = true;
-
-    // 禁用相关按钮
-    importButton->setEnabled(false);
-    exportButton->setEnabled(false);
-
-    // 创建进度对话框（如果需要）
-    if (!progressDialog) {
-        createProgressDialog();
-    }
-
-    // 创建线程和工作器
-    workerThread = new QThread(this);
-    worker = new ImportExportWorker();
-    worker->setOperationType(ImportExportWorker::ImportOperation);
-    worker->setFilename(filename);
-    worker->setFormId(currentFormId);  // 导入到当前表单
-    worker->moveToThread(workerThread);
-
-    // 连接信号
-    connect(workerThread, &QThread::started, worker, &ImportExportWorker::startOperation);
-    connect(worker, &ImportExportWorker::progressChanged, this, &MainWindow::onImportProgress);
-    connect(worker, &ImportExportWorker::operationFinished, this, &MainWindow::onOperationFinished);
-    connect(worker, &ImportExportWorker::errorOccurred, this, &MainWindow::onOperationError);
-    connect(workerThread, &QThread::finished, worker, &ImportExportWorker::deleteLater);
-    connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
-
-    // 启动线程
-    workerThread->start();
-
-    // 显示进度对话框
-    progressDialog->setWindowTitle("导入数据");
-    progressDialog->setLabelText("正在导入数据，请稍候...");
-    progressDialog->show();
-}
-
-void MainWindow::startExportOperation(const QString &filename, bool exportEncrypted)
-{
-    qDebug() << "开始导出操作，文件:" << filename << "导出类型:" << exportEncrypted << "当前表单ID:" << currentFormId;
-
-    operationInProgress = true;
-
-    // 禁用相关按钮
-    importButton->setEnabled(false);
-    exportButton->setEnabled(false);
-
-    // 创建进度对话框（如果需要）
-    if (!progressDialog) {
-        createProgressDialog();
-    }
-
-    // 创建线程和工作器
-    workerThread = new QThread(this);
-    worker = new ImportExportWorker();
-    worker->setOperationType(ImportExportWorker::ExportOperation);
-    worker->setFilename(filename);
-    worker->setExportEncrypted(exportEncrypted);  // 设置导出类型
-    worker->setFormId(currentFormId);  // 导出当前表单
-    worker->moveToThread(workerThread);
-
-    // 连接信号
-    connect(workerThread, &QThread::started, worker, &ImportExportWorker::startOperation);
-    connect(worker, &ImportExportWorker::progressChanged, this, &MainWindow::onExportProgress);
-    connect(worker, &ImportExportWorker::operationFinished, this, &MainWindow::onOperationFinished);
-    connect(worker, &ImportExportWorker::errorOccurred, this, &MainWindow::onOperationError);
-    connect(workerThread, &QThread::finished, worker, &ImportExportWorker::deleteLater);
-    connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
-
-    // 启动线程
-    workerThread->start();
-
-    // 显示进度对话框
-    QString exportType = exportEncrypted ? "保密版" : "未保密版";
-    progressDialog->setWindowTitle(QString("导出数据 (%1)").arg(exportType));
-    progressDialog->setLabelText(QString("正在导出数据(%1)，请稍候...").arg(exportType));
-    progressDialog->show();
-}
-
-void MainWindow::startExportSelectedOperation(const QString &filename, const QList<int> &selectedRows, bool exportEncrypted)
-{
-    qDebug() << "开始导出选中记录操作，文件:" << filename << "导出类型:" << exportEncrypted
-             << "选中行数:" << selectedRows.size() << "当前表单ID:" << currentFormId;
-
-    operationInProgress = true;
-
-    // 禁用相关按钮
-    importButton->setEnabled(false);
-    exportButton->setEnabled(false);
-
-    // 创建进度对话框（如果需要）
-    if (!progressDialog) {
-        createProgressDialog();
-    }
-
-    // 创建线程和工作器
-    workerThread = new QThread(this);
-    worker = new ImportExportWorker();
-    worker->setOperationType(ImportExportWorker::ExportSelectedOperation);
-    worker->setFilename(filename);
-    worker->setSelectedRows(selectedRows);
-    worker->setExportEncrypted(exportEncrypted);  // 设置导出类型
-    worker->setFormId(currentFormId);  // 导出当前表单
-    worker->moveToThread(workerThread);
-
-    // 连接信号
-    connect(workerThread, &QThread::started, worker, &ImportExportWorker::startOperation);
-    connect(worker, &ImportExportWorker::progressChanged, this, &MainWindow::onExportProgress);
-    connect(worker, &ImportExportWorker::operationFinished, this, &MainWindow::onOperationFinished);
-    connect(worker, &ImportExportWorker::errorOccurred, this, &MainWindow::onOperationError);
-    connect(workerThread, &QThread::finished, worker, &ImportExportWorker::deleteLater);
-    connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
-
-    // 启动线程
-    workerThread->start();
-
-    // 显示进度对话框
-    QString exportType = exportEncrypted ? "保密版" : "未保密版";
-    progressDialog->setWindowTitle(QString("导出选中的数据 (%1)").arg(exportType));
-    progressDialog->setLabelText(QString("正在导出选中的数据(%1)，请稍候...").arg(exportType));
-    progressDialog->show();
-}
-
-void MainWindow::onImportProgress(int percent, const QString &message)
-{
-    if (progressDialog) {
-        progressDialog->setValue(percent);
-        progressDialog->setLabelText(message);
-    }
-    statusBar->showMessage(message);
-}
-
-void MainWindow::onExportProgress(int percent, const QString &message)
-{
-    if (progressDialog) {
-        progressDialog->setValue(percent);
-        progressDialog->setLabelText(message);
-    }
-    statusBar->showMessage(message);
-}
-
-void MainWindow::onOperationFinished(bool success, const QString &message)
-{
-    qDebug() << "操作完成，成功:" << success << "消息:" << message;
-
-    operationInProgress = false;
-
-    // 启用按钮
-    importButton->setEnabled(true);
-    exportButton->setEnabled(true);
-
-    // 关闭进度对话框
-    if (progressDialog) {
-        progressDialog->reset();
-        progressDialog->hide();
-    }
-
-    if (success) {
-        // 重新加载数据
-        loadPasswords();
-
-        QMessageBox::information(this, "成功", message);
-        statusBar->showMessage(message);
-    } else {
-        QMessageBox::warning(this, "失败", message);
-        statusBar->showMessage("操作失败");
-    }
-
-    // 清理线程
-    if (workerThread) {
-        workerThread->quit();
-        workerThread->wait();
-        delete workerThread;
-        workerThread = nullptr;
-        worker = nullptr;
-    }
-}
-
-void MainWindow::onOperationError(const QString &error)
-{
-    qDebug() << "操作错误:" << error;
-
-    operationInProgress = false;
-
-    // 启用按钮
-    importButton->setEnabled(true);
-    exportButton->setEnabled(true);
-
-    // 关闭进度对话框
-    if (progressDialog) {
-        progressDialog->reset();
-        progressDialog->hide();
-    }
-
-    QMessageBox::critical(this, "错误", error);
-    statusBar->showMessage("操作出错");
-
-    // 清理线程
-    if (workerThread) {
-        workerThread->quit();
-        workerThread->wait();
-        delete workerThread;
-        workerThread = nullptr;
-        worker = nullptr;
-    }
-}
-
-void MainWindow::cancelOperation()
-{
-    if (operationInProgress && workerThread && workerThread->isRunning()) {
-        QMessageBox::StandardButton reply;
-        reply = QMessageBox::question(this, "确认取消",
-                                      "确定要取消当前操作吗？",
-                                      QMessageBox::Yes | QMessageBox::No);
-
-        if (reply == QMessageBox::Yes) {
-            // 终止线程
-            workerThread->terminate();
-            workerThread->wait();
-
-            operationInProgress = false;
-
-            // 启用按钮
-            importButton->setEnabled(true);
-            exportButton->setEnabled(true);
-
-            // 隐藏进度对话框
-            if (progressDialog) {
-                progressDialog->reset();
-                progressDialog->hide();
-            }
-
-            statusBar->showMessage("操作已取消");
-            QMessageBox::information(this, "提示", "操作已取消");
-        } else {
-            // 重新显示进度对话框
-            if (progressDialog) {
-                progressDialog->show();
-            }
-        }
-    }
-}
-
-void MainWindow::testDatabase()
-{
-    if (Database::instance().init()) {
-        QMessageBox::information(this, "数据库测试", "数据库连接成功！");
-        statusBar->showMessage("数据库连接正常");
-
-        // 测试是否可以获取表单
-        auto forms = Database::instance().getAllForms();
-        qDebug() << "数据库测试: 表单数量:" << forms.size();
-        QMessageBox::information(this, "数据库测试",
-                                 QString("数据库连接成功！\n表单数量: %1").arg(forms.size()));
-    } else {
-        QMessageBox::warning(this, "数据库测试", "数据库连接失败！");
-        statusBar->showMessage("数据库连接失败");
-    }
-}
-
-void MainWindow::showAbout()
-{
-    QMessageBox::about(this, "关于密码管理器",
-                       "个人密码管理器 v2.0（表单增强版）\n\n"
-                       "基于Qt开发的密码管理工具\n"
-                       "新增功能：\n"
-                       "  • 表单管理：可创建多个表单组织密码\n"
-                       "  • 表单切换：类似WPS的标签页界面\n"
-                       "  • 表单搜索：可选择在特定表单中搜索\n"
-                       "  • 表单操作：添加、删除、重命名表单\n"
-                       "  • 增加账号字段（6-20位）\n"
-                       "  • 账号和密码格式验证\n"
-                       "  • 账号加密存储\n"
-                       "  • 多线程导入导出\n"
-                       "  • 操作进度显示\n"
-                       "  • 支持取消长时间操作\n"
-                       "  • 批量操作优化\n"
-                       "  • 导出保密版/未保密版选择\n"
-                       "  • 密码加密存储与导出\n\n"
-                       "课程设计项目 - Qt应用程序开发");
-}
-
-// 表单相关槽函数
-void MainWindow::onFormAdded(int id, const QString &name)
-{
-    qDebug() << "表单添加请求，ID:" << id << "名称:" << name;
-
-    if (id == -1) {
-        // 新表单，需要创建
-        if (Database::instance().addForm(name)) {
-            // 重新加载表单
-            auto forms = Database::instance().getAllForms();
-            formTabWidget->clear();  // 使用clear()函数
-            for (const auto &form : forms) {
-                formTabWidget->addForm(form.id, form.name, form.name == name);
-                if (form.name == name) {
-                    currentFormId = form.id;
-                }
-            }
-            loadPasswords();
-            statusBar->showMessage(QString("表单 '%1' 添加成功").arg(name));
-            QMessageBox::information(this, "成功", QString("表单 '%1' 添加成功").arg(name));
-        } else {
-            QMessageBox::warning(this, "失败", "表单添加失败");
-        }
-    }
-}
-
-void MainWindow::onFormRemoved(int id)
-{
-    qDebug() << "表单删除请求，ID:" << id;
-
-    if (Database::instance().deleteForm(id)) {
-        // 重新加载表单
-        auto forms = Database::instance().getAllForms();
-        formTabWidget->clear();  // 使用clear()函数
-        if (!forms.isEmpty()) {
-            for (const auto &form : forms) {
-                formTabWidget->addForm(form.id, form.name, form.id == forms.first().id);
-                if (form.id == forms.first().id) {
-                    currentFormId = form.id;
-                }
-            }
-        } else {
-            currentFormId = -1;
-        }
-        loadPasswords();
-        statusBar->showMessage("表单删除成功");
-        QMessageBox::information(this, "成功", "表单删除成功");
-    } else {
-        QMessageBox::warning(this, "失败", "表单删除失败");
-    }
-}
-
-void MainWindow::onFormRenamed(int id, const QString &newName)
-{
-    qDebug() << "表单重命名请求，ID:" << id << "新名称:" << newName;
-
-    if (Database::instance().updateForm(id, newName)) {
-        formTabWidget->updateForm(id, newName);
-        statusBar->showMessage(QString("表单重命名为 '%1'").arg(newName));
-    } else {
-        QMessageBox::warning(this, "失败", "表单重命名失败");
-    }
-}
-
-void MainWindow::onCurrentFormChanged(int id)
-{
-    qDebug() << "当前表单改变，新ID:" << id;
-
-    currentFormId = id;
-    loadPasswords();
-}
-
-void MainWindow::onFormSelectionChanged(const QList<int> &selectedIds)
-{
-    selectedFormIdsForSearch = selectedIds;
-    if (selectedIds.isEmpty()) {
-        statusBar->showMessage("未选择任何表单，将在所有表单中搜索");
-        selectedFormIdsForSearch = formTabWidget->allFormIds();
-    } else {
-        statusBar->showMessage(QString("已选择 %1 个表单进行搜索").arg(selectedIds.size()));
-    }
-}
-
-void MainWindow::onSelectFormsClicked()
-{
-    // 获取所有表单信息
-    auto forms = Database::instance().getAllForms();
-    QList<int> formIds;
-    QList<QString> formNames;
-
-    for (const auto &form : forms) {
-        formIds.append(form.id);
-        formNames.append(form.name);
-    }
-
-    // 创建并显示对话框
-    FormSelectDialog dialog(formIds, formNames, selectedFormIdsForSearch, this);
-    if (dialog.exec() == QDialog::Accepted) {
-        QList<int> selectedIds = dialog.selectedFormIds();
-        formTabWidget->setSelectedForms(selectedIds);
-    }
-}
+#include "mainwindow.h"
+#include "database.h"
+#include "asyncdatabase.h"
+#include "encryption.h"
+#include "importexportworker.h"
+#include "formtabwidget.h"
+#include "formselectdialog.h"
+#include "encryptedstream.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QTableView>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLineEdit>
+#include <QMenuBar>
+#include <QMenu>
+#include <QAction>
+#include <QMessageBox>
+#include <QFileDialog>
+#include <QStandardItemModel>
+#include <QInputDialog>
+#include <QStatusBar>
+#include <QTextStream>
+#include <QDebug>
+#include <QCheckBox>
+#include <QItemSelectionModel>
+#include <QAbstractItemView>
+#include <QFileInfo>
+#include <QProgressDialog>
+#include <QApplication>
+#include <QRadioButton>
+#include <QButtonGroup>
+#include <QGroupBox>
+#include <QDialogButtonBox>
+#include <QToolButton>
+#include <QStandardPaths>
+#include <QTimer>
+#include "startuptimer.h"
+#include "formprefetcher.h"
+#include "passwordtablemodel.h"
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent), model(new PasswordTableModel(this)),
+    progressDialog(nullptr), workerThread(nullptr), worker(nullptr),
+    operationInProgress(false), writesBlocked(false), reloadFormsOnFinish(false), multiSelectMode(false),
+    lastSelectedRow(-1), isAllSelected(false),
+    currentFormId(-1), passwordLoadTimer(nullptr), loadingFormId(-1), loadedAfterId(0), loadedCount(0),
+    usingPrefetched(false), viewGeneration(0), asyncDb(nullptr), prefetcher(nullptr)
+{
+    qDebug() << "MainWindow构造函数开始";
+
+    // 先初始化数据库
+    if (!Database::instance().init()) {
+        QMessageBox::critical(this, "数据库错误",
+                              "无法初始化数据库，程序可能无法正常工作。\n请检查SQLite驱动是否可用。");
+        // 这里不退出，尝试继续运行，但可能功能受限
+    } else {
+        qDebug() << "数据库初始化成功";
+    }
+    StartupTimer::mark("初始化数据库");
+
+    asyncDb = new AsyncDatabase(this);
+    prefetcher = new FormPrefetcher(PREFETCH_CACHE_ROWS, this);
+
+    passwordLoadTimer = new QTimer(this);
+    passwordLoadTimer->setSingleShot(true);
+    passwordLoadTimer->setInterval(0);
+    connect(passwordLoadTimer, &QTimer::timeout, this, &MainWindow::loadNextPasswordPage);
+
+    setupUI();
+    StartupTimer::mark("创建界面");
+    loadForms();  // 先加载表单
+    StartupTimer::mark("加载表单");
+
+    // 当前表单的密码在窗口显示后再加载，窗口和标签栏先出现
+    QTimer::singleShot(0, this, &MainWindow::loadPasswords);
+}
+
+MainWindow::~MainWindow()
+{
+    // 清理多线程资源
+    if (workerThread && workerThread->isRunning()) {
+        workerThread->quit();
+        workerThread->wait();
+    }
+
+    delete worker;
+    delete workerThread;
+    delete progressDialog;
+}
+
+void MainWindow::setupUI()
+{
+    setWindowTitle(Database::instance().isPersistent() ? "个人密码管理器（多线程+表单）"
+                                                       : "个人密码管理器（内存密码库，退出后数据不保存）");
+    resize(1000, 700);
+
+    // 中央部件
+    QWidget *centralWidget = new QWidget(this);
+    setCentralWidget(centralWidget);
+
+    // 主布局
+    QVBoxLayout *mainLayout = new QVBoxLayout(centralWidget);
+
+    // 搜索栏
+    QHBoxLayout *searchLayout = new QHBoxLayout();
+    searchEdit = new QLineEdit();
+    searchEdit->setPlaceholderText("搜索网站、用户名...");
+    searchButton = new QPushButton("搜索");
+
+    // 新增：选择表单按钮
+    selectFormsButton = new QToolButton();
+    selectFormsButton->setText("▼");  // 实心倒三角
+    selectFormsButton->setToolTip("选择搜索表单");
+    selectFormsButton->setPopupMode(QToolButton::InstantPopup);
+
+    // 创建下拉菜单
+    QMenu *formSelectMenu = new QMenu(this);
+    QAction *selectFormsAction = new QAction("选择表单...", this);
+    connect(selectFormsAction, &QAction::triggered, this, &MainWindow::onSelectFormsClicked);
+    formSelectMenu->addAction(selectFormsAction);
+    selectFormsButton->setMenu(formSelectMenu);
+
+    // 连接搜索按钮的点击事件
+    connect(searchButton, &QPushButton::clicked, this, &MainWindow::searchPasswords);
+
+    // 连接回车键事件
+    connect(searchEdit, &QLineEdit::returnPressed, this, &MainWindow::searchPasswords);
+
+    searchLayout->addWidget(searchEdit);
+    searchLayout->addWidget(selectFormsButton);
+    searchLayout->addWidget(searchButton);
+    searchLayout->addStretch();
+
+    // 表单标签栏
+    formTabWidget = new FormTabWidget();
+    connect(formTabWidget, &FormTabWidget::formAdded, this, &MainWindow::onFormAdded);
+    connect(formTabWidget, &FormTabWidget::formRemoved, this, &MainWindow::onFormRemoved);
+    connect(formTabWidget, &FormTabWidget::formRenamed, this, &MainWindow::onFormRenamed);
+    connect(formTabWidget, &FormTabWidget::currentFormChanged, this, &MainWindow::onCurrentFormChanged);
+    connect(formTabWidget, &FormTabWidget::formSelectionChanged, this, &MainWindow::onFormSelectionChanged);
+
+    mainLayout->addLayout(searchLayout);
+    mainLayout->addWidget(formTabWidget);
+
+    // 表格
+    tableView = new QTableView();
+    setupTable();
+    mainLayout->addWidget(tableView);
+
+    // 按钮栏
+    addButton = new QPushButton("添加密码");
+    editButton = new QPushButton("编辑");
+    deleteButton = new QPushButton("删除");
+    exportButton = new QPushButton("导出");
+    importButton = new QPushButton("导入");
+    testButton = new QPushButton("测试数据库");
+
+    // 多选和全选按钮
+    multiSelectButton = new QPushButton("多选");
+    selectAllButton = new QPushButton("全选");
+    selectAllButton->setEnabled(false);
+
+    // 批量移动/复制到其他表单（多选模式下可用）
+    moveButton = new QPushButton("移动到...");
+    moveButton->setEnabled(false);
+    copyButton = new QPushButton("复制到...");
+    copyButton->setEnabled(false);
+
+    connect(multiSelectButton, &QPushButton::clicked, this, &MainWindow::toggleMultiSelectMode);
+    connect(selectAllButton, &QPushButton::clicked, this, &MainWindow::selectAll);
+    connect(moveButton, &QPushButton::clicked, this, &MainWindow::moveSelectedPasswords);
+    connect(copyButton, &QPushButton::clicked, this, &MainWindow::copySelectedPasswords);
+
+    // 显示/隐藏密码按钮
+    showPasswordButton = new QPushButton("显示密码");
+    connect(showPasswordButton, &QPushButton::clicked, [this]() {
+        bool isHidden = tableView->isColumnHidden(4);  // 第4列是密码列
+        tableView->setColumnHidden(4, !isHidden);
+        if (isHidden) {
+            this->showPasswordButton->setText("隐藏密码");
+        } else {
+            this->showPasswordButton->setText("显示密码");
+        }
+    });
+
+    connect(addButton, &QPushButton::clicked, this, &MainWindow::addPassword);
+    connect(editButton, &QPushButton::clicked, this, &MainWindow::editPassword);
+    connect(deleteButton, &QPushButton::clicked, this, &MainWindow::deletePassword);
+    connect(exportButton, &QPushButton::clicked, this, &MainWindow::exportPasswords);
+    connect(importButton, &QPushButton::clicked, this, &MainWindow::importPasswords);
+    connect(testButton, &QPushButton::clicked, this, &MainWindow::testDatabase);
+
+    // 第一行按钮
+    QHBoxLayout *buttonLayout1 = new QHBoxLayout();
+    buttonLayout1->addWidget(addButton);
+    buttonLayout1->addWidget(editButton);
+    buttonLayout1->addWidget(deleteButton);
+    buttonLayout1->addStretch();
+    buttonLayout1->addWidget(multiSelectButton);
+    buttonLayout1->addWidget(selectAllButton);
+    buttonLayout1->addWidget(moveButton);
+    buttonLayout1->addWidget(copyButton);
+    buttonLayout1->addStretch();
+    buttonLayout1->addWidget(showPasswordButton);
+
+    // 第二行按钮
+    QHBoxLayout *buttonLayout2 = new QHBoxLayout();
+    buttonLayout2->addStretch();
+    buttonLayout2->addWidget(exportButton);
+    buttonLayout2->addWidget(importButton);
+    buttonLayout2->addWidget(testButton);
+    buttonLayout2->addStretch();
+
+    // 添加到主布局
+    mainLayout->addLayout(buttonLayout1);
+    mainLayout->addLayout(buttonLayout2);
+
+    // 菜单栏
+    menuBar = new QMenuBar(this);
+    setMenuBar(menuBar);
+
+    QMenu *fileMenu = menuBar->addMenu("文件");
+    QAction *exportAction = fileMenu->addAction("导出密码");
+    QAction *importAction = fileMenu->addAction("导入密码");
+    fileMenu->addSeparator();
+    QAction *backupAction = fileMenu->addAction("备份密码库...");
+    QAction *restoreAction = fileMenu->addAction("从备份恢复...");
+    QAction *snapshotAction = fileMenu->addAction("数据库热备份...");
+    fileMenu->addSeparator();
+    QAction *exitAction = fileMenu->addAction("退出");
+
+    connect(exportAction, &QAction::triggered, this, &MainWindow::exportPasswords);
+    connect(importAction, &QAction::triggered, this, &MainWindow::importPasswords);
+    connect(backupAction, &QAction::triggered, this, &MainWindow::backupVault);
+    connect(restoreAction, &QAction::triggered, this, &MainWindow::restoreVault);
+    connect(snapshotAction, &QAction::triggered, this, &MainWindow::snapshotDatabase);
+    connect(exitAction, &QAction::triggered, this, &QMainWindow::close);
+
+    QMenu *helpMenu = menuBar->addMenu("帮助");
+    QAction *aboutAction = helpMenu->addAction("关于");
+    connect(aboutAction, &QAction::triggered, this, &MainWindow::showAbout);
+
+    // 状态栏
+    statusBar = new QStatusBar();
+    setStatusBar(statusBar);
+    statusBar->showMessage("就绪");
+}
+
+void MainWindow::createProgressDialog()
+{
+    // 如果已经存在，先删除
+    if (progressDialog) {
+        delete progressDialog;
+        progressDialog = nullptr;
+    }
+
+    // 创建新的进度对话框
+    progressDialog = new QProgressDialog(this);
+    progressDialog->setWindowTitle("操作进度");
+    progressDialog->setLabelText("正在处理...");
+    progressDialog->setCancelButtonText("取消");
+    progressDialog->setRange(0, 100);
+    progressDialog->setValue(0);
+
+    // 修改为无模态，不阻塞主窗口
+    progressDialog->setModal(false);
+
+    // 设置为非置顶窗口
+    progressDialog->setWindowFlags(Qt::Dialog | Qt::CustomizeWindowHint | Qt::WindowTitleHint);
+
+    // 不自动关闭和重置，由我们手动控制
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+
+    // 设置最小化时不显示进度对话框
+    progressDialog->setAttribute(Qt::WA_ShowWithoutActivating, false);
+
+    connect(progressDialog, &QProgressDialog::canceled, this, &MainWindow::cancelOperation);
+}
+
+void MainWindow::setupTable()
+{
+    model->setColumnCount(9);  // 修改：增加一列表单ID，现在是9列
+    model->setHeaderData(0, Qt::Horizontal, "ID");
+    model->setHeaderData(1, Qt::Horizontal, "网站/应用");
+    model->setHeaderData(2, Qt::Horizontal, "用户名");
+    model->setHeaderData(3, Qt::Horizontal, "账号");
+    model->setHeaderData(4, Qt::Horizontal, "密码");
+    model->setHeaderData(5, Qt::Horizontal, "备注");
+    model->setHeaderData(6, Qt::Horizontal, "加密账号密码");
+    model->setHeaderData(7, Qt::Horizontal, "表单ID");
+    model->setHeaderData(8, Qt::Horizontal, "选择");
+
+    tableView->setModel(model);
+    tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tableView->horizontalHeader()->setStretchLastSection(true);
+    tableView->setAlternatingRowColors(true);
+
+    // 设置列宽
+    tableView->setColumnWidth(1, 150);
+    tableView->setColumnWidth(2, 120);
+    tableView->setColumnWidth(3, 120);
+    tableView->setColumnWidth(4, 100);
+    tableView->setColumnWidth(5, 200);
+    tableView->setColumnWidth(8, 60);
+
+    // 隐藏列
+    tableView->setColumnHidden(0, true);
+    tableView->setColumnHidden(6, true);
+    tableView->setColumnHidden(7, true);
+    tableView->setColumnHidden(8, !multiSelectMode);
+
+    // 连接信号
+    connect(tableView, &QTableView::clicked, this, &MainWindow::onTableViewClicked);
+    connect(tableView, &QTableView::doubleClicked, this, &MainWindow::onItemDoubleClicked);
+}
+
+void MainWindow::onTableViewClicked(const QModelIndex &index)
+{
+    // 获取当前选中模型
+    QItemSelectionModel *selectionModel = tableView->selectionModel();
+
+    if (!selectionModel) {
+        return;
+    }
+
+    // 获取当前点击的行
+    int clickedRow = index.row();
+
+    // 检查是否点击了表格的空白区域（无效行）
+    if (clickedRow < 0 || clickedRow >= model->rowCount()) {
+        // 点击了表格的空白区域，清除选中
+        if (multiSelectMode) {
+            // 在多选模式下，清除所有复选框的选中状态
+            clearAllCheckboxes();
+            statusBar->showMessage("已清除所有选择");
+        } else {
+            // 在普通模式下，清除行选择
+            selectionModel->clearSelection();
+            lastSelectedRow = -1;
+            statusBar->showMessage("已清除选择");
+        }
+        return;
+    }
+
+    // 如果点击的是有效的行
+    if (multiSelectMode) {
+        // 在多选模式下，不处理点击选中逻辑，由复选框控制
+        // 只是更新状态栏显示信息
+        QString website = model->item(clickedRow, 1)->text();
+        QString username = model->item(clickedRow, 2)->text();
+        statusBar->showMessage(QString("已选择行: %1 - %2").arg(website).arg(username));
+    } else {
+        // 在普通模式下
+        // 如果点击的是上次选中的同一行，取消选中
+        if (clickedRow == lastSelectedRow) {
+            selectionModel->clearSelection();
+            lastSelectedRow = -1;
+            statusBar->showMessage("已取消选择");
+        } else {
+            // 否则，选中新的一行
+            tableView->selectRow(clickedRow);
+            lastSelectedRow = clickedRow;
+
+            QString website = model->item(clickedRow, 1)->text();
+            QString username = model->item(clickedRow, 2)->text();
+            statusBar->showMessage(QString("已选择: %1 - %2").arg(website).arg(username));
+        }
+    }
+}
+
+void MainWindow::clearAllCheckboxes()
+{
+    // 清除所有复选框的选中状态
+    model->setAllChecked(false);
+
+    // 更新全选状态和按钮文字
+    isAllSelected = false;
+    updateSelectAllButtonText();
+}
+
+void MainWindow::onItemDoubleClicked(const QModelIndex &index)
+{
+    if (!checkWritesAllowed()) {
+        return;
+    }
+
+    if (multiSelectMode) {
+        // 多选模式下，不允许直接编辑单元格
+        QMessageBox::information(this, "提示", "多选模式下请使用编辑按钮进行编辑");
+        return;
+    }
+
+    int row = index.row();
+    int column = index.column();
+
+    // 检查是否点击了有效单元格
+    if (row < 0 || row >= model->rowCount()) {
+        return;
+    }
+
+    // 检查是否点击了可编辑的列（网站、用户名、账号、密码、备注）
+    if (column >= 1 && column <= 5) {
+        editField(row, column);
+    } else {
+        // 如果点击了ID列或加密密码列或表单ID列，提示不可编辑
+        if (column == 0 || column == 6 || column == 7) {
+            QMessageBox::information(this, "提示", "此列不可编辑");
+        }
+    }
+}
+
+void MainWindow::editField(int row, int column)
+{
+    // 从第0列获取ID
+    QStandardItem* idItem = model->item(row, 0);
+    if (!idItem) {
+        statusBar->showMessage("获取记录ID失败");
+        return;
+    }
+
+    int id = idItem->data(Qt::UserRole + 1).toInt();
+
+    // 获取当前单元格的值
+    QString currentValue = model->item(row, column)->text();
+
+    // 根据列设置对话框标题和标签
+    QString title, label;
+    switch(column) {
+    case 1: // 网站
+        title = "编辑网站";
+        label = "网站/应用:";
+        break;
+    case 2: // 用户名
+        title = "编辑用户名";
+        label = "用户名:";
+        break;
+    case 3: // 账号
+        title = "编辑账号";
+        label = "账号(6-20位):";
+        break;
+    case 4: // 密码
+        title = "编辑密码";
+        label = "密码(6-20位):";
+        break;
+    case 5: // 备注
+        title = "编辑备注";
+        label = "备注:";
+        break;
+    default:
+        title = "编辑";
+        label = "值:";
+        break;
+    }
+
+    bool ok;
+    QString newValue;
+
+    // 对于账号和密码字段，需要循环验证直到输入正确或用户取消
+    if (column == 3 || column == 4) { // 账号或密码列
+        while (true) {
+            newValue = QInputDialog::getText(this, title, label,
+                                             QLineEdit::Normal, currentValue, &ok);
+
+            if (!ok) {
+                statusBar->showMessage("已取消编辑");
+                return;
+            }
+
+            // 验证长度
+            if (newValue.length() >= 6 && newValue.length() <= 20) {
+                break; // 验证通过，退出循环
+            } else {
+                // 验证失败，显示错误提示，然后重新输入
+                QMessageBox::warning(this, "输入错误", "请输入正确格式(6-20位)!");
+                currentValue = newValue; // 使用上次输入的值作为新对话框的初始值
+            }
+        }
+    } else {
+        // 其他字段直接输入
+        newValue = QInputDialog::getText(this, title, label,
+                                         QLineEdit::Normal, currentValue, &ok);
+
+        if (!ok) {
+            statusBar->showMessage("已取消编辑");
+            return;
+        }
+    }
+
+    // 如果值没有变化，直接返回
+    if (newValue == currentValue) {
+        statusBar->showMessage("值未变化");
+        return;
+    }
+
+    // 只加密被修改的账号或密码，其他字段保持不变
+    bool isSecret = (column == 3 || column == 4);
+    QString storedValue = isSecret ? Encryption::encrypt(newValue) : newValue;
+
+    // 在数据库线程上修改；完成时表格可能已经重新加载，按记录ID找到对应的行
+    auto field = static_cast<StorageBackend::EntryField>(column);
+    AsyncDatabase::onFinished(asyncDb->updateField(id, field, storedValue), this,
+                              [this, id, column, newValue, storedValue, isSecret](const AsyncDatabase::FieldUpdate &result) {
+        if (!result.ok) {
+            statusBar->showMessage(result.conflict ? "编辑失败，新的网站、用户名和账号组合已存在" : "编辑失败");
+            return;
+        }
+
+        int row = rowForId(id);
+        if (row >= 0) {
+            // 更新模型中的数据
+            model->item(row, column)->setText(newValue);
+
+            // 如果是账号或密码列，还需要更新加密列（格式为"加密账号|加密密码"，另一半沿用原值）
+            if (isSecret) {
+                QStringList encryptedParts = model->item(row, 6)->text().split('|');
+                while (encryptedParts.size() < 2) {
+                    encryptedParts.append(QString());
+                }
+                encryptedParts[column == 3 ? 0 : 1] = storedValue;
+                model->item(row, 6)->setText(encryptedParts[0] + "|" + encryptedParts[1]);
+            }
+        }
+        // 修改的记录可能属于其他表单（跨表单搜索结果），预读的缓存作废，与删除时相同
+        prefetcher->clear();
+        statusBar->showMessage("编辑成功");
+    });
+}
+
+int MainWindow::rowForId(int id) const
+{
+    for (int row = 0; row < model->rowCount(); ++row) {
+        if (model->rowId(row) == id) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void MainWindow::showMessageLater(QMessageBox::Icon icon, const QString &title, const QString &text)
+{
+    QMetaObject::invokeMethod(this, [this, icon, title, text]() {
+        QMessageBox box(icon, title, text, QMessageBox::Ok, this);
+        box.exec();
+    }, Qt::QueuedConnection);
+}
+
+bool MainWindow::checkWritesAllowed()
+{
+    if (writesBlocked) {
+        QMessageBox::warning(this, "警告", "正在导入、恢复或备份数据，请等待完成后再修改");
+        return false;
+    }
+    return true;
+}
+
+void MainWindow::clearSelection()
+{
+    QItemSelectionModel *selectionModel = tableView->selectionModel();
+    if (selectionModel) {
+        selectionModel->clearSelection();
+    }
+    lastSelectedRow = -1;
+
+    // 在多选模式下，还需要清除所有复选框的选择
+    if (multiSelectMode) {
+        clearAllCheckboxes();
+    }
+}
+
+void MainWindow::loadForms()
+{
+    qDebug() << "开始加载表单";
+
+    auto forms = Database::instance().getAllForms();
+    qDebug() << "获取到表单数量:" << forms.size();
+
+    formTabWidget->clear();  // 清空标签栏
+
+    if (forms.isEmpty()) {
+        // 如果没有表单，创建一个默认表单
+        qDebug() << "没有表单，创建默认表单";
+        if (Database::instance().addForm("默认表单")) {
+            forms = Database::instance().getAllForms();
+            qDebug() << "重新获取表单数量:" << forms.size();
+        } else {
+            qDebug() << "创建默认表单失败";
+        }
+    }
+
+    for (const auto &form : forms) {
+        qDebug() << "添加表单:" << form.id << form.name;
+        formTabWidget->addForm(form.id, form.name, currentFormId == -1 || form.id == currentFormId);
+        if (currentFormId == -1) {
+            currentFormId = form.id;
+            qDebug() << "设置当前表单ID为:" << currentFormId;
+        }
+    }
+
+    // 默认在所有表单中搜索
+    selectedFormIdsForSearch = formTabWidget->allFormIds();
+    updateFormCounts();
+
+    // 如果当前表单ID仍然为-1，设置为第一个表单的ID
+    if (currentFormId == -1 && !forms.isEmpty()) {
+        currentFormId = forms.first().id;
+        qDebug() << "重新设置当前表单ID为第一个表单:" << currentFormId;
+    }
+
+    qDebug() << "表单加载完成，当前表单ID:" << currentFormId;
+}
+
+void MainWindow::loadPasswords()
+{
+    // 数据可能刚被修改，预读的内容作废
+    prefetcher->clear();
+    loadCurrentForm();
+}
+
+void MainWindow::loadCurrentForm()
+{
+    qDebug() << "开始加载密码，当前表单ID:" << currentFormId;
+
+    // 停止上一次尚未完成的分批加载和搜索，真正的加载优先于后台预读
+    passwordLoadTimer->stop();
+    asyncDb->cancel(AsyncDatabase::SearchRead);
+    ++viewGeneration;
+    prefetcher->cancel();
+
+    // 断开之前的连接，避免重复连接
+    disconnect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+
+    model->removeRows(0, model->rowCount());
+
+    // 数据库只在构造函数中初始化一次；表单列表以标签栏为准（loadForms已读取），这里不再同步查询
+    // 如果当前表单ID为-1，尝试使用第一个表单
+    if (currentFormId == -1) {
+        QList<int> formIds = formTabWidget->allFormIds();
+        if (!formIds.isEmpty()) {
+            currentFormId = formIds.first();
+            qDebug() << "设置当前表单ID为第一个表单:" << currentFormId;
+
+            // 更新标签栏当前选中项
+            formTabWidget->setCurrentForm(currentFormId);
+        } else {
+            qDebug() << "没有可用的表单";
+            statusBar->showMessage("没有可用的表单");
+            return;
+        }
+    }
+
+    // 先同步显示第一页，其余记录在之后的事件循环中分批追加，界面不会因大表单卡住
+    loadingFormId = currentFormId;
+    loadedAfterId = 0;
+    loadedCount = 0;
+    prefetchedForm = FormPrefetcher::PrefetchedForm();
+    usingPrefetched = prefetcher->take(currentFormId, prefetchedForm);
+
+    // 重置全选状态
+    isAllSelected = false;
+    updateSelectAllButtonText();
+
+    // 清除选中状态
+    clearSelection();
+
+    // 连接复选框状态改变信号
+    connect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+
+    loadNextPasswordPage();
+}
+
+void MainWindow::loadNextPasswordPage()
+{
+    if (usingPrefetched) {
+        // 预读的记录已经解密，只需要创建表格行
+        int firstNewRow = model->rowCount();
+        int end = qMin<int>(loadedCount + PASSWORD_PAGE_SIZE, prefetchedForm.entries.size());
+        for (int i = loadedCount; i < end; ++i) {
+            model->appendRow(createPasswordRow(prefetchedForm.entries[i], prefetchedForm.accounts[i],
+                                               prefetchedForm.passwords[i]));
+        }
+        finishPasswordPage(firstNewRow, end - loadedCount, end < prefetchedForm.entries.size());
+        return;
+    }
+
+    // 下一页在数据库线程上读取；切换表单、重新加载或搜索后这一页的结果不再显示
+    int generation = viewGeneration;
+    AsyncDatabase::onFinished(asyncDb->getPasswordsAfter(loadingFormId, loadedAfterId, PASSWORD_PAGE_SIZE), this,
+                              [this, generation](const QList<PasswordEntry> &passwords) {
+        if (generation != viewGeneration) {
+            return;
+        }
+        int firstNewRow = model->rowCount();
+        for (const auto &pwd : passwords) {
+            model->appendRow(createPasswordRow(pwd, Encryption::decrypt(pwd.account), Encryption::decrypt(pwd.password)));
+        }
+        if (!passwords.isEmpty()) {
+            loadedAfterId = passwords.last().id;
+        }
+        finishPasswordPage(firstNewRow, passwords.size(), passwords.size() == PASSWORD_PAGE_SIZE);
+    });
+}
+
+void MainWindow::finishPasswordPage(int firstNewRow, int pageCount, bool hasMore)
+{
+    if (isAllSelected) {
+        model->setRowsChecked(firstNewRow, model->rowCount() - 1, true);  // 加载过程中点了全选，后续记录同样选中
+    }
+    if (loadedCount == 0) {
+        StartupTimer::mark("显示首批记录");
+    }
+    loadedCount += pageCount;
+
+    if (hasMore) {
+        statusBar->showMessage(QString("表单 '%1' 正在加载，已加载 %2 条记录").arg(formTabWidget->currentFormName()).arg(loadedCount));
+        passwordLoadTimer->start();
+        return;
+    }
+
+    qDebug() << "获取到密码记录数量:" << loadedCount;
+    statusBar->showMessage(QString("表单 '%1' 加载了 %2 条记录").arg(formTabWidget->currentFormName()).arg(loadedCount));
+    updateFormCounts();  // 增删改之后都会重新加载，这里顺便刷新标签上的记录数
+
+    if (usingPrefetched) {
+        prefetchedForm = FormPrefetcher::PrefetchedForm();
+        usingPrefetched = false;
+    }
+    schedulePrefetch();
+
+    StartupTimer::mark("加载完当前表单");
+    StartupTimer::finish();
+
+    qDebug() << "密码加载完成";
+}
+
+void MainWindow::updateFormCounts()
+{
+    // form_stats由触发器维护，读取代价只和表单数量有关
+    AsyncDatabase::onFinished(asyncDb->getFormStats(), this, [this](const QHash<int, FormStats> &stats) {
+        QHash<int, int> counts;
+        for (const auto &entry : stats) {
+            counts.insert(entry.formId, entry.entryCount);
+        }
+        formTabWidget->setFormCounts(counts);
+    });
+}
+
+void MainWindow::schedulePrefetch()
+{
+    // 预读在后台SQLite连接上进行，内存密码库本身就不需要磁盘I/O
+    if (operationInProgress || !Database::instance().isPersistent()) {
+        return;
+    }
+
+    // 相邻的标签和最常打开的表单；一页就能显示完的小表单不需要预读
+    // 记录数与updateFormCounts的请求合并，只读取一次
+    QList<int> candidates = formTabWidget->adjacentFormIds(currentFormId);
+    candidates += prefetcher->mostOpenedForms(PREFETCH_FREQUENT_FORMS);
+    int formId = currentFormId;
+    AsyncDatabase::onFinished(asyncDb->getFormStats(), this,
+                              [this, candidates, formId](const QHash<int, FormStats> &stats) {
+        if (formId != currentFormId || operationInProgress) {
+            return;
+        }
+        QList<int> formIds;
+        for (int candidate : candidates) {
+            if (candidate != currentFormId && stats.value(candidate).entryCount > PASSWORD_PAGE_SIZE) {
+                formIds.append(candidate);
+            }
+        }
+        prefetcher->schedule(formIds);
+    });
+}
+
+QList<QStandardItem*> MainWindow::createPasswordRow(const PasswordEntry &pwd, const QString &account,
+                                                   const QString &password)
+{
+    QList<QStandardItem*> row;
+
+    // 第0列：隐藏的ID
+    QStandardItem* idItem = new QStandardItem();
+    idItem->setData(pwd.id, Qt::UserRole + 1);
+    row << idItem;
+
+    // 第1列：网站
+    QStandardItem* websiteItem = new QStandardItem(pwd.website);
+    websiteItem->setEditable(false);
+    row << websiteItem;
+
+    // 第2列：用户名
+    QStandardItem* usernameItem = new QStandardItem(pwd.username);
+    usernameItem->setEditable(false);
+    row << usernameItem;
+
+    // 第3列：账号（解密后）
+    QStandardItem* accountItem = new QStandardItem(account);
+    accountItem->setEditable(false);
+    row << accountItem;
+
+    // 第4列：密码（解密后）
+    QStandardItem* passwordItem = new QStandardItem(password);
+    passwordItem->setEditable(false);
+    row << passwordItem;
+
+    // 第5列：备注
+    QStandardItem* notesItem = new QStandardItem(pwd.notes);
+    notesItem->setEditable(false);
+    row << notesItem;
+
+    // 第6列：加密账号和密码
+    QStandardItem* encryptedItem = new QStandardItem(pwd.account + "|" + pwd.password);
+    encryptedItem->setEditable(false);
+    row << encryptedItem;
+
+    // 第7列：表单ID
+    QStandardItem* formIdItem = new QStandardItem(QString::number(pwd.form_id));
+    formIdItem->setEditable(false);
+    row << formIdItem;
+
+    // 第8列：选择框（勾选状态由PasswordTableModel按记录ID保存）
+    QStandardItem* checkItem = new QStandardItem();
+    checkItem->setCheckable(true);
+    checkItem->setEditable(false);
+    row << checkItem;
+
+    return row;
+}
+
+void MainWindow::updateButtonStates()
+{
+    // 更新按钮状态
+    if (multiSelectMode) {
+        selectAllButton->setEnabled(true);
+        moveButton->setEnabled(true);
+        copyButton->setEnabled(true);
+        deleteButton->setText("批量删除");
+        exportButton->setText("批量导出");
+        tableView->setSelectionMode(QAbstractItemView::MultiSelection);
+    } else {
+        selectAllButton->setEnabled(false);
+        moveButton->setEnabled(false);
+        copyButton->setEnabled(false);
+        deleteButton->setText("删除");
+        exportButton->setText("导出");
+        tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    }
+}
+
+void MainWindow::toggleMultiSelectMode()
+{
+    multiSelectMode = !multiSelectMode;
+
+    if (multiSelectMode) {
+        multiSelectButton->setText("取消多选");
+        tableView->setColumnHidden(8, false);  // 显示选择框列
+    } else {
+        multiSelectButton->setText("多选");
+        tableView->setColumnHidden(8, true);   // 隐藏选择框列
+
+        // 清除所有复选框的选择状态
+        clearAllCheckboxes();
+    }
+
+    // 清除当前选中状态
+    clearSelection();
+
+    updateButtonStates();
+}
+
+void MainWindow::updateSelectAllButtonText()
+{
+    if (isAllSelected) {
+        selectAllButton->setText("取消全选");
+    } else {
+        selectAllButton->setText("全选");
+    }
+}
+
+void MainWindow::selectAll()
+{
+    if (!multiSelectMode) {
+        return;
+    }
+
+    // 切换全选状态
+    isAllSelected = !isAllSelected;
+
+    // 根据全选状态一次设置所有复选框，选中状态保存在模型的ID集合中
+    disconnect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+    model->setAllChecked(isAllSelected);
+    connect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+
+    // 更新按钮文字
+    updateSelectAllButtonText();
+
+    // 更新状态栏
+    if (isAllSelected) {
+        statusBar->showMessage(QString("已全选 %1 条记录").arg(model->rowCount()));
+    } else {
+        statusBar->showMessage("已取消全选");
+    }
+}
+
+void MainWindow::onCheckboxStateChanged()
+{
+    if (!multiSelectMode) {
+        return;
+    }
+
+    // 选中数量由模型维护，不需要遍历所有行
+    int selectedCount = model->checkedCount();
+
+    // 更新全选状态
+    isAllSelected = (selectedCount == model->rowCount() && model->rowCount() > 0);
+    updateSelectAllButtonText();
+
+    if (selectedCount > 0) {
+        statusBar->showMessage(QString("已选中 %1 条记录").arg(selectedCount));
+    } else {
+        statusBar->showMessage("就绪");
+    }
+}
+
+void MainWindow::addPassword()
+{
+    if (!checkWritesAllowed()) {
+        return;
+    }
+
+    qDebug() << "开始添加密码，当前表单ID:" << currentFormId;
+
+    // 清除当前选中状态
+    clearSelection();
+
+    if (currentFormId == -1) {
+        qDebug() << "当前表单ID为-1，尝试创建默认表单";
+        QMessageBox::warning(this, "警告", "没有可用表单，正在创建默认表单...");
+
+        // 尝试创建默认表单
+        if (Database::instance().addForm("默认表单")) {
+            loadForms(); // 重新加载表单
+            if (currentFormId == -1) {
+                QMessageBox::critical(this, "错误", "创建默认表单失败，无法添加密码");
+                return;
+            }
+        } else {
+            QMessageBox::critical(this, "错误", "无法创建表单，请检查数据库连接");
+            return;
+        }
+    }
+
+    // 简单对话框添加
+    bool ok;
+    QString website = QInputDialog::getText(this, "添加密码", "网站/应用:", QLineEdit::Normal, "", &ok);
+    if (!ok || website.isEmpty()) {
+        statusBar->showMessage("已取消添加");
+        return;
+    }
+
+    QString username = QInputDialog::getText(this, "添加密码", "用户名:", QLineEdit::Normal, "", &ok);
+    if (!ok) {
+        statusBar->showMessage("已取消添加");
+        return;
+    }
+
+    // 账号输入 - 循环验证
+    QString account;
+    QString accountTemp = "";
+    while (true) {
+        account = QInputDialog::getText(this, "添加密码", "账号(6-20位):", QLineEdit::Normal, accountTemp, &ok);
+        if (!ok) {
+            statusBar->showMessage("已取消添加");
+            return;
+        }
+
+        // 验证账号格式
+        if (account.length() >= 6 && account.length() <= 20) {
+            break; // 验证通过，退出循环
+        } else {
+            // 验证失败，显示错误提示，然后重新输入
+            QMessageBox::warning(this, "输入错误", "请输入正确格式的账号(6-20位)!");
+            accountTemp = account; // 使用上次输入的值作为新对话框的初始值
+        }
+    }
+
+    // 密码输入 - 循环验证
+    QString password;
+    QString passwordTemp = "";
+    while (true) {
+        password = QInputDialog::getText(this, "添加密码", "密码(6-20位):", QLineEdit::Normal, passwordTemp, &ok);
+        if (!ok) {
+            statusBar->showMessage("已取消添加");
+            return;
+        }
+
+        // 验证密码格式
+        if (password.length() >= 6 && password.length() <= 20) {
+            break; // 验证通过，退出循环
+        } else {
+            // 验证失败，显示错误提示，然后重新输入
+            QMessageBox::warning(this, "输入错误", "请输入正确格式的密码(6-20位)!");
+            passwordTemp = password; // 使用上次输入的值作为新对话框的初始值
+        }
+    }
+
+    QString notes = QInputDialog::getText(this, "添加密码", "备注:", QLineEdit::Normal, "", &ok);
+
+    // 加密账号和密码
+    QString encryptedAccount = Encryption::encrypt(account);
+    QString encryptedPassword = Encryption::encrypt(password);
+
+    qDebug() << "准备添加密码到数据库，表单ID:" << currentFormId;
+    qDebug() << "网站:" << website << "用户名:" << username << "账号:" << account;
+
+    auto added = asyncDb->addPassword(currentFormId, website, username, encryptedAccount, encryptedPassword, notes);
+    AsyncDatabase::onFinished(added, this, [this](bool ok) {
+        if (ok) {
+            loadPasswords();
+            statusBar->showMessage("密码添加成功");
+            showMessageLater(QMessageBox::Information, "成功", "密码添加成功!");
+        } else {
+            statusBar->showMessage("密码添加失败，可能已存在相同记录");
+            showMessageLater(QMessageBox::Warning, "失败", "密码添加失败，可能已存在相同记录!");
+        }
+    });
+}
+
+void MainWindow::editSelectedRow(int row)
+{
+    if (!checkWritesAllowed()) {
+        return;
+    }
+
+    // 从第0列获取ID
+    QStandardItem* idItem = model->item(row, 0);
+    if (!idItem) {
+        statusBar->showMessage("获取记录ID失败");
+        return;
+    }
+
+    int id = idItem->data(Qt::UserRole + 1).toInt();
+
+    // 获取表单ID
+    int form_id = model->item(row, 7)->text().toInt();
+
+    bool ok;
+    QString website = QInputDialog::getText(this, "编辑密码", "网站/应用:",
+                                            QLineEdit::Normal, model->item(row, 1)->text(), &ok);
+    if (!ok) {
+        statusBar->showMessage("已取消编辑");
+        return;
+    }
+
+    QString username = QInputDialog::getText(this, "编辑密码", "用户名:",
+                                             QLineEdit::Normal, model->item(row, 2)->text(), &ok);
+    if (!ok) {
+        statusBar->showMessage("已取消编辑");
+        return;
+    }
+
+    // 账号输入 - 循环验证
+    QString account;
+    QString accountTemp = model->item(row, 3)->text();
+    while (true) {
+        account = QInputDialog::getText(this, "编辑密码", "账号(6-20位):",
+                                        QLineEdit::Normal, accountTemp, &ok);
+        if (!ok) {
+            statusBar->showMessage("已取消编辑");
+            return;
+        }
+
+        // 验证账号格式
+        if (account.length() >= 6 && account.length() <= 20) {
+            break; // 验证通过，退出循环
+        } else {
+            // 验证失败，显示错误提示，然后重新输入
+            QMessageBox::warning(this, "输入错误", "请输入正确格式的账号(6-20位)!");
+            accountTemp = account; // 使用上次输入的值作为新对话框的初始值
+        }
+    }
+
+    // 密码输入 - 循环验证
+    QString password;
+    QString passwordTemp = model->item(row, 4)->text();
+    while (true) {
+        password = QInputDialog::getText(this, "编辑密码", "密码(6-20位):",
+                                         QLineEdit::Normal, passwordTemp, &ok);
+        if (!ok) {
+            statusBar->showMessage("已取消编辑");
+            return;
+        }
+
+        // 验证密码格式
+        if (password.length() >= 6 && password.length() <= 20) {
+            break; // 验证通过，退出循环
+        } else {
+            // 验证失败，显示错误提示，然后重新输入
+            QMessageBox::warning(this, "输入错误", "请输入正确格式的密码(6-20位)!");
+            passwordTemp = password; // 使用上次输入的值作为新对话框的初始值
+        }
+    }
+
+    QString notes = QInputDialog::getText(this, "编辑密码", "备注:",
+                                          QLineEdit::Normal, model->item(row, 5)->text(), &ok);
+
+    QString newEncryptedAccount = Encryption::encrypt(account);
+    QString newEncryptedPassword = Encryption::encrypt(password);
+
+    qDebug() << "准备更新密码，ID:" << id << "表单ID:" << form_id;
+
+    auto updated = asyncDb->updatePassword(id, form_id, website, username, newEncryptedAccount, newEncryptedPassword, notes);
+    AsyncDatabase::onFinished(updated, this, [this](bool ok) {
+        if (ok) {
+            loadPasswords();
+            statusBar->showMessage("密码更新成功");
+        } else {
+            statusBar->showMessage("密码更新失败，可能是新的网站、用户名和账号组合已存在");
+        }
+    });
+}
+
+void MainWindow::editPassword()
+{
+    // 根据当前模式判断如何获取选中的行
+    if (multiSelectMode) {
+        // 在多选模式下，检查是否有选中的行
+        if (model->checkedCount() == 0) {
+            QMessageBox::warning(this, "警告", "请先选择一条记录");
+            return;
+        }
+
+        if (model->checkedCount() > 1) {
+            QMessageBox::warning(this, "警告", "编辑操作只能选择一条记录");
+            return;
+        }
+
+        // 编辑选中的单条记录
+        int row = model->checkedRows().first();
+        editSelectedRow(row);
+    } else {
+        // 在普通模式下，使用当前选中的行
+        QItemSelectionModel *selectionModel = tableView->selectionModel();
+        if (!selectionModel || !selectionModel->hasSelection()) {
+            QMessageBox::warning(this, "警告", "请先选择一条记录");
+            return;
+        }
+
+        QModelIndexList selectedIndexes = selectionModel->selectedRows();
+        if (selectedIndexes.isEmpty()) {
+            QMessageBox::warning(this, "警告", "请先选择一条记录");
+            return;
+        }
+
+        int row = selectedIndexes.first().row();
+        editSelectedRow(row);
+    }
+}
+
+void MainWindow::deletePassword()
+{
+    if (!checkWritesAllowed()) {
+        return;
+    }
+
+    if (multiSelectMode) {
+        // 批量删除模式
+        QList<int> rowsToDelete;
+        QList<int> idsToDelete;
+        QList<int> formIdsToDelete;
+
+        // 收集要删除的行和ID
+        for (int i : model->checkedRows()) {
+            rowsToDelete.append(i);
+            int id = model->item(i, 0)->data(Qt::UserRole + 1).toInt();  // 获取ID
+            idsToDelete.append(id);
+            int form_id = model->item(i, 7)->text().toInt();  // 获取表单ID
+            formIdsToDelete.append(form_id);
+        }
+
+        if (rowsToDelete.isEmpty()) {
+            QMessageBox::warning(this, "警告", "请先选择要删除的记录");
+            return;
+        }
+
+        QMessageBox::StandardButton reply;
+        reply = QMessageBox::question(this, "确认批量删除",
+                                      QString("确定要删除选中的 %1 条记录吗?").arg(rowsToDelete.size()),
+                                      QMessageBox::Yes | QMessageBox::No);
+
+        if (reply == QMessageBox::Yes) {
+            // 数据库在一个事务中删除，表格按连续范围删除行；完成前表格可能已经变化，按ID重新查找行号
+            statusBar->showMessage(QString("正在删除 %1 条记录...").arg(idsToDelete.size()));
+            auto deleted = asyncDb->deletePasswords(idsToDelete);
+            AsyncDatabase::onFinished(deleted, this, [this, idsToDelete](int deletedCount) {
+                if (deletedCount < 0) {
+                    statusBar->showMessage("批量删除失败，没有记录被删除");
+                    return;
+                }
+
+                QSet<int> deletedIds(idsToDelete.begin(), idsToDelete.end());
+                QList<int> rows;
+                for (int row = 0; row < model->rowCount(); ++row) {
+                    if (deletedIds.contains(model->rowId(row))) {
+                        rows.append(row);
+                    }
+                }
+                disconnect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+                model->removeRowList(rows);
+                connect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+
+                prefetcher->clear();
+                updateFormCounts();
+                statusBar->showMessage(QString("成功删除 %1 条记录").arg(deletedCount));
+            });
+
+            // 重置全选状态
+            isAllSelected = false;
+            updateSelectAllButtonText();
+
+            // 清除选中状态
+            clearSelection();
+        } else {
+            statusBar->showMessage("已取消删除");
+        }
+    } else {
+        // 单个删除模式
+        QItemSelectionModel *selectionModel = tableView->selectionModel();
+        if (!selectionModel || !selectionModel->hasSelection()) {
+            QMessageBox::warning(this, "警告", "请先选择一条记录");
+            return;
+        }
+
+        QModelIndexList selectedIndexes = selectionModel->selectedRows();
+        if (selectedIndexes.isEmpty()) {
+            QMessageBox::warning(this, "警告", "请先选择一条记录");
+            return;
+        }
+
+        int row = selectedIndexes.first().row();
+
+        // 从第0列获取ID
+        QStandardItem* idItem = model->item(row, 0);
+        if (!idItem) {
+            statusBar->showMessage("获取记录ID失败");
+            return;
+        }
+
+        int id = idItem->data(Qt::UserRole + 1).toInt();
+        QString website = model->item(row, 1)->text();
+        QString username = model->item(row, 2)->text();
+
+        QMessageBox::StandardButton reply;
+        reply = QMessageBox::question(this, "确认删除",
+                                      QString("确定要删除 '%1' 用户 '%2' 的密码记录吗?").arg(website).arg(username),
+                                      QMessageBox::Yes | QMessageBox::No);
+
+        if (reply == QMessageBox::Yes) {
+            AsyncDatabase::onFinished(asyncDb->deletePassword(id), this, [this](bool ok) {
+                if (ok) {
+                    loadPasswords();  // 重新加载数据
+                    statusBar->showMessage("密码删除成功");
+                } else {
+                    statusBar->showMessage("密码删除失败");
+                }
+            });
+        } else {
+            statusBar->showMessage("已取消删除");
+        }
+    }
+}
+
+void MainWindow::moveSelectedPasswords()
+{
+    transferSelectedPasswords(false);
+}
+
+void MainWindow::copySelectedPasswords()
+{
+    transferSelectedPasswords(true);
+}
+
+void MainWindow::transferSelectedPasswords(bool copy)
+{
+    if (!multiSelectMode || !checkWritesAllowed()) {
+        return;
+    }
+
+    const QString action = copy ? "复制" : "移动";
+    QList<int> selectedIds = model->checkedIds();
+    if (selectedIds.isEmpty()) {
+        QMessageBox::warning(this, "警告", QString("请先选择要%1的记录").arg(action));
+        return;
+    }
+
+    // 选择目标表单
+    auto forms = Database::instance().getAllForms();
+    QStringList formNames;
+    for (const auto &form : forms) {
+        formNames.append(form.name);
+    }
+    bool ok;
+    QString targetName = QInputDialog::getItem(this, QString("%1到表单").arg(action),
+                                               QString("将选中的 %1 条记录%2到:").arg(selectedIds.size()).arg(action),
+                                               formNames, formNames.indexOf(formTabWidget->currentFormName()),
+                                               false, &ok);
+    if (!ok || targetName.isEmpty()) {
+        statusBar->showMessage(QString("已取消%1").arg(action));
+        return;
+    }
+    int targetFormId = forms[formNames.indexOf(targetName)].id;
+
+    // 目标表单中已有相同网站、用户名和账号的记录时如何处理
+    QMessageBox box(QMessageBox::Question, QString("%1到表单").arg(action),
+                    QString("如果表单 '%1' 中已有相同网站、用户名和账号的记录：").arg(targetName),
+                    QMessageBox::NoButton, this);
+    QPushButton *skipButton = box.addButton("跳过这些记录", QMessageBox::AcceptRole);
+    QPushButton *replaceButton = box.addButton("覆盖已有记录", QMessageBox::DestructiveRole);
+    box.addButton("取消", QMessageBox::RejectRole);
+    box.exec();
+    if (box.clickedButton() != skipButton && box.clickedButton() != replaceButton) {
+        statusBar->showMessage(QString("已取消%1").arg(action));
+        return;
+    }
+    Database::ConflictPolicy policy = box.clickedButton() == replaceButton ? Database::ReplaceConflicts
+                                                                             : Database::SkipConflicts;
+
+    // 整批在数据库中用一条语句完成
+    auto transferred = asyncDb->transferPasswords(selectedIds, targetFormId, policy, copy);
+    AsyncDatabase::onFinished(transferred, this,
+                              [this, action, targetName, policy](const AsyncDatabase::TransferResult &result) {
+        if (result.count < 0) {
+            showMessageLater(QMessageBox::Warning, "失败", QString("批量%1失败，没有记录被修改").arg(action));
+            return;
+        }
+
+        loadPasswords();
+        QString message = QString("已%1 %2 条记录到表单 '%3'").arg(action).arg(result.count).arg(targetName);
+        if (result.conflictCount > 0) {
+            message += policy == Database::ReplaceConflicts ? QString("，覆盖了 %1 条已有记录").arg(result.conflictCount)
+                                                            : QString("，跳过 %1 条重复记录").arg(result.conflictCount);
+        }
+        statusBar->showMessage(message);
+    });
+}
+
+void MainWindow::searchPasswords()
+{
+    QString keyword = searchEdit->text().trimmed();
+    qDebug() << "开始搜索，关键词:" << keyword << "选择的表单数量:" << selectedFormIdsForSearch.size();
+
+    // 停止当前表单的分批加载；连续搜索时只显示最后一次的结果，之前未完成的搜索被取消
+    passwordLoadTimer->stop();
+    asyncDb->cancel(AsyncDatabase::PageRead);
+    prefetcher->cancel();
+    int generation = ++viewGeneration;
+    int formCount = selectedFormIdsForSearch.size();
+    statusBar->showMessage("正在搜索...");
+
+    // 使用选中的表单ID列表进行搜索
+    auto found = asyncDb->searchPasswords(keyword, selectedFormIdsForSearch);
+    AsyncDatabase::onFinished(found, this, [this, generation, formCount](const QList<PasswordEntry> &results) {
+        if (generation != viewGeneration) {
+            return;
+        }
+        qDebug() << "搜索到记录数量:" << results.size();
+
+        // 断开之前的连接，避免重复连接
+        disconnect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+
+        model->removeRows(0, model->rowCount());
+
+        for (const auto &pwd : results) {
+            model->appendRow(createPasswordRow(pwd, Encryption::decrypt(pwd.account), Encryption::decrypt(pwd.password)));
+        }
+
+        // 重置全选状态
+        isAllSelected = false;
+        updateSelectAllButtonText();
+
+        // 重新连接复选框状态改变信号
+        connect(model, &PasswordTableModel::checkedCountChanged, this, &MainWindow::onCheckboxStateChanged);
+
+        // 清除选中状态
+        clearSelection();
+
+        statusBar->showMessage(QString("在 %1 个表单中找到 %2 条匹配记录").arg(formCount).arg(results.size()));
+    });
+}
+
+void MainWindow::exportPasswords()
+{
+    if (operationInProgress) {
+        QMessageBox::warning(this, "警告", "当前有操作正在进行，请等待完成");
+        return;
+    }
+
+    // 第一步：弹出对话框让用户选择导出类型
+    QDialog exportTypeDialog(this);
+    exportTypeDialog.setWindowTitle("选择导出类型");
+    exportTypeDialog.resize(300, 150);
+
+    QVBoxLayout *dialogLayout = new QVBoxLayout(&exportTypeDialog);
+
+    QGroupBox *groupBox = new QGroupBox("请选择导出版本:");
+    QVBoxLayout *groupLayout = new QVBoxLayout(groupBox);
+
+    QRadioButton *unencryptedButton = new QRadioButton("未保密版（密码以明文显示）");
+    QRadioButton *encryptedButton = new QRadioButton(EncryptedStream::isSupported()
+                                                         ? "保密版（用口令加密整个导出文件）"
+                                                         : "保密版（密码以加密形式显示）");
+
+    // 默认选中未保密版
+    unencryptedButton->setChecked(true);
+
+    groupLayout->addWidget(unencryptedButton);
+    groupLayout->addWidget(encryptedButton);
+    groupBox->setLayout(groupLayout);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+
+    dialogLayout->addWidget(groupBox);
+    dialogLayout->addWidget(buttonBox);
+    exportTypeDialog.setLayout(dialogLayout);
+
+    connect(buttonBox, &QDialogButtonBox::accepted, &exportTypeDialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &exportTypeDialog, &QDialog::reject);
+
+    if (exportTypeDialog.exec() != QDialog::Accepted) {
+        statusBar->showMessage("已取消导出");
+        return;
+    }
+
+    // 确定用户选择的导出类型
+    bool exportEncrypted = encryptedButton->isChecked();
+
+    // 保密版在支持时导出为加密文件，需要设置口令
+    QString passphrase;
+    bool useArchive = exportEncrypted && EncryptedStream::isSupported();
+    if (useArchive && !askPassphrase(true, passphrase)) {
+        statusBar->showMessage("已取消导出");
+        return;
+    }
+
+    // 第二步：选择保存文件位置
+    QString fileName = useArchive
+                           ? QFileDialog::getSaveFileName(this, "导出密码",
+                                                          "passwords_backup.pmenc",
+                                                          "加密导出文件 (*.pmenc);;加密JSON Lines (*.jsonl.pmenc)")
+                           : QFileDialog::getSaveFileName(this, "导出密码",
+                                                          "passwords_backup.csv",
+                                                          "CSV文件 (*.csv);;gzip压缩CSV (*.csv.gz);;zstd压缩CSV (*.csv.zst);;"
+                                                          "JSON Lines (*.jsonl);;gzip压缩JSON Lines (*.jsonl.gz);;"
+                                                          "zstd压缩JSON Lines (*.jsonl.zst)");
+    if (fileName.isEmpty()) {
+        statusBar->showMessage("已取消导出");
+        return;
+    }
+
+    if (multiSelectMode) {
+        // 主线程只收集选中记录的ID，读取、解密和写文件都交给工作线程
+        QList<int> selectedIds = model->checkedIds();
+
+        if (selectedIds.isEmpty()) {
+            QMessageBox::warning(this, "警告", "没有选中任何记录，将导出当前表单全部记录");
+            startExportOperation(fileName, exportEncrypted, passphrase);
+        } else {
+            startExportSelectedOperation(fileName, selectedIds, exportEncrypted, passphrase);
+        }
+    } else {
+        startExportOperation(fileName, exportEncrypted, passphrase);
+    }
+}
+
+void MainWindow::importPasswords()
+{
+    if (operationInProgress) {
+        QMessageBox::warning(this, "警告", "当前有操作正在进行，请等待完成");
+        return;
+    }
+
+    QString fileName = QFileDialog::getOpenFileName(this, "导入密码",
+                                                    "", "CSV文件 (*.csv *.csv.gz *.csv.zst);;JSON Lines (*.jsonl *.jsonl.gz *.jsonl.zst);;"
+                                                    "加密导出文件 (*.pmenc);;KeePass XML (*.xml *.xml.gz);;"
+                                                    "Bitwarden JSON (*.json *.json.gz)");
+    if (fileName.isEmpty()) {
+        statusBar->showMessage("已取消导入");
+        return;
+    }
+
+    // 加密导出文件需要输入导出时设置的口令
+    QString passphrase;
+    if (EncryptedStream::isEncryptedArchive(fileName)) {
+        if (!EncryptedStream::isSupported()) {
+            QMessageBox::warning(this, "警告", "当前版本未启用加密导出支持，无法导入加密文件");
+            return;
+        }
+        if (!askPassphrase(false, passphrase)) {
+            statusBar->showMessage("已取消导入");
+            return;
+        }
+    }
+
+    QMessageBox::StandardButton reply;
+    reply = QMessageBox::question(this, "确认导入",
+                                  "导入将添加新记录，重复记录不会覆盖。确定要继续吗?",
+                                  QMessageBox::Yes | QMessageBox::No);
+
+    if (reply == QMessageBox::Yes) {
+        startImportOperation(fileName, passphrase);
+    } else {
+        statusBar->showMessage("已取消导入");
+    }
+}
+
+void MainWindow::backupVault()
+{
+    if (operationInProgress) {
+        QMessageBox::warning(this, "警告", "当前有操作正在进行，请等待完成");
+        return;
+    }
+
+    if (!Database::instance().isPersistent()) {
+        QMessageBox::information(this, "提示", "内存密码库没有数据库文件，请使用导出功能保存数据");
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, "备份密码库",
+                                                    "passwords_backup.pmvault",
+                                                    "密码库备份 (*.pmvault)");
+    if (fileName.isEmpty()) {
+        statusBar->showMessage("已取消备份");
+        return;
+    }
+
+    startBackupOperation(fileName, ImportExportWorker::BackupOperation);
+}
+
+void MainWindow::restoreVault()
+{
+    if (operationInProgress) {
+        QMessageBox::warning(this, "警告", "当前有操作正在进行，请等待完成");
+        return;
+    }
+
+    if (!Database::instance().isPersistent()) {
+        QMessageBox::information(this, "提示", "内存密码库没有数据库文件，请使用导出功能保存数据");
+        return;
+    }
+
+    QString fileName = QFileDialog::getOpenFileName(this, "从备份恢复",
+                                                    "", "密码库备份 (*.pmvault)");
+    if (fileName.isEmpty()) {
+        statusBar->showMessage("已取消恢复");
+        return;
+    }
+
+    QMessageBox::StandardButton reply;
+    reply = QMessageBox::question(this, "确认恢复",
+                                  "恢复将用备份中的数据替换当前所有表单和密码记录，此操作不可撤销。确定要继续吗?",
+                                  QMessageBox::Yes | QMessageBox::No);
+
+    if (reply == QMessageBox::Yes) {
+        startBackupOperation(fileName, ImportExportWorker::RestoreOperation);
+    } else {
+        statusBar->showMessage("已取消恢复");
+    }
+}
+
+void MainWindow::snapshotDatabase()
+{
+    if (operationInProgress) {
+        QMessageBox::warning(this, "警告", "当前有操作正在进行，请等待完成");
+        return;
+    }
+
+    if (!Database::instance().isPersistent()) {
+        QMessageBox::information(this, "提示", "内存密码库没有数据库文件，请使用导出功能保存数据");
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, "数据库热备份",
+                                                    "passwords_snapshot.db",
+                                                    "SQLite数据库 (*.db)");
+    if (fileName.isEmpty()) {
+        statusBar->showMessage("已取消备份");
+        return;
+    }
+
+    startBackupOperation(fileName, ImportExportWorker::SnapshotOperation);
+}
+
+// 输入加密导出文件的口令，confirm为true时要求输入两次
+bool MainWindow::askPassphrase(bool confirm, QString &passphrase)
+{
+    bool ok;
+    passphrase = QInputDialog::getText(this, "加密导出文件", "口令:", QLineEdit::Password, "", &ok);
+    if (!ok) {
+        return false;
+    }
+    if (passphrase.isEmpty()) {
+        QMessageBox::warning(this, "警告", "口令不能为空");
+        return false;
+    }
+
+    if (confirm) {
+        QString again = QInputDialog::getText(this, "加密导出文件", "再次输入口令:", QLineEdit::Password, "", &ok);
+        if (!ok) {
+            return false;
+        }
+        if (again != passphrase) {
+            QMessageBox::warning(this, "警告", "两次输入的口令不一致");
+            return false;
+        }
+    }
+    return true;
+}
+
+void MainWindow::startImportOperation(const QString &filename, const QString &passphrase)
+{
+    qDebug() << "开始导入操作，文件:" << filename << "当前表单ID:" << currentFormId;
+
+    reloadFormsOnFinish = true;  // JSON Lines导入可能按记录中的表单名称新建表单
+
+    ImportExportWorker *importWorker = new ImportExportWorker();
+    importWorker->setOperationType(ImportExportWorker::ImportOperation);
+    importWorker->setFilename(filename);
+    importWorker->setFormId(currentFormId);  // 导入到当前表单
+    importWorker->setPassphrase(passphrase);
+    startWorkerOperation(importWorker, "导入数据", "正在导入数据，请稍候...");
+}
+
+void MainWindow::startExportOperation(const QString &filename, bool exportEncrypted, const QString &passphrase)
+{
+    qDebug() << "开始导出操作，文件:" << filename << "导出类型:" << exportEncrypted << "当前表单ID:" << currentFormId;
+
+    ImportExportWorker *exportWorker = new ImportExportWorker();
+    exportWorker->setOperationType(ImportExportWorker::ExportOperation);
+    exportWorker->setFilename(filename);
+    exportWorker->setExportEncrypted(exportEncrypted);  // 设置导出类型
+    exportWorker->setPassphrase(passphrase);  // 非空时导出为加密文件
+    exportWorker->setFormId(currentFormId);  // 导出当前表单
+
+    QString exportType = exportEncrypted ? "保密版" : "未保密版";
+    startWorkerOperation(exportWorker, QString("导出数据 (%1)").arg(exportType),
+                         QString("正在导出数据(%1)，请稍候...").arg(exportType));
+}
+
+void MainWindow::startExportSelectedOperation(const QString &filename, const QList<int> &selectedIds, bool exportEncrypted,
+                                              const QString &passphrase)
+{
+    qDebug() << "开始导出选中记录操作，文件:" << filename << "导出类型:" << exportEncrypted
+             << "选中记录数:" << selectedIds.size() << "当前表单ID:" << currentFormId;
+
+    ImportExportWorker *exportWorker = new ImportExportWorker();
+    exportWorker->setOperationType(ImportExportWorker::ExportSelectedOperation);
+    exportWorker->setFilename(filename);
+    exportWorker->setSelectedIds(selectedIds);
+    exportWorker->setExportEncrypted(exportEncrypted);  // 设置导出类型
+    exportWorker->setPassphrase(passphrase);  // 非空时导出为加密文件
+    exportWorker->setFormId(currentFormId);  // 导出当前表单
+
+    QString exportType = exportEncrypted ? "保密版" : "未保密版";
+    startWorkerOperation(exportWorker, QString("导出选中的数据 (%1)").arg(exportType),
+                         QString("正在导出选中的数据(%1)，请稍候...").arg(exportType));
+}
+
+void MainWindow::startBackupOperation(const QString &filename, ImportExportWorker::OperationType operationType)
+{
+    bool restore = (operationType == ImportExportWorker::RestoreOperation);
+    qDebug() << "开始备份/恢复操作，类型:" << operationType << "文件:" << filename;
+
+    reloadFormsOnFinish = restore;
+
+    ImportExportWorker *backupWorker = new ImportExportWorker();
+    backupWorker->setOperationType(operationType);
+    backupWorker->setFilename(filename);
+
+    if (operationType == ImportExportWorker::SnapshotOperation) {
+        startWorkerOperation(backupWorker, "数据库热备份", "正在生成数据库快照，可以继续使用程序...");
+    } else {
+        startWorkerOperation(backupWorker, restore ? "从备份恢复" : "备份密码库",
+                             restore ? "正在恢复数据，请稍候..." : "正在备份数据，请稍候...");
+    }
+}
+
+// 在新的工作线程中执行已经设置好的操作，显示进度对话框，完成后由onOperationFinished/onOperationError清理
+void MainWindow::startWorkerOperation(ImportExportWorker *configuredWorker, const QString &title, const QString &label)
+{
+    operationInProgress = true;
+    // 导入和恢复在一个事务中写完整个文件，备份在一个读事务中完成，期间界面的修改只会等到忙等待超时后失败
+    ImportExportWorker::OperationType type = configuredWorker->operationType();
+    writesBlocked = type == ImportExportWorker::ImportOperation || type == ImportExportWorker::RestoreOperation
+                    || type == ImportExportWorker::BackupOperation;
+    prefetcher->cancel();
+
+    // 禁用相关按钮
+    importButton->setEnabled(false);
+    exportButton->setEnabled(false);
+
+    // 创建进度对话框（如果需要）
+    if (!progressDialog) {
+        createProgressDialog();
+    }
+
+    // 创建线程，工作器移到线程中
+    workerThread = new QThread(this);
+    worker = configuredWorker;
+    worker->moveToThread(workerThread);
+
+    // 连接信号
+    bool importing = worker->operationType() == ImportExportWorker::ImportOperation;
+    connect(workerThread, &QThread::started, worker, &ImportExportWorker::startOperation);
+    connect(worker, &ImportExportWorker::progressChanged, this,
+            importing ? &MainWindow::onImportProgress : &MainWindow::onExportProgress);
+    connect(worker, &ImportExportWorker::operationFinished, this, &MainWindow::onOperationFinished);
+    connect(worker, &ImportExportWorker::errorOccurred, this, &MainWindow::onOperationError);
+    connect(workerThread, &QThread::finished, worker, &ImportExportWorker::deleteLater);
+    connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
+
+    // 启动线程
+    workerThread->start();
+
+    // 显示进度对话框
+    progressDialog->setWindowTitle(title);
+    progressDialog->setLabelText(label);
+    progressDialog->show();
+}
+
+void MainWindow::onImportProgress(int percent, const QString &message)
+{
+    if (progressDialog) {
+        progressDialog->setValue(percent);
+        progressDialog->setLabelText(message);
+    }
+    statusBar->showMessage(message);
+}
+
+void MainWindow::onExportProgress(int percent, const QString &message)
+{
+    if (progressDialog) {
+        progressDialog->setValue(percent);
+        progressDialog->setLabelText(message);
+    }
+    statusBar->showMessage(message);
+}
+
+void MainWindow::onOperationFinished(bool success, const QString &message)
+{
+    qDebug() << "操作完成，成功:" << success << "消息:" << message;
+
+    operationInProgress = false;
+    writesBlocked = false;
+
+    // 启用按钮
+    importButton->setEnabled(true);
+    exportButton->setEnabled(true);
+
+    // 关闭进度对话框
+    if (progressDialog) {
+        progressDialog->reset();
+        progressDialog->hide();
+    }
+
+    bool reloadForms = reloadFormsOnFinish;
+    reloadFormsOnFinish = false;
+
+    // 恢复备份后表单可能完全不同，导入可能新建了表单，当前表单不存在时回到第一个表单
+    if (reloadForms && (success || message == "操作已取消")) {
+        if (Database::instance().getFormById(currentFormId).id != currentFormId) {
+            currentFormId = -1;
+        }
+        loadForms();
+    }
+
+    if (success) {
+        // 重新加载数据
+        loadPasswords();
+
+        QMessageBox::information(this, "成功", message);
+        statusBar->showMessage(message);
+    } else if (message == "操作已取消") {
+        // 导入取消时已提交的部分需要刷新显示
+        loadPasswords();
+        statusBar->showMessage(message);
+        QMessageBox::information(this, "提示", message);
+    } else {
+        QMessageBox::warning(this, "失败", message);
+        statusBar->showMessage("操作失败");
+    }
+
+    // 清理线程
+    if (workerThread) {
+        workerThread->quit();
+        workerThread->wait();
+        delete workerThread;
+        workerThread = nullptr;
+        worker = nullptr;
+    }
+}
+
+void MainWindow::onOperationError(const QString &error)
+{
+    qDebug() << "操作错误:" << error;
+
+    operationInProgress = false;
+    writesBlocked = false;
+    reloadFormsOnFinish = false;
+
+    // 启用按钮
+    importButton->setEnabled(true);
+    exportButton->setEnabled(true);
+
+    // 关闭进度对话框
+    if (progressDialog) {
+        progressDialog->reset();
+        progressDialog->hide();
+    }
+
+    QMessageBox::critical(this, "错误", error);
+    statusBar->showMessage("操作出错");
+
+    // 清理线程
+    if (workerThread) {
+        workerThread->quit();
+        workerThread->wait();
+        delete workerThread;
+        workerThread = nullptr;
+        worker = nullptr;
+    }
+}
+
+void MainWindow::cancelOperation()
+{
+    if (operationInProgress && workerThread && workerThread->isRunning()) {
+        QMessageBox::StandardButton reply;
+        reply = QMessageBox::question(this, "确认取消",
+                                      "确定要取消当前操作吗？",
+                                      QMessageBox::Yes | QMessageBox::No);
+
+        if (reply == QMessageBox::Yes) {
+            // 通知工作线程停止，不再强制终止线程（terminate可能留下未提交的事务和半写的文件）
+            // 工作线程退出后会通过operationFinished通知主线程清理
+            if (worker) {
+                worker->requestCancel();
+            }
+
+            if (progressDialog) {
+                progressDialog->setLabelText("正在取消...");
+            }
+            statusBar->showMessage("正在取消...");
+        } else {
+            // 重新显示进度对话框
+            if (progressDialog) {
+                progressDialog->show();
+            }
+        }
+    }
+}
+
+void MainWindow::testDatabase()
+{
+    if (Database::instance().init()) {
+        QMessageBox::information(this, "数据库测试", "数据库连接成功！");
+        statusBar->showMessage("数据库连接正常");
+
+        // 测试是否可以获取表单
+        auto forms = Database::instance().getAllForms();
+        qDebug() << "数据库测试: 表单数量:" << forms.size();
+        QMessageBox::information(this, "数据库测试",
+                                 QString("数据库连接成功！\n表单数量: %1").arg(forms.size()));
+    } else {
+        QMessageBox::warning(this, "数据库测试", "数据库连接失败！");
+        statusBar->showMessage("数据库连接失败");
+    }
+}
+
+void MainWindow::showAbout()
+{
+    QMessageBox::about(this, "关于密码管理器",
+                       "个人密码管理器 v2.0（表单增强版）\n\n"
+                       "基于Qt开发的密码管理工具\n"
+                       "新增功能：\n"
+                       "  • 表单管理：可创建多个表单组织密码\n"
+                       "  • 表单切换：类似WPS的标签页界面\n"
+                       "  • 表单搜索：可选择在特定表单中搜索\n"
+                       "  • 表单操作：添加、删除、重命名表单\n"
+                       "  • 增加账号字段（6-20位）\n"
+                       "  • 账号和密码格式验证\n"
+                       "  • 账号加密存储\n"
+                       "  • 多线程导入导出\n"
+                       "  • 操作进度显示\n"
+                       "  • 支持取消长时间操作\n"
+                       "  • 批量操作优化\n"
+                       "  • 导出保密版/未保密版选择\n"
+                       "  • 密码加密存储与导出\n\n"
+                       "课程设计项目 - Qt应用程序开发");
+}
+
+// 表单相关槽函数
+void MainWindow::onFormAdded(int id, const QString &name)
+{
+    qDebug() << "表单添加请求，ID:" << id << "名称:" << name;
+
+    if (id == -1 && checkWritesAllowed()) {
+        // 新表单，需要创建
+        AsyncDatabase::onFinished(asyncDb->addForm(name), this, [this, name](const FormEntry &form) {
+            if (form.id < 0) {
+                showMessageLater(QMessageBox::Warning, "失败", "表单添加失败");
+                return;
+            }
+
+            // 只添加新表单的标签，切换到新标签时由onCurrentFormChanged加载记录
+            formTabWidget->addForm(form.id, form.name, true);
+            if (formTabWidget->selectedFormIds().isEmpty()) {
+                selectedFormIdsForSearch = formTabWidget->allFormIds();  // 未选择表单时在所有表单中搜索
+            }
+            statusBar->showMessage(QString("表单 '%1' 添加成功").arg(name));
+            showMessageLater(QMessageBox::Information, "成功", QString("表单 '%1' 添加成功").arg(name));
+        });
+    }
+}
+
+void MainWindow::onFormRemoved(int id)
+{
+    qDebug() << "表单删除请求，ID:" << id;
+    if (!checkWritesAllowed()) {
+        return;
+    }
+
+    AsyncDatabase::onFinished(asyncDb->deleteForm(id), this, [this, id](bool ok) {
+        if (!ok) {
+            showMessageLater(QMessageBox::Warning, "失败", "表单删除失败");
+            return;
+        }
+
+        // 只移除对应的标签；删除的是当前表单时标签栏会切换到相邻表单并发出currentFormChanged
+        prefetcher->clear();
+        formTabWidget->removeForm(id);
+        if (currentFormId == id) {
+            currentFormId = formTabWidget->currentFormId();
+            loadPasswords();
+        }
+        statusBar->showMessage("表单删除成功");
+        showMessageLater(QMessageBox::Information, "成功", "表单删除成功");
+    });
+}
+
+void MainWindow::onFormRenamed(int id, const QString &newName)
+{
+    qDebug() << "表单重命名请求，ID:" << id << "新名称:" << newName;
+    if (!checkWritesAllowed()) {
+        return;
+    }
+
+    AsyncDatabase::onFinished(asyncDb->updateForm(id, newName), this, [this, id, newName](bool ok) {
+        if (ok) {
+            formTabWidget->updateForm(id, newName);
+            statusBar->showMessage(QString("表单重命名为 '%1'").arg(newName));
+        } else {
+            showMessageLater(QMessageBox::Warning, "失败", "表单重命名失败");
+        }
+    });
+}
+
+void MainWindow::onCurrentFormChanged(int id)
+{
+    qDebug() << "当前表单改变，新ID:" << id;
+
+    currentFormId = id;
+    prefetcher->recordOpen(id);
+    loadCurrentForm();  // 切换标签不修改数据，可以使用预读的结果
+}
+
+void MainWindow::onFormSelectionChanged(const QList<int> &selectedIds)
+{
+    selectedFormIdsForSearch = selectedIds;
+    if (selectedIds.isEmpty()) {
+        statusBar->showMessage("未选择任何表单，将在所有表单中搜索");
+        selectedFormIdsForSearch = formTabWidget->allFormIds();
+    } else {
+        statusBar->showMessage(QString("已选择 %1 个表单进行搜索").arg(selectedIds.size()));
+    }
+}
+
+void MainWindow::onSelectFormsClicked()
+{
+    // 表单名称来自缓存，记录数在数据库线程上读取后再显示对话框
+    AsyncDatabase::onFinished(asyncDb->getFormStats(), this, [this](const QHash<int, FormStats> &stats) {
+        auto forms = Database::instance().getAllForms();
+        QList<int> formIds;
+        QList<QString> formNames;
+
+        for (const auto &form : forms) {
+            formIds.append(form.id);
+            if (stats.contains(form.id)) {
+                formNames.append(QString("%1 (%2)").arg(form.name).arg(stats.value(form.id).entryCount));
+            } else {
+                formNames.append(form.name);
+            }
+        }
+
+        // 对话框的嵌套事件循环不能在QFutureWatcher的信号处理中运行，排队到之后的事件循环再显示
+        QMetaObject::invokeMethod(this, [this, formIds, formNames]() {
+            FormSelectDialog dialog(formIds, formNames, selectedFormIdsForSearch, this);
+            if (dialog.exec() == QDialog::Accepted) {
+                QList<int> selectedIds = dialog.selectedFormIds();
+                formTabWidget->setSelectedForms(selectedIds);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
@@ -1,115 +1,159 @@
-#ifndef MAINWINDOW_H
-#define MAINWINDOW_H
-
-#include <QMainWindow>
-#include <QStandardItemModel>
-#include <QTableView>
-#include <QLineEdit>
-#include <QPushButton>
-#include <QStatusBar>
-#include <QMenuBar>
-#include <QInputDialog>
-#include <QMessageBox>
-#include <QFileDialog>
-#include <QVBoxLayout>
-#include <QHBoxLayout>
-#include <QHeaderView>
-#include <QCheckBox>
-#include <QThread>
-#include <QToolButton>
-
-// 前向声明
-class ImportExportWorker;
-class FormTabWidget;
-class FormSelectDialog;
-class QProgressDialog;
-
-class MainWindow : public QMainWindow
-{
-    Q_OBJECT
-
-public:
-    MainWindow(QWidget *parent = nullptr);
-    ~MainWindow();
-
-private slots:
-    void addPassword();
-    void editPassword();
-    void deletePassword();
-    void searchPasswords();
-    void exportPasswords();
-    void importPasswords();
-    void showAbout();
-    void testDatabase();
-    void toggleMultiSelectMode();
-    void selectAll();
-    void onCheckboxStateChanged();
-    void onTableViewClicked(const QModelIndex &index);
-    void onItemDoubleClicked(const QModelIndex &index);
-
-    // 表单相关槽函数
-    void onFormAdded(int id, const QString &name);
-    void onFormRemoved(int id);
-    void onFormRenamed(int id, const QString &newName);
-    void onCurrentFormChanged(int id);
-    void onFormSelectionChanged(const QList<int> &selectedIds);
-    void onSelectFormsClicked();
-
-    // 多线程操作槽函数
-    void onImportProgress(int percent, const QString &message);
-    void onExportProgress(int percent, const QString &message);
-    void onOperationFinished(bool success, const QString &message);
-    void onOperationError(const QString &error);
-    void cancelOperation();
-
-private:
-    void setupUI();
-    void loadForms();
-    void loadPasswords();
-    void setupTable();
-    bool exportSelectedPasswords(const QString &filename);
-    void updateButtonStates();
-    void clearSelection();
-    void editSelectedRow(int row);
-    bool editField(int row, int column);
-    void updateSelectAllButtonText();
-    void clearAllCheckboxes();
-    void createProgressDialog();
-
-    // 多线程操作方法
-    void startImportOperation(const QString &filename);
-    void startExportOperation(const QString &filename, bool exportEncrypted);
-    void startExportSelectedOperation(const QString &filename, const QList<int> &selectedRows, bool exportEncrypted);
-
-    QStandardItemModel *model;
-    QTableView *tableView;
-    QLineEdit *searchEdit;
-    QPushButton *addButton, *editButton, *deleteButton, *searchButton;
-    QPushButton *exportButton, *importButton, *testButton;
-    QPushButton *showPasswordButton;
-    QPushButton *multiSelectButton;
-    QPushButton *selectAllButton;
-    QToolButton *selectFormsButton;  // 新增：选择表单按钮
-
-    // 表单标签栏
-    FormTabWidget *formTabWidget;
-
-    QMenuBar *menuBar;
-    QStatusBar *statusBar;
-
-    // 多线程相关成员
-    QProgressDialog *progressDialog;
-    QThread *workerThread;
-    ImportExportWorker *worker;
-    bool operationInProgress;
-
-    bool multiSelectMode;
-    int lastSelectedRow;
-    bool isAllSelected;
-
-    // 当前选中的表单ID列表（用于搜索）
-    QList<int> selectedFormIdsForSearch;
-    int currentFormId;  // 当前激活的表单ID
-};
-
-#endif // MAINWINDOW_H
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include <QStandardItemModel>
+#include <QTableView>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QStatusBar>
+#include <QMenuBar>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QFileDialog>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QCheckBox>
+#include <QThread>
+#include <QToolButton>
+#include "formprefetcher.h"
+#include "importexportworker.h"
+
+// 前向声明
+class FormTabWidget;
+class FormSelectDialog;
+class QProgressDialog;
+class QTimer;
+class PasswordTableModel;
+class AsyncDatabase;
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+
+private slots:
+    void addPassword();
+    void editPassword();
+    void deletePassword();
+    void searchPasswords();
+    void exportPasswords();
+    void importPasswords();
+    void backupVault();
+    void restoreVault();
+    void snapshotDatabase();
+    void showAbout();
+    void testDatabase();
+    void toggleMultiSelectMode();
+    void selectAll();
+    void moveSelectedPasswords();
+    void copySelectedPasswords();
+    void onCheckboxStateChanged();
+    void onTableViewClicked(const QModelIndex &index);
+    void onItemDoubleClicked(const QModelIndex &index);
+
+    // 表单相关槽函数
+    void onFormAdded(int id, const QString &name);
+    void onFormRemoved(int id);
+    void onFormRenamed(int id, const QString &newName);
+    void onCurrentFormChanged(int id);
+    void onFormSelectionChanged(const QList<int> &selectedIds);
+    void onSelectFormsClicked();
+
+    // 多线程操作槽函数
+    void onImportProgress(int percent, const QString &message);
+    void onExportProgress(int percent, const QString &message);
+    void onOperationFinished(bool success, const QString &message);
+    void onOperationError(const QString &error);
+    void cancelOperation();
+
+private:
+    void setupUI();
+    void loadForms();
+    void loadPasswords();    // 数据被修改后重新加载（清空预读缓存）
+    void loadCurrentForm();  // 显示当前表单，有预读结果时直接使用
+    void loadNextPasswordPage();
+    void finishPasswordPage(int firstNewRow, int pageCount, bool hasMore);
+    void schedulePrefetch();
+    QList<QStandardItem*> createPasswordRow(const PasswordEntry &pwd, const QString &account, const QString &password);
+    void updateFormCounts();
+    void setupTable();
+    void updateButtonStates();
+    void clearSelection();
+    void editSelectedRow(int row);
+    void editField(int row, int column);
+    int rowForId(int id) const;  // 记录当前所在的行，不在表格中返回-1
+    // 在之后的事件循环中显示提示框，用于AsyncDatabase::onFinished的回调（其中不能运行嵌套事件循环）
+    void showMessageLater(QMessageBox::Icon icon, const QString &title, const QString &text);
+    bool checkWritesAllowed();  // 不能修改时提示并返回false
+    void updateSelectAllButtonText();
+    void clearAllCheckboxes();
+    void createProgressDialog();
+    void transferSelectedPasswords(bool copy);
+
+    // 多线程操作方法
+    void startImportOperation(const QString &filename, const QString &passphrase = QString());
+    void startExportOperation(const QString &filename, bool exportEncrypted, const QString &passphrase = QString());
+    void startExportSelectedOperation(const QString &filename, const QList<int> &selectedIds, bool exportEncrypted,
+                                      const QString &passphrase = QString());
+    bool askPassphrase(bool confirm, QString &passphrase);
+    void startBackupOperation(const QString &filename, ImportExportWorker::OperationType operationType);
+    void startWorkerOperation(ImportExportWorker *configuredWorker, const QString &title, const QString &label);
+
+    PasswordTableModel *model;
+    QTableView *tableView;
+    QLineEdit *searchEdit;
+    QPushButton *addButton, *editButton, *deleteButton, *searchButton;
+    QPushButton *exportButton, *importButton, *testButton;
+    QPushButton *showPasswordButton;
+    QPushButton *multiSelectButton;
+    QPushButton *selectAllButton;
+    QPushButton *moveButton, *copyButton;
+    QToolButton *selectFormsButton;  // 新增：选择表单按钮
+
+    // 表单标签栏
+    FormTabWidget *formTabWidget;
+
+    QMenuBar *menuBar;
+    QStatusBar *statusBar;
+
+    // 多线程相关成员
+    QProgressDialog *progressDialog;
+    QThread *workerThread;
+    ImportExportWorker *worker;
+    bool operationInProgress;
+    bool writesBlocked;  // 导入、恢复或备份期间工作线程长时间持有数据库锁，界面不提交修改
+    bool reloadFormsOnFinish;  // 操作完成后需要重新加载表单（例如从备份恢复）
+
+    bool multiSelectMode;
+    int lastSelectedRow;
+    bool isAllSelected;
+
+    // 当前选中的表单ID列表（用于搜索）
+    QList<int> selectedFormIdsForSearch;
+    int currentFormId;  // 当前激活的表单ID
+
+    // 当前表单的记录分批加载，每批之间回到事件循环
+    static const int PASSWORD_PAGE_SIZE = 500;
+    QTimer *passwordLoadTimer;
+    int loadingFormId;
+    int loadedAfterId;  // 已加载的最大记录ID
+    int loadedCount;
+    FormPrefetcher::PrefetchedForm prefetchedForm;  // 正在显示的预读结果
+    bool usingPrefetched;
+    int viewGeneration;  // 每次切换表单或搜索加一，之前请求的结果不再显示
+
+    // 记录和表单的读写在数据库线程上执行，界面线程不等待SQLite
+    AsyncDatabase *asyncDb;
+
+    // 后台预读相邻和常用表单
+    static const int PREFETCH_CACHE_ROWS = 300000;
+    static const int PREFETCH_FREQUENT_FORMS = 2;
+    FormPrefetcher *prefetcher;
+};
+
+#endif // MAINWINDOW_H
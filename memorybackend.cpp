@@ -0,0 +1,692 @@
+#include "memorybackend.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <QDeadlineTimer>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+
+// 其他线程的事务未结束时写入等待的最长时间，与SQLite线程连接的忙等待时间相同
+static const int BUSY_TIMEOUT_MS = 5000;
+
+MemoryBackend::MemoryBackend()
+    : m_nextFormId(1)
+    , m_nextPasswordId(1)
+    , m_transactionOwner(nullptr)
+{
+    // 与新建的SQLite数据库一样，带一个默认表单
+    addForm("默认表单");
+}
+
+QString MemoryBackend::uniqueKey(const PasswordEntry &entry)
+{
+    if (entry.account.isNull()) {
+        return QString();
+    }
+    const QChar separator(0x1f);
+    return QString::number(entry.form_id) + separator + entry.website + separator + entry.username +
+           separator + entry.account;
+}
+
+QString MemoryBackend::foldAsciiCase(const QString &text)
+{
+    QString folded = text;
+    for (QChar &ch : folded) {
+        if (ch >= QLatin1Char('A') && ch <= QLatin1Char('Z')) {
+            ch = QChar(ch.unicode() + ('a' - 'A'));
+        }
+    }
+    return folded;
+}
+
+QString MemoryBackend::formatTimestamp(const QDateTime &time)
+{
+    return time.toString("yyyy-MM-dd HH:mm:ss");
+}
+
+bool MemoryBackend::loadFrom(StorageBackend &source)
+{
+    QList<FormEntry> forms = source.getAllForms();
+    QHash<int, FormStats> stats = source.getFormStats();
+    QList<PasswordEntry> passwords = source.getAllPasswords();
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_undoLogs.isEmpty()) {
+        qDebug() << "事务进行中，不能载入数据";
+        return false;
+    }
+
+    clearAll();
+    for (const auto &form : forms) {
+        insertFormEntry(form);
+        QDateTime modified = QDateTime::fromString(stats.value(form.id).lastModified, "yyyy-MM-dd HH:mm:ss");
+        modified.setTimeSpec(Qt::UTC);
+        m_formModified.insert(form.id, modified);
+        m_nextFormId = qMax(m_nextFormId, form.id + 1);
+    }
+
+    int skipped = 0;
+    for (const auto &entry : passwords) {
+        if (!insertEntry(entry)) {
+            ++skipped;
+        }
+        m_nextPasswordId = qMax(m_nextPasswordId, entry.id + 1);
+    }
+
+    qDebug() << "载入内存密码库: 表单" << m_forms.size() << "记录" << m_passwords.size() << "跳过" << skipped;
+    return true;
+}
+
+void MemoryBackend::clearAll()
+{
+    m_forms.clear();
+    m_formIdsByName.clear();
+    m_formModified.clear();
+    m_passwords.clear();
+    m_ids.clear();
+    m_idsByForm.clear();
+    m_uniqueKeys.clear();
+    m_nextFormId = 1;
+    m_nextPasswordId = 1;
+}
+
+bool MemoryBackend::insertEntry(const PasswordEntry &entry)
+{
+    QString key = uniqueKey(entry);
+    if (!key.isEmpty()) {
+        if (m_uniqueKeys.contains(key)) {
+            return false;
+        }
+        m_uniqueKeys.insert(key, entry.id);
+    }
+
+    m_passwords.insert(entry.id, entry);
+    m_ids.insert(entry.id);
+    m_idsByForm[entry.form_id].insert(entry.id);
+    return true;
+}
+
+void MemoryBackend::removeEntry(int id)
+{
+    auto it = m_passwords.find(id);
+    if (it == m_passwords.end()) {
+        return;
+    }
+
+    QString key = uniqueKey(*it);
+    if (!key.isEmpty()) {
+        m_uniqueKeys.remove(key);
+    }
+
+    auto formIt = m_idsByForm.find(it->form_id);
+    if (formIt != m_idsByForm.end()) {
+        formIt->erase(id);
+        if (formIt->empty()) {
+            m_idsByForm.erase(formIt);
+        }
+    }
+    m_ids.erase(id);
+    m_passwords.erase(it);
+}
+
+bool MemoryBackend::replaceEntry(const PasswordEntry &entry)
+{
+    PasswordEntry old = m_passwords.value(entry.id);
+    removeEntry(entry.id);
+    if (!insertEntry(entry)) {
+        insertEntry(old);
+        return false;
+    }
+    return true;
+}
+
+void MemoryBackend::insertFormEntry(const FormEntry &form)
+{
+    m_forms.insert(form.id, form);
+    m_formIdsByName.insert(form.name, form.id);
+}
+
+void MemoryBackend::removeFormEntry(int id)
+{
+    auto it = m_forms.find(id);
+    if (it == m_forms.end()) {
+        return;
+    }
+    m_formIdsByName.remove(it->name);
+    m_forms.erase(it);
+}
+
+void MemoryBackend::touchForm(int formId)
+{
+    if (m_forms.contains(formId)) {
+        m_formModified.insert(formId, QDateTime::currentDateTimeUtc());
+    }
+}
+
+bool MemoryBackend::waitForWriteAccess()
+{
+    QDeadlineTimer deadline(BUSY_TIMEOUT_MS);
+    while (!m_undoLogs.isEmpty() && m_transactionOwner != QThread::currentThreadId()) {
+        if (!m_transactionEnded.wait(&m_mutex, deadline)) {
+            qDebug() << "内存密码库正被其他线程的事务占用，写入超时";
+            return false;
+        }
+    }
+    return true;
+}
+
+void MemoryBackend::recordUndo(const std::function<void()> &undo)
+{
+    if (!m_undoLogs.isEmpty()) {
+        m_undoLogs.last().append(undo);
+    }
+}
+
+bool MemoryBackend::insertEntryLogged(const PasswordEntry &entry)
+{
+    if (!insertEntry(entry)) {
+        return false;
+    }
+    int id = entry.id;
+    recordUndo([this, id]() { removeEntry(id); });
+    touchForm(entry.form_id);
+    return true;
+}
+
+void MemoryBackend::removeEntryLogged(int id)
+{
+    PasswordEntry old = m_passwords.value(id);
+    removeEntry(id);
+    recordUndo([this, old]() { insertEntry(old); });
+    touchForm(old.form_id);
+}
+
+bool MemoryBackend::replaceEntryLogged(const PasswordEntry &entry)
+{
+    PasswordEntry old = m_passwords.value(entry.id);
+    if (!replaceEntry(entry)) {
+        return false;
+    }
+    recordUndo([this, old]() { replaceEntry(old); });
+    touchForm(old.form_id);
+    touchForm(entry.form_id);
+    return true;
+}
+
+// 表单相关方法
+bool MemoryBackend::addForm(const QString &name)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+    if (m_formIdsByName.contains(name)) {
+        return false;
+    }
+
+    FormEntry form;
+    form.id = m_nextFormId++;
+    form.name = name;
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    form.created_at = formatTimestamp(now);
+    insertFormEntry(form);
+    m_formModified.insert(form.id, now);
+
+    int id = form.id;
+    recordUndo([this, id]() {
+        removeFormEntry(id);
+        m_formModified.remove(id);
+    });
+    return true;
+}
+
+bool MemoryBackend::updateForm(int id, const QString &name)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+    if (!m_forms.contains(id)) {
+        return false;
+    }
+    if (m_formIdsByName.value(name, id) != id) {
+        qDebug() << "更新表单失败: 表单名称已存在" << name;
+        return false;
+    }
+
+    FormEntry old = m_forms.value(id);
+    FormEntry form = old;
+    form.name = name;
+    removeFormEntry(id);
+    insertFormEntry(form);
+
+    recordUndo([this, old]() {
+        removeFormEntry(old.id);
+        insertFormEntry(old);
+    });
+    return true;
+}
+
+bool MemoryBackend::deleteForm(int id)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+    if (!m_forms.contains(id)) {
+        return false;
+    }
+
+    // 表单中的记录一并删除
+    const IdSet ids = m_idsByForm.value(id);
+    for (int passwordId : ids) {
+        removeEntryLogged(passwordId);
+    }
+
+    FormEntry old = m_forms.value(id);
+    QDateTime modified = m_formModified.value(id);
+    removeFormEntry(id);
+    m_formModified.remove(id);
+
+    recordUndo([this, old, modified]() {
+        insertFormEntry(old);
+        m_formModified.insert(old.id, modified);
+    });
+    return true;
+}
+
+QList<FormEntry> MemoryBackend::getAllForms()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<FormEntry> forms;
+    forms.reserve(m_forms.size());
+    for (auto it = m_formIdsByName.constBegin(); it != m_formIdsByName.constEnd(); ++it) {
+        forms.append(m_forms.value(it.value()));
+    }
+    return forms;
+}
+
+QHash<int, FormStats> MemoryBackend::getFormStats()
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<int, FormStats> stats;
+    for (auto it = m_forms.constBegin(); it != m_forms.constEnd(); ++it) {
+        FormStats entry;
+        entry.formId = it.key();
+        auto ids = m_idsByForm.constFind(it.key());
+        entry.entryCount = ids != m_idsByForm.constEnd() ? static_cast<int>(ids->size()) : 0;
+        entry.lastModified = formatTimestamp(m_formModified.value(it.key()));
+        stats.insert(entry.formId, entry);
+    }
+    return stats;
+}
+
+// 密码相关方法
+bool MemoryBackend::addPassword(int form_id, const QString &website, const QString &username,
+                                const QString &account, const QString &password, const QString &notes)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+
+    PasswordEntry entry;
+    entry.id = m_nextPasswordId;
+    entry.form_id = form_id;
+    entry.website = website;
+    entry.username = username;
+    entry.account = account;
+    entry.password = password;
+    entry.notes = notes;
+
+    // 与 INSERT OR IGNORE 相同：违反唯一约束时不插入，也不消耗ID
+    if (!insertEntryLogged(entry)) {
+        return false;
+    }
+    ++m_nextPasswordId;
+    return true;
+}
+
+bool MemoryBackend::updatePassword(int id, int form_id, const QString &website,
+                                   const QString &username, const QString &account,
+                                   const QString &password, const QString &notes)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+    if (!m_passwords.contains(id)) {
+        return false;
+    }
+
+    PasswordEntry entry;
+    entry.id = id;
+    entry.form_id = form_id;
+    entry.website = website;
+    entry.username = username;
+    entry.account = account;
+    entry.password = password;
+    entry.notes = notes;
+
+    if (!replaceEntryLogged(entry)) {
+        qDebug() << "新的表单、网站、用户名和账号组合已存在";
+        return false;
+    }
+    return true;
+}
+
+bool MemoryBackend::updateField(int id, EntryField field, const QString &value, bool *conflict)
+{
+    if (conflict) {
+        *conflict = false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+    auto it = m_passwords.constFind(id);
+    if (it == m_passwords.constEnd()) {
+        return false;
+    }
+
+    PasswordEntry entry = *it;
+    switch (field) {
+    case WebsiteField:
+        entry.website = value;
+        break;
+    case UsernameField:
+        entry.username = value;
+        break;
+    case AccountField:
+        entry.account = value;
+        break;
+    case PasswordField:
+        entry.password = value;
+        break;
+    case NotesField:
+        entry.notes = value;
+        break;
+    default:
+        qDebug() << "无效的字段:" << field;
+        return false;
+    }
+
+    if (!replaceEntryLogged(entry)) {
+        qDebug() << "新的表单、网站、用户名和账号组合已存在";
+        if (conflict) {
+            *conflict = true;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool MemoryBackend::deletePassword(int id)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+    if (!m_passwords.contains(id)) {
+        return false;
+    }
+    removeEntryLogged(id);
+    return true;
+}
+
+int MemoryBackend::deletePasswords(const QList<int> &ids)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return -1;
+    }
+    int deletedCount = 0;
+    for (int id : ids) {
+        if (m_passwords.contains(id)) {
+            removeEntryLogged(id);
+            ++deletedCount;
+        }
+    }
+    return deletedCount;
+}
+
+bool MemoryBackend::deletePasswordByWebsite(const QString &website)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return false;
+    }
+    QList<int> ids;
+    for (auto it = m_passwords.constBegin(); it != m_passwords.constEnd(); ++it) {
+        if (it->website == website) {
+            ids.append(it.key());
+        }
+    }
+    for (int id : ids) {
+        removeEntryLogged(id);
+    }
+    return !ids.isEmpty();
+}
+
+int MemoryBackend::transferPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, bool copy,
+                                     int *conflictCount)
+{
+    if (conflictCount) {
+        *conflictCount = 0;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return -1;
+    }
+
+    // 与SQLite引擎相同：按ID顺序处理，已经在目标表单中的记录不移动，也不复制到自身所在的表单
+    QList<int> sortedIds = ids;
+    std::sort(sortedIds.begin(), sortedIds.end());
+    sortedIds.erase(std::unique(sortedIds.begin(), sortedIds.end()), sortedIds.end());
+
+    QList<PasswordEntry> candidates;
+    for (int id : sortedIds) {
+        auto it = m_passwords.constFind(id);
+        if (it != m_passwords.constEnd() && it->form_id != targetFormId) {
+            candidates.append(*it);
+        }
+    }
+
+    int replacedCount = 0;
+    if (policy == ReplaceConflicts) {
+        // 先删除目标表单中与选中记录冲突的旧记录
+        for (const auto &candidate : candidates) {
+            PasswordEntry probe = candidate;
+            probe.form_id = targetFormId;
+            QString key = uniqueKey(probe);
+            int existing = key.isEmpty() ? -1 : m_uniqueKeys.value(key, -1);
+            if (existing >= 0) {
+                removeEntryLogged(existing);
+                ++replacedCount;
+            }
+        }
+    }
+
+    // 与选中记录之间或目标表单已有记录冲突的行保持不变
+    int transferredCount = 0;
+    for (PasswordEntry entry : candidates) {
+        entry.form_id = targetFormId;
+        if (copy) {
+            entry.id = m_nextPasswordId;
+            if (insertEntryLogged(entry)) {
+                ++m_nextPasswordId;
+                ++transferredCount;
+            }
+        } else if (replaceEntryLogged(entry)) {
+            ++transferredCount;
+        }
+    }
+
+    // 与SQLite引擎相同：替换模式下选中记录之间的冲突也计入
+    if (conflictCount) {
+        *conflictCount = (policy == ReplaceConflicts ? replacedCount : 0)
+                         + (static_cast<int>(candidates.size()) - transferredCount);
+    }
+    qDebug() << (copy ? "批量复制" : "批量移动") << transferredCount << "条记录到表单" << targetFormId;
+    return transferredCount;
+}
+
+QList<PasswordEntry> MemoryBackend::getAllPasswords(int form_id)
+{
+    QMutexLocker locker(&m_mutex);
+    QList<PasswordEntry> entries;
+
+    const IdSet *ids = &m_ids;
+    if (form_id >= 0) {
+        auto it = m_idsByForm.constFind(form_id);
+        if (it == m_idsByForm.constEnd()) {
+            return entries;
+        }
+        ids = &it.value();
+    }
+
+    entries.reserve(static_cast<int>(ids->size()));
+    for (int id : *ids) {
+        entries.append(m_passwords.value(id));
+    }
+    return entries;
+}
+
+QList<PasswordEntry> MemoryBackend::searchPasswords(const QString &keyword, const QList<int> &form_ids)
+{
+    QMutexLocker locker(&m_mutex);
+    QList<PasswordEntry> entries;
+
+    // 与SQLite的 LIKE '%keyword%' 一样只对ASCII字母不区分大小写，其他字符（如全角字母、希腊字母）按原样比较
+    // （关键词中的%和_在SQLite中是通配符，这里按普通字符匹配）
+    const QString foldedKeyword = foldAsciiCase(keyword);
+    QSet<int> forms(form_ids.begin(), form_ids.end());
+    for (int id : m_ids) {
+        const PasswordEntry &entry = *m_passwords.constFind(id);
+        if (!forms.isEmpty() && !forms.contains(entry.form_id)) {
+            continue;
+        }
+        if (foldAsciiCase(entry.website).contains(foldedKeyword) ||
+            foldAsciiCase(entry.username).contains(foldedKeyword) ||
+            foldAsciiCase(entry.account).contains(foldedKeyword) ||
+            foldAsciiCase(entry.notes).contains(foldedKeyword)) {
+            entries.append(entry);
+        }
+    }
+    return entries;
+}
+
+QList<PasswordEntry> MemoryBackend::getPasswordsByIds(const QList<int> &ids)
+{
+    QList<int> sortedIds = ids;
+    std::sort(sortedIds.begin(), sortedIds.end());
+    sortedIds.erase(std::unique(sortedIds.begin(), sortedIds.end()), sortedIds.end());
+
+    QMutexLocker locker(&m_mutex);
+    QList<PasswordEntry> entries;
+    entries.reserve(sortedIds.size());
+    for (int id : sortedIds) {
+        auto it = m_passwords.constFind(id);
+        if (it != m_passwords.constEnd()) {
+            entries.append(*it);
+        }
+    }
+    return entries;
+}
+
+QList<PasswordEntry> MemoryBackend::getPasswordsAfter(int form_id, int afterId, int limit)
+{
+    QMutexLocker locker(&m_mutex);
+    QList<PasswordEntry> entries;
+
+    const IdSet *ids = &m_ids;
+    if (form_id >= 0) {
+        auto it = m_idsByForm.constFind(form_id);
+        if (it == m_idsByForm.constEnd()) {
+            return entries;
+        }
+        ids = &it.value();
+    }
+
+    // 有序索引上直接定位到游标之后
+    for (auto it = ids->upper_bound(afterId); it != ids->end() && entries.size() < limit; ++it) {
+        entries.append(m_passwords.value(*it));
+    }
+    return entries;
+}
+
+int MemoryBackend::countPasswords(int form_id)
+{
+    QMutexLocker locker(&m_mutex);
+    if (form_id < 0) {
+        return static_cast<int>(m_passwords.size());
+    }
+    auto it = m_idsByForm.constFind(form_id);
+    return it != m_idsByForm.constEnd() ? static_cast<int>(it->size()) : 0;
+}
+
+int MemoryBackend::beginTransaction()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!waitForWriteAccess()) {
+        return -1;
+    }
+    m_undoLogs.append(QList<std::function<void()>>());
+    m_transactionOwner = QThread::currentThreadId();
+    return static_cast<int>(m_undoLogs.size()) - 1;
+}
+
+bool MemoryBackend::commitTransaction(int level)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_transactionOwner != QThread::currentThreadId()) {
+        qDebug() << "不能提交其他线程的事务";
+        return false;
+    }
+    if (level != m_undoLogs.size() - 1) {
+        return false;
+    }
+
+    // 内层提交后，它的修改仍要能随外层一起回滚
+    QList<std::function<void()>> log = m_undoLogs.takeLast();
+    if (!m_undoLogs.isEmpty()) {
+        m_undoLogs.last().append(log);
+    } else {
+        endTransaction();
+    }
+    return true;
+}
+
+void MemoryBackend::rollbackTransaction(int level)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_transactionOwner != QThread::currentThreadId()) {
+        qDebug() << "不能回滚其他线程的事务";
+        return;
+    }
+    if (level != m_undoLogs.size() - 1) {
+        return;
+    }
+
+    QList<std::function<void()>> log = m_undoLogs.takeLast();
+    for (int i = log.size() - 1; i >= 0; --i) {
+        log[i]();
+    }
+    if (m_undoLogs.isEmpty()) {
+        endTransaction();
+    }
+}
+
+void MemoryBackend::endTransaction()
+{
+    m_transactionOwner = nullptr;
+    m_transactionEnded.wakeAll();
+}
+
+int MemoryBackend::transactionDepth() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_undoLogs.size());
+}
@@ -0,0 +1,103 @@
+#ifndef MEMORYBACKEND_H
+#define MEMORYBACKEND_H
+
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QList>
+#include <functional>
+#include <set>
+#include "storagebackend.h"
+
+// 内存存储引擎：数据只保存在内存中，进程退出即丢失，用于临时密码库和不含磁盘I/O的基准测试
+// 记录按ID保存在哈希表中，另有全部记录和每个表单的有序ID索引（按ID排序的查询和游标分页直接遍历索引），
+// 以及表单+网站+用户名+账号到ID的哈希实现与SQLite相同的唯一约束
+// 事务用撤销日志实现：每层事务记录已做修改的逆操作，回滚时倒序执行
+// 事务属于开始它的线程：与SQLite的写锁类似，其他线程的写入和新事务等待它结束（超时失败），
+// 不会混进它的撤销日志；其他线程的读取不等待，能看到未提交的修改
+class MemoryBackend : public StorageBackend
+{
+public:
+    MemoryBackend();
+
+    // 清空后复制另一个引擎中的全部表单和记录（保留ID），用于把已有的密码库载入内存
+    bool loadFrom(StorageBackend &source);
+
+    bool isPersistent() const override { return false; }
+
+    bool addForm(const QString &name) override;
+    bool updateForm(int id, const QString &name) override;
+    bool deleteForm(int id) override;  // 同时删除表单中的记录
+    QList<FormEntry> getAllForms() override;
+    QHash<int, FormStats> getFormStats() override;
+
+    bool addPassword(int form_id, const QString &website, const QString &username,
+                     const QString &account, const QString &password, const QString &notes) override;
+    bool updatePassword(int id, int form_id, const QString &website,
+                        const QString &username, const QString &account,
+                        const QString &password, const QString &notes) override;
+    bool updateField(int id, EntryField field, const QString &value, bool *conflict = nullptr) override;
+    bool deletePassword(int id) override;
+    int deletePasswords(const QList<int> &ids) override;
+    bool deletePasswordByWebsite(const QString &website) override;
+    int transferPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, bool copy,
+                          int *conflictCount) override;
+
+    QList<PasswordEntry> getAllPasswords(int form_id = -1) override;
+    QList<PasswordEntry> searchPasswords(const QString &keyword, const QList<int> &form_ids = QList<int>()) override;
+    QList<PasswordEntry> getPasswordsByIds(const QList<int> &ids) override;
+    QList<PasswordEntry> getPasswordsAfter(int form_id, int afterId, int limit) override;
+    int countPasswords(int form_id = -1) override;
+
+    int beginTransaction() override;
+    bool commitTransaction(int level) override;
+    void rollbackTransaction(int level) override;
+    int transactionDepth() const override;
+
+private:
+    typedef std::set<int> IdSet;  // 按ID递增排序的索引
+
+    static QString uniqueKey(const PasswordEntry &entry);  // 账号为NULL时返回空字符串，与SQLite一样不参与唯一约束
+    static QString formatTimestamp(const QDateTime &time);  // 与SQLite的CURRENT_TIMESTAMP格式相同
+    static QString foldAsciiCase(const QString &text);  // 只把ASCII大写字母转为小写，与SQLite的LIKE相同
+
+    // 以下函数不加锁，也不记录撤销操作
+    void clearAll();
+    bool insertEntry(const PasswordEntry &entry);  // 违反唯一约束时返回false
+    void removeEntry(int id);
+    bool replaceEntry(const PasswordEntry &entry);  // 违反唯一约束时保持原记录并返回false
+    void insertFormEntry(const FormEntry &form);
+    void removeFormEntry(int id);
+    void touchForm(int formId);
+
+    // 同上，另外记录撤销操作并更新表单修改时间，调用时已加锁
+    bool insertEntryLogged(const PasswordEntry &entry);
+    void removeEntryLogged(int id);
+    bool replaceEntryLogged(const PasswordEntry &entry);
+    void recordUndo(const std::function<void()> &undo);
+
+    // 调用时已加锁：其他线程的事务未结束时等待，超时返回false
+    bool waitForWriteAccess();
+    void endTransaction();  // 最外层事务结束后调用，唤醒等待写入的线程
+
+    mutable QMutex m_mutex;
+
+    QHash<int, FormEntry> m_forms;
+    QMap<QString, int> m_formIdsByName;  // 按名称排序
+    QHash<int, QDateTime> m_formModified;  // 每个表单最后修改时间（UTC）
+    int m_nextFormId;
+
+    QHash<int, PasswordEntry> m_passwords;
+    IdSet m_ids;
+    QHash<int, IdSet> m_idsByForm;
+    QHash<QString, int> m_uniqueKeys;
+    int m_nextPasswordId;
+
+    QList<QList<std::function<void()>>> m_undoLogs;  // 每层事务一个撤销日志
+    Qt::HANDLE m_transactionOwner;  // 开始最外层事务的线程，没有事务时为nullptr
+    QWaitCondition m_transactionEnded;
+};
+
+#endif // MEMORYBACKEND_H
@@ -0,0 +1,141 @@
+#include "passwordtablemodel.h"
+#include <algorithm>
+
+PasswordTableModel::PasswordTableModel(QObject *parent)
+    : QStandardItemModel(parent)
+{
+    connect(this, &QStandardItemModel::rowsAboutToBeRemoved, this, &PasswordTableModel::onRowsAboutToBeRemoved);
+}
+
+int PasswordTableModel::rowId(int row) const
+{
+    return QStandardItemModel::data(index(row, ID_COLUMN), Qt::UserRole + 1).toInt();
+}
+
+QVariant PasswordTableModel::data(const QModelIndex &index, int role) const
+{
+    if (role == Qt::CheckStateRole && index.column() == CHECK_COLUMN) {
+        return m_checkedIds.contains(rowId(index.row())) ? Qt::Checked : Qt::Unchecked;
+    }
+    return QStandardItemModel::data(index, role);
+}
+
+bool PasswordTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (role == Qt::CheckStateRole && index.column() == CHECK_COLUMN) {
+        int id = rowId(index.row());
+        bool checked = static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked;
+        if (checked == m_checkedIds.contains(id)) {
+            return true;
+        }
+        if (checked) {
+            m_checkedIds.insert(id);
+        } else {
+            m_checkedIds.remove(id);
+        }
+        emit dataChanged(index, index, {Qt::CheckStateRole});
+        emit checkedCountChanged(m_checkedIds.size());
+        return true;
+    }
+    return QStandardItemModel::setData(index, value, role);
+}
+
+Qt::ItemFlags PasswordTableModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags result = QStandardItemModel::flags(index);
+    if (index.column() == CHECK_COLUMN) {
+        result |= Qt::ItemIsUserCheckable;
+    }
+    return result;
+}
+
+QList<int> PasswordTableModel::checkedIds() const
+{
+    QList<int> ids = m_checkedIds.values();
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+QList<int> PasswordTableModel::checkedRows() const
+{
+    QList<int> rows;
+    if (m_checkedIds.isEmpty()) {
+        return rows;
+    }
+    for (int row = 0; row < rowCount() && rows.size() < m_checkedIds.size(); ++row) {
+        if (m_checkedIds.contains(rowId(row))) {
+            rows.append(row);
+        }
+    }
+    return rows;
+}
+
+void PasswordTableModel::setRowsChecked(int firstRow, int lastRow, bool checked)
+{
+    firstRow = qMax(firstRow, 0);
+    lastRow = qMin(lastRow, rowCount() - 1);
+    if (firstRow > lastRow) {
+        return;
+    }
+
+    int before = m_checkedIds.size();
+    if (!checked && firstRow == 0 && lastRow == rowCount() - 1) {
+        m_checkedIds.clear();
+    } else {
+        for (int row = firstRow; row <= lastRow; ++row) {
+            if (checked) {
+                m_checkedIds.insert(rowId(row));
+            } else {
+                m_checkedIds.remove(rowId(row));
+            }
+        }
+    }
+
+    // 整个范围只通知视图一次
+    emit dataChanged(index(firstRow, CHECK_COLUMN), index(lastRow, CHECK_COLUMN), {Qt::CheckStateRole});
+    if (m_checkedIds.size() != before) {
+        emit checkedCountChanged(m_checkedIds.size());
+    }
+}
+
+void PasswordTableModel::setAllChecked(bool checked)
+{
+    if (!checked && m_checkedIds.isEmpty()) {
+        return;
+    }
+    if (checked) {
+        m_checkedIds.reserve(rowCount());
+    }
+    setRowsChecked(0, rowCount() - 1, checked);
+}
+
+void PasswordTableModel::removeRowList(const QList<int> &rows)
+{
+    // 从后往前删，前面的行号不受影响
+    int end = rows.size() - 1;
+    while (end >= 0) {
+        int start = end;
+        while (start > 0 && rows[start - 1] == rows[start] - 1) {
+            --start;
+        }
+        removeRows(rows[start], rows[end] - rows[start] + 1);
+        end = start - 1;
+    }
+}
+
+void PasswordTableModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid() || m_checkedIds.isEmpty()) {
+        return;
+    }
+
+    // 删除的行不再计入选中数量；清空整个表格时直接清空集合
+    if (first == 0 && last == rowCount() - 1) {
+        m_checkedIds.clear();
+    } else {
+        for (int row = first; row <= last; ++row) {
+            m_checkedIds.remove(rowId(row));
+        }
+    }
+    emit checkedCountChanged(m_checkedIds.size());
+}
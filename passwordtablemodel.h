@@ -0,0 +1,45 @@
+#ifndef PASSWORDTABLEMODEL_H
+#define PASSWORDTABLEMODEL_H
+
+#include <QStandardItemModel>
+#include <QSet>
+#include <QList>
+
+// 密码表格模型：多选框的状态不存放在每个单元格里，而是用记录ID集合保存
+// 勾选一条记录和查询选中数量都是O(1)，全选/取消全选只发出一次dataChanged
+class PasswordTableModel : public QStandardItemModel
+{
+    Q_OBJECT
+
+public:
+    static const int ID_COLUMN = 0;     // 隐藏的ID列，ID保存在 Qt::UserRole + 1
+    static const int CHECK_COLUMN = 8;  // 选择框列
+
+    explicit PasswordTableModel(QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    int rowId(int row) const;
+    int checkedCount() const { return m_checkedIds.size(); }
+    bool isRowChecked(int row) const { return m_checkedIds.contains(rowId(row)); }
+    QList<int> checkedIds() const;   // 按ID递增排序
+    QList<int> checkedRows() const;  // 按行号递增排序，需要遍历所有行
+    void setRowsChecked(int firstRow, int lastRow, bool checked);
+    void setAllChecked(bool checked);
+
+    // 删除一组行（按行号递增排列），相邻的行合并成一个范围一次删除
+    void removeRowList(const QList<int> &rows);
+
+signals:
+    void checkedCountChanged(int count);
+
+private slots:
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+
+private:
+    QSet<int> m_checkedIds;
+};
+
+#endif // PASSWORDTABLEMODEL_H
@@ -0,0 +1,812 @@
+#include "sqlitebackend.h"
+#include "database.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlDriver>
+#include <QStringList>
+#include <QAtomicInt>
+#include <QDebug>
+#include <algorithm>
+#ifdef PM_HAVE_SQLITE3_API
+#include <sqlite3.h>
+#endif
+
+SqliteBackend::SqliteBackend(const QSqlDatabase &connection)
+    : db(connection)
+    , m_transactionDepth(0)
+{
+}
+
+void SqliteBackend::setConnection(const QSqlDatabase &connection)
+{
+    db = connection;
+    m_transactionDepth = 0;
+}
+
+// 最外层用BEGIN/COMMIT，内层用SAVEPOINT，内层回滚只撤销自己的修改
+int SqliteBackend::beginTransaction()
+{
+    int level = m_transactionDepth;
+
+    bool ok;
+    if (level == 0) {
+        ok = db.transaction();
+        if (!ok) {
+            qDebug() << "开始事务失败:" << db.lastError().text();
+        }
+    } else {
+        QSqlQuery query(db);
+        ok = query.exec(QString("SAVEPOINT sp_%1").arg(level));
+        if (!ok) {
+            qDebug() << "创建保存点失败:" << query.lastError().text();
+        }
+    }
+
+    if (!ok) {
+        return -1;
+    }
+    m_transactionDepth = level + 1;
+    return level;
+}
+
+bool SqliteBackend::commitTransaction(int level)
+{
+    bool ok;
+    if (level == 0) {
+        ok = db.commit();
+        if (!ok) {
+            qDebug() << "提交事务失败:" << db.lastError().text();
+        }
+    } else {
+        QSqlQuery query(db);
+        ok = query.exec(QString("RELEASE SAVEPOINT sp_%1").arg(level));
+        if (!ok) {
+            qDebug() << "释放保存点失败:" << query.lastError().text();
+        }
+    }
+
+    if (ok) {
+        m_transactionDepth = level;
+    }
+    return ok;
+}
+
+void SqliteBackend::rollbackTransaction(int level)
+{
+    if (level == 0) {
+        if (!db.rollback()) {
+            qDebug() << "回滚事务失败:" << db.lastError().text();
+        }
+    } else {
+        // ROLLBACK TO只撤销保存点之后的修改，保存点本身仍然存在，需要再释放
+        QSqlQuery query(db);
+        if (!query.exec(QString("ROLLBACK TO SAVEPOINT sp_%1").arg(level)) ||
+            !query.exec(QString("RELEASE SAVEPOINT sp_%1").arg(level))) {
+            qDebug() << "回滚到保存点失败:" << query.lastError().text();
+        }
+    }
+    m_transactionDepth = level;
+}
+
+// 表单相关方法
+bool SqliteBackend::addForm(const QString &name)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT OR IGNORE INTO forms (name) VALUES (:name)");
+    query.bindValue(":name", name);
+
+    if (!query.exec()) {
+        qDebug() << "添加表单失败:" << query.lastError().text();
+        return false;
+    }
+
+    if (query.numRowsAffected() <= 0) {
+        return false;
+    }
+    return true;
+}
+
+bool SqliteBackend::updateForm(int id, const QString &name)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("UPDATE forms SET name = :name WHERE id = :id");
+    query.bindValue(":name", name);
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qDebug() << "更新表单失败:" << query.lastError().text();
+        return false;
+    }
+
+    if (query.numRowsAffected() <= 0) {
+        return false;
+    }
+    return true;
+}
+
+bool SqliteBackend::deleteForm(int id)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM forms WHERE id = :id");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qDebug() << "删除表单失败:" << query.lastError().text();
+        return false;
+    }
+
+    if (query.numRowsAffected() <= 0) {
+        return false;
+    }
+    return true;
+}
+
+QList<FormEntry> SqliteBackend::getAllForms()
+{
+    QList<FormEntry> forms;
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return forms;
+    }
+
+    QSqlQuery query(db);
+    if (!query.exec("SELECT id, name, created_at FROM forms ORDER BY name")) {
+        qDebug() << "查询表单失败:" << query.lastError().text();
+        return forms;
+    }
+
+    while (query.next()) {
+        FormEntry form;
+        form.id = query.value(0).toInt();
+        form.name = query.value(1).toString();
+        form.created_at = query.value(2).toString();
+        forms.append(form);
+    }
+
+    return forms;
+}
+
+QHash<int, FormStats> SqliteBackend::getFormStats()
+{
+    QHash<int, FormStats> stats;
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return stats;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT form_id, entry_count, last_modified FROM form_stats")) {
+        qDebug() << "查询表单统计失败:" << query.lastError().text();
+        return stats;
+    }
+
+    while (query.next()) {
+        FormStats entry;
+        entry.formId = query.value(0).toInt();
+        entry.entryCount = query.value(1).toInt();
+        entry.lastModified = query.value(2).toString();
+        stats.insert(entry.formId, entry);
+    }
+
+    return stats;
+}
+
+// 密码相关方法
+bool SqliteBackend::addPassword(int form_id, const QString &website, const QString &username,
+                           const QString &account, const QString &password,
+                           const QString &notes)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT OR IGNORE INTO passwords (form_id, website, username, account, password, notes) "
+                  "VALUES (:form_id, :website, :username, :account, :password, :notes)");
+    query.bindValue(":form_id", form_id);
+    query.bindValue(":website", website);
+    query.bindValue(":username", username);
+    query.bindValue(":account", account);  // 新增：绑定账号
+    query.bindValue(":password", password);
+    query.bindValue(":notes", notes);
+
+    if (!query.exec()) {
+        qDebug() << "添加密码失败:" << query.lastError().text();
+        return false;
+    }
+
+    return query.numRowsAffected() > 0;
+}
+
+bool SqliteBackend::updatePassword(int id, int form_id, const QString &website,
+                              const QString &username, const QString &account,
+                              const QString &password, const QString &notes)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+
+    // 首先检查新的form_id、website、username和account组合是否已存在（排除自身）
+    query.prepare("SELECT id FROM passwords WHERE form_id = :form_id AND website = :website AND username = :username AND account = :account AND id != :id");
+    query.bindValue(":form_id", form_id);
+    query.bindValue(":website", website);
+    query.bindValue(":username", username);
+    query.bindValue(":account", account);  // 新增：账号条件
+    query.bindValue(":id", id);
+
+    if (query.exec() && query.next()) {
+        qDebug() << "新的表单、网站、用户名和账号组合已存在";
+        return false;
+    }
+
+    // 如果新的组合不存在，则更新记录
+    query.prepare("UPDATE passwords SET form_id = :form_id, website = :website, username = :username, "
+                  "account = :account, password = :password, notes = :notes WHERE id = :id");
+    query.bindValue(":form_id", form_id);
+    query.bindValue(":website", website);
+    query.bindValue(":username", username);
+    query.bindValue(":account", account);  // 新增：更新账号
+    query.bindValue(":password", password);
+    query.bindValue(":notes", notes);
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qDebug() << "更新密码失败:" << query.lastError().text();
+        return false;
+    }
+
+    return query.numRowsAffected() > 0;
+}
+
+bool SqliteBackend::updateField(int id, EntryField field, const QString &value, bool *conflict)
+{
+    if (conflict) {
+        *conflict = false;
+    }
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QString column;
+    switch (field) {
+    case WebsiteField:
+        column = "website";
+        break;
+    case UsernameField:
+        column = "username";
+        break;
+    case AccountField:
+        column = "account";
+        break;
+    case PasswordField:
+        column = "password";
+        break;
+    case NotesField:
+        column = "notes";
+        break;
+    }
+    if (column.isEmpty()) {
+        qDebug() << "无效的字段:" << field;
+        return false;
+    }
+
+    // 不预先查询重复记录，由UNIQUE(form_id, website, username, account)约束拒绝冲突的修改
+    QSqlQuery query(db);
+    query.prepare(QString("UPDATE passwords SET %1 = :value WHERE id = :id").arg(column));
+    query.bindValue(":value", value);
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        QSqlError error = query.lastError();
+        // SQLITE_CONSTRAINT(19)，启用扩展错误码时为SQLITE_CONSTRAINT_UNIQUE(2067)
+        if (error.nativeErrorCode() == "19" || error.nativeErrorCode() == "2067" ||
+            error.databaseText().contains("UNIQUE constraint failed")) {
+            qDebug() << "新的表单、网站、用户名和账号组合已存在";
+            if (conflict) {
+                *conflict = true;
+            }
+        } else {
+            qDebug() << "更新字段失败:" << error.text();
+        }
+        return false;
+    }
+
+    return query.numRowsAffected() > 0;
+}
+
+bool SqliteBackend::deletePassword(int id)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM passwords WHERE id = :id");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qDebug() << "删除密码失败:" << query.lastError().text();
+        return false;
+    }
+
+    return query.numRowsAffected() > 0;
+}
+
+int SqliteBackend::deletePasswords(const QList<int> &ids)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return -1;
+    }
+
+    if (ids.isEmpty()) {
+        return 0;
+    }
+
+    // 全部删除放在一个事务中，只在提交时写一次盘；SQLite默认最多999个绑定参数，分批构建IN子句
+    const int CHUNK_SIZE = 500;
+    int deletedCount = 0;
+    Database::Transaction transaction(this);
+    if (!transaction.isActive()) {
+        return -1;
+    }
+
+    QSqlQuery query(db);
+    for (int start = 0; start < ids.size(); start += CHUNK_SIZE) {
+        int count = qMin(CHUNK_SIZE, ids.size() - start);
+
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i) {
+            placeholders.append("?");
+        }
+
+        query.prepare("DELETE FROM passwords WHERE id IN (" + placeholders.join(",") + ")");
+        for (int i = 0; i < count; ++i) {
+            query.addBindValue(ids[start + i]);
+        }
+
+        if (!query.exec()) {
+            qDebug() << "批量删除密码失败:" << query.lastError().text();
+            return -1;
+        }
+        deletedCount += query.numRowsAffected();
+    }
+
+    if (!transaction.commit()) {
+        return -1;
+    }
+
+    return deletedCount;
+}
+
+// 把一组ID写入临时表，批量操作用 IN (SELECT id FROM temp.bulk_ids) 引用，不受绑定参数个数限制
+bool SqliteBackend::fillBulkIds(const QList<int> &ids)
+{
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS bulk_ids (id INTEGER PRIMARY KEY)") ||
+        !query.exec("DELETE FROM temp.bulk_ids")) {
+        qDebug() << "准备临时表失败:" << query.lastError().text();
+        return false;
+    }
+
+    QVariantList values;
+    values.reserve(ids.size());
+    for (int id : ids) {
+        values.append(id);
+    }
+    query.prepare("INSERT OR IGNORE INTO temp.bulk_ids (id) VALUES (?)");
+    query.addBindValue(values);
+    if (!query.execBatch()) {
+        qDebug() << "写入临时表失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+int SqliteBackend::transferPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, bool copy,
+                                int *conflictCount)
+{
+    if (conflictCount) {
+        *conflictCount = 0;
+    }
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return -1;
+    }
+
+    if (ids.isEmpty()) {
+        return 0;
+    }
+
+    Database::Transaction transaction(this);
+    if (!transaction.isActive()) {
+        return -1;
+    }
+
+    auto fail = [](const QSqlQuery &query) {
+        qDebug() << "批量移动/复制密码失败:" << query.lastError().text();
+        return -1;
+    };
+
+    QSqlQuery query(db);
+    if (!fillBulkIds(ids)) {
+        return -1;
+    }
+
+    // 已经在目标表单中的记录不需要移动，也不复制到自身所在的表单
+    if (!query.exec(QString("DELETE FROM temp.bulk_ids WHERE id IN "
+                            "(SELECT id FROM passwords WHERE form_id = %1)").arg(targetFormId))) {
+        return fail(query);
+    }
+    if (!query.exec("SELECT COUNT(*) FROM temp.bulk_ids") || !query.next()) {
+        return fail(query);
+    }
+    int candidateCount = query.value(0).toInt();
+
+    int replacedCount = 0;
+    if (policy == ReplaceConflicts) {
+        // 不用UPDATE OR REPLACE：REPLACE删除冲突行时不触发删除触发器，form_stats会不准确
+        query.prepare("DELETE FROM passwords WHERE form_id = :target_form AND EXISTS ("
+                      "SELECT 1 FROM passwords AS source JOIN temp.bulk_ids ON source.id = temp.bulk_ids.id "
+                      "WHERE source.website = passwords.website AND source.username = passwords.username "
+                      "AND source.account = passwords.account)");
+        query.bindValue(":target_form", targetFormId);
+        if (!query.exec()) {
+            return fail(query);
+        }
+        replacedCount = query.numRowsAffected();
+    }
+
+    // OR IGNORE：与目标表单已有记录冲突（或选中的记录之间互相冲突）的行保持不变
+    if (copy) {
+        query.prepare("INSERT OR IGNORE INTO passwords (form_id, website, username, account, password, notes) "
+                      "SELECT :target_form, website, username, account, password, notes FROM passwords "
+                      "WHERE id IN (SELECT id FROM temp.bulk_ids) ORDER BY id");
+    } else {
+        query.prepare("UPDATE OR IGNORE passwords SET form_id = :target_form "
+                      "WHERE id IN (SELECT id FROM temp.bulk_ids)");
+    }
+    query.bindValue(":target_form", targetFormId);
+    if (!query.exec()) {
+        return fail(query);
+    }
+    int transferredCount = query.numRowsAffected();
+
+    if (!query.exec("DELETE FROM temp.bulk_ids")) {
+        return fail(query);
+    }
+    if (!transaction.commit()) {
+        return -1;
+    }
+
+    // 选中的记录之间互相冲突时，替换模式下也只有第一条写入目标表单，其余的同样计入冲突
+    if (conflictCount) {
+        *conflictCount = (policy == ReplaceConflicts ? replacedCount : 0) + (candidateCount - transferredCount);
+    }
+    qDebug() << (copy ? "批量复制" : "批量移动") << transferredCount << "条记录到表单" << targetFormId;
+    return transferredCount;
+}
+
+bool SqliteBackend::deletePasswordByWebsite(const QString &website)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM passwords WHERE website = :website");
+    query.bindValue(":website", website);
+
+    if (!query.exec()) {
+        qDebug() << "删除密码失败:" << query.lastError().text();
+        return false;
+    }
+
+    return query.numRowsAffected() > 0;
+}
+
+// 0表示关闭；只有编译时启用了PM_HAVE_SQLITE3_API才会真正使用C API
+static QAtomicInt nativeReads(1);
+
+void SqliteBackend::setNativeReads(bool enabled)
+{
+    nativeReads.storeRelease(enabled ? 1 : 0);
+}
+
+bool SqliteBackend::nativeReadsEnabled()
+{
+#ifdef PM_HAVE_SQLITE3_API
+    return nativeReads.loadAcquire() != 0;
+#else
+    return false;
+#endif
+}
+
+#ifdef PM_HAVE_SQLITE3_API
+// 直接在连接底层的sqlite3句柄上执行查询：逐行step，文本列从sqlite3_column_text只做一次UTF-8到UTF-16的转换，
+// 不经过QSqlQuery::value()的QVariant装箱。句柄不可用（驱动不是QSQLITE）时返回false，由调用者回到QSqlQuery路径
+static bool queryPasswordsNative(const QSqlDatabase &connection, const QString &sql, const QVariantList &params,
+                                 QList<PasswordEntry> &entries, bool *handled)
+{
+    *handled = false;
+    QVariant handle = connection.driver()->handle();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0) {
+        return false;
+    }
+    sqlite3 *sqlite = *static_cast<sqlite3 **>(handle.data());
+    if (!sqlite) {
+        return false;
+    }
+    *handled = true;
+
+    sqlite3_stmt *stmt = nullptr;
+    QByteArray sqlUtf8 = sql.toUtf8();
+    if (sqlite3_prepare_v2(sqlite, sqlUtf8.constData(), sqlUtf8.size(), &stmt, nullptr) != SQLITE_OK) {
+        qDebug() << "准备查询失败:" << sqlite3_errmsg(sqlite);
+        return false;
+    }
+
+    for (int i = 0; i < params.size(); ++i) {
+        const QVariant &param = params[i];
+        int rc;
+        if (param.userType() == QMetaType::QString) {
+            QByteArray text = param.toString().toUtf8();
+            rc = sqlite3_bind_text(stmt, i + 1, text.constData(), text.size(), SQLITE_TRANSIENT);
+        } else {
+            rc = sqlite3_bind_int64(stmt, i + 1, param.toLongLong());
+        }
+        if (rc != SQLITE_OK) {
+            qDebug() << "绑定参数失败:" << sqlite3_errmsg(sqlite);
+            sqlite3_finalize(stmt);
+            return false;
+        }
+    }
+
+    auto text = [stmt](int column) {
+        return QString::fromUtf8(reinterpret_cast<const char *>(sqlite3_column_text(stmt, column)),
+                                 sqlite3_column_bytes(stmt, column));
+    };
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        PasswordEntry entry;
+        entry.id = sqlite3_column_int(stmt, 0);
+        entry.form_id = sqlite3_column_int(stmt, 1);
+        entry.website = text(2);
+        entry.username = text(3);
+        entry.account = text(4);
+        entry.password = text(5);
+        entry.notes = text(6);
+        entries.append(entry);
+    }
+
+    bool ok = (rc == SQLITE_DONE);
+    if (!ok) {
+        qDebug() << "读取查询结果失败:" << sqlite3_errmsg(sqlite);
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+#endif
+
+bool SqliteBackend::queryPasswords(const QSqlDatabase &connection, const QString &sql, const QVariantList &params,
+                              QList<PasswordEntry> &entries)
+{
+#ifdef PM_HAVE_SQLITE3_API
+    if (nativeReadsEnabled()) {
+        bool handled;
+        bool ok = queryPasswordsNative(connection, sql, params, entries, &handled);
+        if (handled) {
+            return ok;
+        }
+    }
+#endif
+
+    QSqlQuery query(connection);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    for (const QVariant &param : params) {
+        query.addBindValue(param);
+    }
+
+    if (!query.exec()) {
+        qDebug() << "查询密码失败:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        PasswordEntry entry;
+        entry.id = query.value(0).toInt();
+        entry.form_id = query.value(1).toInt();
+        entry.website = query.value(2).toString();
+        entry.username = query.value(3).toString();
+        entry.account = query.value(4).toString();
+        entry.password = query.value(5).toString();
+        entry.notes = query.value(6).toString();
+        entries.append(entry);
+    }
+    return true;
+}
+
+QList<PasswordEntry> SqliteBackend::getAllPasswords(int form_id)
+{
+    QList<PasswordEntry> entries;
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return entries;
+    }
+
+    bool ok;
+    if (form_id >= 0) {
+        // 查询指定表单的密码，按照添加顺序（ID递增）排序
+        ok = queryPasswords(db, "SELECT id, form_id, website, username, account, password, notes FROM passwords "
+                                "WHERE form_id = ? ORDER BY id ASC",
+                            QVariantList() << form_id, entries);
+    } else {
+        // 查询所有表单的密码，按照添加顺序（ID递增）排序
+        ok = queryPasswords(db, "SELECT id, form_id, website, username, account, password, notes FROM passwords "
+                                "ORDER BY id ASC",
+                            QVariantList(), entries);
+    }
+
+    if (!ok) {
+        qDebug() << "查询密码失败";
+    }
+    return entries;
+}
+
+QList<PasswordEntry> SqliteBackend::searchPasswords(const QString &keyword, const QList<int> &form_ids)
+{
+    QList<PasswordEntry> entries;
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return entries;
+    }
+
+    QString sql = "SELECT id, form_id, website, username, account, password, notes FROM passwords ";
+    QString whereClause = "WHERE (website LIKE ? OR username LIKE ? OR account LIKE ? OR notes LIKE ?) ";
+
+    QString pattern = "%" + keyword + "%";
+    QVariantList params;
+    params << pattern << pattern << pattern << pattern;
+
+    if (!form_ids.isEmpty()) {
+        // 构建IN子句
+        QStringList placeholders;
+        for (int formId : form_ids) {
+            placeholders.append("?");
+            params << formId;
+        }
+        whereClause += "AND form_id IN (" + placeholders.join(",") + ") ";
+    }
+
+    sql += whereClause + "ORDER BY id ASC";  // 修改：按照添加顺序排序
+
+    if (!queryPasswords(db, sql, params, entries)) {
+        qDebug() << "搜索密码失败";
+    }
+    return entries;
+}
+
+QList<PasswordEntry> SqliteBackend::getPasswordsByIds(const QList<int> &ids)
+{
+    QList<PasswordEntry> entries;
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return entries;
+    }
+
+    if (ids.isEmpty()) {
+        return entries;
+    }
+
+    // 先排序，保证分批查询后的整体结果仍按ID递增（与表格显示顺序一致）
+    QList<int> sortedIds = ids;
+    std::sort(sortedIds.begin(), sortedIds.end());
+
+    // SQLite默认最多999个绑定参数，分批构建IN子句
+    const int CHUNK_SIZE = 500;
+
+    for (int start = 0; start < sortedIds.size(); start += CHUNK_SIZE) {
+        int count = qMin(CHUNK_SIZE, sortedIds.size() - start);
+
+        QStringList placeholders;
+        for (int i = 0; i < count; ++i) {
+            placeholders.append("?");
+        }
+
+        QVariantList params;
+        for (int i = 0; i < count; ++i) {
+            params << sortedIds[start + i];
+        }
+
+        if (!queryPasswords(db, "SELECT id, form_id, website, username, account, password, notes FROM passwords "
+                                "WHERE id IN (" + placeholders.join(",") + ") ORDER BY id ASC",
+                            params, entries)) {
+            qDebug() << "按ID查询密码失败";
+            return entries;
+        }
+    }
+
+    return entries;
+}
+
+QList<PasswordEntry> SqliteBackend::getPasswordsAfter(int form_id, int afterId, int limit)
+{
+    QList<PasswordEntry> entries;
+
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return entries;
+    }
+
+    // 使用 id > ? 的游标分页，走主键索引，不会像OFFSET那样越翻越慢
+    bool ok;
+    if (form_id >= 0) {
+        ok = queryPasswords(db, "SELECT id, form_id, website, username, account, password, notes FROM passwords "
+                                "WHERE form_id = ? AND id > ? ORDER BY id ASC LIMIT ?",
+                            QVariantList() << form_id << afterId << limit, entries);
+    } else {
+        ok = queryPasswords(db, "SELECT id, form_id, website, username, account, password, notes FROM passwords "
+                                "WHERE id > ? ORDER BY id ASC LIMIT ?",
+                            QVariantList() << afterId << limit, entries);
+    }
+
+    if (!ok) {
+        qDebug() << "分页查询密码失败";
+    }
+    return entries;
+}
+
+int SqliteBackend::countPasswords(int form_id)
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开";
+        return 0;
+    }
+
+    QSqlQuery query(db);
+    if (form_id >= 0) {
+        query.prepare("SELECT COUNT(*) FROM passwords WHERE form_id = :form_id");
+        query.bindValue(":form_id", form_id);
+    } else {
+        query.prepare("SELECT COUNT(*) FROM passwords");
+    }
+
+    if (!query.exec() || !query.next()) {
+        qDebug() << "统计密码数量失败:" << query.lastError().text();
+        return 0;
+    }
+
+    return query.value(0).toInt();
+}
@@ -0,0 +1,66 @@
+#ifndef SQLITEBACKEND_H
+#define SQLITEBACKEND_H
+
+#include <QSqlDatabase>
+#include <QVariant>
+#include "storagebackend.h"
+
+// SQLite存储引擎：在给定的QSQLITE连接上执行SQL，表结构由Database::init()创建和迁移
+// 嵌套事务用SAVEPOINT实现
+class SqliteBackend : public StorageBackend
+{
+public:
+    explicit SqliteBackend(const QSqlDatabase &connection);
+
+    QSqlDatabase connection() const { return db; }
+    void setConnection(const QSqlDatabase &connection);  // 连接被重新打开后调用
+
+    bool isPersistent() const override { return true; }
+
+    bool addForm(const QString &name) override;
+    bool updateForm(int id, const QString &name) override;
+    bool deleteForm(int id) override;
+    QList<FormEntry> getAllForms() override;
+    QHash<int, FormStats> getFormStats() override;  // 读取form_stats，一次读取，与记录总数无关
+
+    bool addPassword(int form_id, const QString &website, const QString &username,
+                     const QString &account, const QString &password, const QString &notes) override;
+    bool updatePassword(int id, int form_id, const QString &website,
+                        const QString &username, const QString &account,
+                        const QString &password, const QString &notes) override;
+    // 用一条UPDATE完成，由UNIQUE约束拒绝冲突的修改，不预先查询
+    bool updateField(int id, EntryField field, const QString &value, bool *conflict = nullptr) override;
+    bool deletePassword(int id) override;
+    int deletePasswords(const QList<int> &ids) override;  // 在一个事务中分批删除
+    bool deletePasswordByWebsite(const QString &website) override;
+    // 整批用一条SQL完成；ReplaceConflicts先删除目标表单中的旧记录
+    int transferPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, bool copy,
+                          int *conflictCount) override;
+
+    QList<PasswordEntry> getAllPasswords(int form_id = -1) override;
+    QList<PasswordEntry> searchPasswords(const QString &keyword, const QList<int> &form_ids = QList<int>()) override;
+    QList<PasswordEntry> getPasswordsByIds(const QList<int> &ids) override;
+    QList<PasswordEntry> getPasswordsAfter(int form_id, int afterId, int limit) override;
+    int countPasswords(int form_id = -1) override;
+
+    int beginTransaction() override;
+    bool commitTransaction(int level) override;
+    void rollbackTransaction(int level) override;
+    int transactionDepth() const override { return m_transactionDepth; }
+
+    // 执行返回 id, form_id, website, username, account, password, notes 七列的查询，参数按?顺序绑定
+    static bool queryPasswords(const QSqlDatabase &connection, const QString &sql, const QVariantList &params,
+                               QList<PasswordEntry> &entries);
+
+    // 读取密码记录时直接使用SQLite C API（编译时启用PM_HAVE_SQLITE3_API才可用），默认开启
+    static void setNativeReads(bool enabled);
+    static bool nativeReadsEnabled();
+
+private:
+    bool fillBulkIds(const QList<int> &ids);
+
+    QSqlDatabase db;
+    int m_transactionDepth;  // 当前嵌套的事务层数
+};
+
+#endif // SQLITEBACKEND_H
@@ -0,0 +1,42 @@
+#include "startuptimer.h"
+#include <QDebug>
+
+bool StartupTimer::s_enabled = false;
+bool StartupTimer::s_finished = false;
+QElapsedTimer StartupTimer::s_timer;
+QList<QPair<QString, qint64>> StartupTimer::s_phases;
+
+void StartupTimer::start(bool enabled)
+{
+    s_enabled = enabled;
+    s_finished = false;
+    s_phases.clear();
+    s_timer.start();
+}
+
+void StartupTimer::mark(const QString &phase)
+{
+    if (!s_enabled || s_finished) {
+        return;
+    }
+    s_phases.append(qMakePair(phase, s_timer.nsecsElapsed()));
+}
+
+void StartupTimer::finish()
+{
+    if (!s_enabled || s_finished) {
+        return;
+    }
+    s_finished = true;
+
+    // 用qInfo输出，关闭调试输出时仍然可见
+    qint64 previous = 0;
+    for (const auto &phase : s_phases) {
+        qInfo().noquote() << QString("启动阶段 %1: %2 ms（累计 %3 ms）")
+                                 .arg(phase.first, -16)
+                                 .arg((phase.second - previous) / 1e6, 8, 'f', 2)
+                                 .arg(phase.second / 1e6, 0, 'f', 2);
+        previous = phase.second;
+    }
+    qInfo().noquote() << QString("启动总耗时: %1 ms").arg(s_timer.nsecsElapsed() / 1e6, 0, 'f', 2);
+}
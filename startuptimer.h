@@ -0,0 +1,26 @@
+#ifndef STARTUPTIMER_H
+#define STARTUPTIMER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+// 启动耗时统计：设置环境变量 PM_STARTUP_TIMING=1 或使用 --startup-timing 参数启用
+// 每个阶段记录距进程启动的时间，首个表单的记录全部显示后输出汇总
+class StartupTimer
+{
+public:
+    static void start(bool enabled);
+    static bool isEnabled() { return s_enabled; }
+    static void mark(const QString &phase);
+    static void finish();  // 只输出一次，之后的调用被忽略
+
+private:
+    static bool s_enabled;
+    static bool s_finished;
+    static QElapsedTimer s_timer;
+    static QList<QPair<QString, qint64>> s_phases;  // 阶段名称和结束时间（纳秒）
+};
+
+#endif // STARTUPTIMER_H
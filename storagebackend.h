@@ -0,0 +1,81 @@
+#ifndef STORAGEBACKEND_H
+#define STORAGEBACKEND_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+
+// 表单结构体
+struct FormEntry {
+    int id;
+    QString name;
+    QString created_at;
+};
+
+// 表单统计，由数据库触发器维护
+struct FormStats {
+    int formId;
+    int entryCount;
+    QString lastModified;
+};
+
+struct PasswordEntry {
+    int id;  // 新增：主键ID
+    int form_id;  // 新增：表单ID
+    QString website;
+    QString username;
+    QString account;  // 新增：账号字段
+    QString password;  // 加密后的
+    QString notes;
+};
+
+// 存储引擎接口：表单和密码记录的增删改查、搜索、按ID游标分页读取和事务
+// SqliteBackend保存在SQLite数据库中，MemoryBackend只保存在内存里（临时密码库、不含磁盘I/O的基准测试）
+// 账号和密码字段都是加密后的值，引擎本身不做加解密
+class StorageBackend
+{
+public:
+    virtual ~StorageBackend() {}
+
+    virtual bool isPersistent() const = 0;  // 数据是否保存到磁盘
+
+    // 表单
+    virtual bool addForm(const QString &name) = 0;  // 同名表单已存在时返回false
+    virtual bool updateForm(int id, const QString &name) = 0;
+    virtual bool deleteForm(int id) = 0;
+    virtual QList<FormEntry> getAllForms() = 0;  // 按名称排序
+    virtual QHash<int, FormStats> getFormStats() = 0;
+
+    // 密码记录；同一表单中网站、用户名和账号的组合唯一
+    virtual bool addPassword(int form_id, const QString &website, const QString &username,
+                             const QString &account, const QString &password, const QString &notes) = 0;
+    virtual bool updatePassword(int id, int form_id, const QString &website,
+                                const QString &username, const QString &account,
+                                const QString &password, const QString &notes) = 0;
+    enum EntryField { WebsiteField = 1, UsernameField, AccountField, PasswordField, NotesField };  // 与表格列号一致
+    virtual bool updateField(int id, EntryField field, const QString &value, bool *conflict = nullptr) = 0;
+    virtual bool deletePassword(int id) = 0;
+    virtual int deletePasswords(const QList<int> &ids) = 0;  // 返回删除的条数，失败返回-1（全部回滚）
+    virtual bool deletePasswordByWebsite(const QString &website) = 0;
+
+    // 批量移动（copy为false）或复制到另一个表单，返回移动/复制的条数，失败返回-1（全部回滚）
+    enum ConflictPolicy { SkipConflicts, ReplaceConflicts };
+    virtual int transferPasswords(const QList<int> &ids, int targetFormId, ConflictPolicy policy, bool copy,
+                                  int *conflictCount) = 0;
+
+    // 查询结果都按ID递增排序
+    virtual QList<PasswordEntry> getAllPasswords(int form_id = -1) = 0;  // -1 表示所有表单
+    virtual QList<PasswordEntry> searchPasswords(const QString &keyword, const QList<int> &form_ids = QList<int>()) = 0;
+    virtual QList<PasswordEntry> getPasswordsByIds(const QList<int> &ids) = 0;
+    virtual QList<PasswordEntry> getPasswordsAfter(int form_id, int afterId, int limit) = 0;  // 游标：id > afterId
+    virtual int countPasswords(int form_id = -1) = 0;
+
+    // 事务，可以嵌套；beginTransaction返回新事务的层级（0为最外层），失败返回-1
+    // commitTransaction和rollbackTransaction只能用于最内层的事务（level == transactionDepth() - 1）
+    virtual int beginTransaction() = 0;
+    virtual bool commitTransaction(int level) = 0;
+    virtual void rollbackTransaction(int level) = 0;
+    virtual int transactionDepth() const = 0;
+};
+
+#endif // STORAGEBACKEND_H
@@ -0,0 +1,95 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QTextStream>
+#include "database.h"
+#include "vaultgenerator.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("vaultgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("生成用于压力测试的合成密码库");
+    parser.addHelpOption();
+    QCommandLineOption rowsOption("rows", "密码记录数", "N");
+    QCommandLineOption formsOption("forms", "表单数（默认50）", "N", "50");
+    QCommandLineOption seedOption("seed", "随机种子（默认1）", "N", "1");
+    QCommandLineOption duplicateOption("duplicate-rate", "重复组合的比例（默认0.05）", "RATE", "0.05");
+    QCommandLineOption longNoteOption("long-note-rate", "长备注的比例（默认0.02）", "RATE", "0.02");
+    QCommandLineOption dbOption("db", "输出的数据库文件（默认passwords.db）", "FILE", "passwords.db");
+    QCommandLineOption csvOption("csv", "同时写出CSV文件（未保密版导出格式）", "FILE");
+    QCommandLineOption jsonlOption("jsonl", "同时写出JSON Lines文件", "FILE");
+    QCommandLineOption forceOption("force", "覆盖已存在的数据库文件");
+    parser.addOptions({ rowsOption, formsOption, seedOption, duplicateOption, longNoteOption,
+                        dbOption, csvOption, jsonlOption, forceOption });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    bool ok;
+    qint64 rows = parser.value(rowsOption).toLongLong(&ok);
+    if (!ok || rows <= 0) {
+        err << "请用 --rows 指定记录数" << Qt::endl;
+        return 2;
+    }
+
+    VaultGeneratorOptions options = VaultGenerator::defaultOptions(rows);
+    options.forms = parser.value(formsOption).toInt();
+    options.seed = parser.value(seedOption).toULongLong();
+    options.duplicateRate = parser.value(duplicateOption).toDouble();
+    options.longNoteRate = parser.value(longNoteOption).toDouble();
+    options.csvPath = parser.value(csvOption);
+    options.jsonlPath = parser.value(jsonlOption);
+
+    QString dbPath = parser.value(dbOption);
+    if (QFile::exists(dbPath)) {
+        if (!parser.isSet(forceOption)) {
+            err << "数据库文件已存在，使用 --force 覆盖: " << dbPath << Qt::endl;
+            return 2;
+        }
+        QFile::remove(dbPath);
+    }
+
+    // 用与程序相同的建表代码创建空库，保证表结构一致
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(dbPath);
+    if (!db.open()) {
+        err << "无法打开数据库: " << db.lastError().text() << Qt::endl;
+        return 1;
+    }
+    if (!Database::instance().init()) {
+        err << "创建数据库表失败" << Qt::endl;
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    VaultGenerator generator(options);
+    QString error;
+    bool success = generator.generate(db, [&out](qint64 done, qint64 total) {
+        out << QString("\r已生成 %1/%2").arg(done).arg(total) << Qt::flush;
+    }, &error);
+    out << Qt::endl;
+
+    if (!success) {
+        // 不留下不完整的数据库文件
+        db.close();
+        QFile::remove(dbPath);
+        err << error << Qt::endl;
+        return 1;
+    }
+
+    double seconds = timer.elapsed() / 1000.0;
+    out << QString("生成 %1 条记录、%2 个表单，用时 %3 秒（%4 条/秒）")
+               .arg(rows).arg(options.forms).arg(seconds, 0, 'f', 2)
+               .arg(seconds > 0 ? static_cast<qint64>(rows / seconds) : rows)
+        << Qt::endl;
+    return 0;
+}
@@ -0,0 +1,24 @@
+# 合成密码库生成工具：直接写出指定规模的passwords.db（可同时写出对应的CSV/JSON Lines）
+# 例：./vaultgen --rows 10000000 --db passwords.db --csv passwords.csv
+QT += core sql concurrent
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = vaultgen
+TEMPLATE = app
+
+# 每条记录都会经过Encryption::encrypt，关闭调试输出，避免上千万行日志拖慢生成
+DEFINES += QT_NO_DEBUG_OUTPUT
+
+include(../../core.pri)
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    ../vaultgenerator.cpp
+
+HEADERS += \
+    ../vaultgenerator.h
@@ -0,0 +1,402 @@
+#include "vaultgenerator.h"
+#include "encryption.h"
+#include "csvutils.h"
+#include "database.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QVector>
+#include <QFile>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+static const int BATCH_ROWS = 128;          // 每条INSERT语句的行数（7列×128 < SQLite默认的999个参数上限）
+static const int RECENT_ROWS = 1024;        // 生成重复组合时从最近的记录中挑选
+static const int PROGRESS_INTERVAL = 8192;  // 每生成多少条记录报告一次进度
+
+// SplitMix64伪随机数：实现简单、与平台和Qt版本无关，同一种子总是得到相同序列
+class SplitMix64
+{
+public:
+    explicit SplitMix64(quint64 seed) : m_state(seed) {}
+
+    quint64 next()
+    {
+        quint64 z = (m_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    int bounded(int limit) { return static_cast<int>(next() % static_cast<quint64>(limit)); }
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    bool chance(double probability) { return nextDouble() < probability; }
+
+private:
+    quint64 m_state;
+};
+
+// Zipf分布抽样表：排名越靠前的出现越频繁，与真实密码库中少数常用网站占多数的情况一致
+class ZipfTable
+{
+public:
+    ZipfTable(int count, double exponent)
+    {
+        m_cumulative.reserve(count);
+        double total = 0;
+        for (int rank = 1; rank <= count; ++rank) {
+            total += 1.0 / std::pow(rank, exponent);
+            m_cumulative.append(total);
+        }
+    }
+
+    int sample(SplitMix64 &random) const
+    {
+        double target = random.nextDouble() * m_cumulative.last();
+        auto it = std::upper_bound(m_cumulative.constBegin(), m_cumulative.constEnd(), target);
+        return qMin(static_cast<int>(it - m_cumulative.constBegin()), m_cumulative.size() - 1);
+    }
+
+private:
+    QVector<double> m_cumulative;
+};
+
+static const char *const POPULAR_SITES[] = {
+    "qq.com", "taobao.com", "github.com", "weibo.com", "jd.com", "baidu.com", "google.com",
+    "bilibili.com", "zhihu.com", "alipay.com", "163.com", "outlook.com", "apple.com",
+    "microsoft.com", "aliyun.com", "douban.com", "icloud.com", "amazon.com", "gitlab.com", "12306.cn"
+};
+static const char *const FORM_NAMES[] = {
+    "工作", "个人", "家庭", "财务", "社交", "购物", "游戏", "开发", "邮箱", "服务器"
+};
+static const char *const SURNAMES[] = {
+    "王", "李", "张", "刘", "陈", "杨", "黄", "赵", "吴", "周", "徐", "孙", "马", "朱", "胡", "郭"
+};
+static const char *const GIVEN_NAMES[] = {
+    "伟", "芳", "娜", "敏", "静", "丽", "强", "磊", "军", "洋", "勇", "艳", "杰", "娟", "涛", "明"
+};
+static const char *const NOTE_PHRASES[] = {
+    "公司内网账号，每九十天需要修改一次密码。",
+    "绑定的手机号已经更换，登录时注意验证码。",
+    "Security questions: first pet / city of birth.",
+    "共享给家里人使用，修改密码前先通知。",
+    "二次验证使用手机上的身份验证器应用。",
+    "旧账号，已迁移到新的邮箱地址。",
+    "VPN gateway credentials for the staging environment.",
+    "每月自动续费，取消前记得导出发票。",
+    "密保问题：小学名称、母亲的生日。",
+    "API token 存放在服务器的环境变量中。"
+};
+
+template <typename T, size_t N>
+static int arraySize(const T (&)[N]) { return static_cast<int>(N); }
+
+struct GeneratedRow {
+    int formId;
+    QString website;
+    QString username;
+    QString account;
+    QString password;
+    QString notes;
+};
+
+static QString siteName(int rank)
+{
+    if (rank < arraySize(POPULAR_SITES)) {
+        return QString::fromLatin1(POPULAR_SITES[rank]);
+    }
+    return rank % 2 ? QString("站点%1.cn").arg(rank) : QString("site%1.example.com").arg(rank);
+}
+
+static QString formName(int index)
+{
+    int count = arraySize(FORM_NAMES);
+    QString name = QString::fromUtf8(FORM_NAMES[index % count]);
+    return index < count ? name : QString("%1 %2").arg(name).arg(index / count + 1);
+}
+
+static QString randomUsername(SplitMix64 &random)
+{
+    if (random.chance(0.3)) {
+        return QString("user%1").arg(random.bounded(100000));
+    }
+    return QString::fromUtf8(SURNAMES[random.bounded(arraySize(SURNAMES))])
+           + QString::fromUtf8(GIVEN_NAMES[random.bounded(arraySize(GIVEN_NAMES))])
+           + (random.chance(0.5) ? QString::fromUtf8(GIVEN_NAMES[random.bounded(arraySize(GIVEN_NAMES))]) : QString());
+}
+
+static QString randomPassword(SplitMix64 &random)
+{
+    static const char CHARSET[] = "abcdefghijkmnpqrstuvwxyzABCDEFGHJKLMNPQRSTUVWXYZ23456789!@#$%^&*-_";
+    int length = 8 + random.bounded(13);
+    QString password;
+    password.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        password.append(QLatin1Char(CHARSET[random.bounded(static_cast<int>(sizeof(CHARSET)) - 1)]));
+    }
+    return password;
+}
+
+static QString randomNotes(SplitMix64 &random, double longNoteRate)
+{
+    // 约六成没有备注，其余为一句短备注或上百句的长备注
+    int phrases = 0;
+    if (random.chance(longNoteRate)) {
+        phrases = 20 + random.bounded(180);
+    } else if (random.chance(0.4)) {
+        phrases = 1;
+    }
+
+    QString notes;
+    for (int i = 0; i < phrases; ++i) {
+        notes += QString::fromUtf8(NOTE_PHRASES[random.bounded(arraySize(NOTE_PHRASES))]);
+        if (i + 1 < phrases && random.chance(0.2)) {
+            notes += '\n';
+        }
+    }
+    return notes;
+}
+
+VaultGenerator::VaultGenerator(const VaultGeneratorOptions &options)
+    : m_options(options)
+{
+}
+
+VaultGeneratorOptions VaultGenerator::defaultOptions(qint64 rows)
+{
+    VaultGeneratorOptions options;
+    options.rows = rows;
+    options.forms = 50;
+    options.seed = 1;
+    options.duplicateRate = 0.05;
+    options.longNoteRate = 0.02;
+    return options;
+}
+
+static QString insertSql(int rows)
+{
+    QStringList values;
+    for (int i = 0; i < rows; ++i) {
+        values.append("(?, ?, ?, ?, ?, ?, ?)");
+    }
+    return "INSERT INTO passwords (id, form_id, website, username, account, password, notes) VALUES "
+           + values.join(", ");
+}
+
+bool VaultGenerator::generate(QSqlDatabase db, const ProgressCallback &progress, QString *error)
+{
+    const qint64 rows = m_options.rows;
+    const int formCount = qMax(1, m_options.forms);
+    SplitMix64 random(m_options.seed);
+    ZipfTable sites(static_cast<int>(qBound<qint64>(100, rows / 50, 1000000)), 1.07);
+    ZipfTable forms(formCount, 0.8);
+
+    std::unique_ptr<QFile> csvFile;
+    std::unique_ptr<QFile> jsonlFile;
+    if (!m_options.csvPath.isEmpty()) {
+        csvFile.reset(new QFile(m_options.csvPath));
+        if (!csvFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            *error = QString("无法创建CSV文件: %1").arg(csvFile->errorString());
+            return false;
+        }
+        csvFile->write("\xEF\xBB\xBF");
+        csvFile->write("Website,Username,Account,Password,Notes\n");
+    }
+    if (!m_options.jsonlPath.isEmpty()) {
+        jsonlFile.reset(new QFile(m_options.jsonlPath));
+        if (!jsonlFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            *error = QString("无法创建JSON Lines文件: %1").arg(jsonlFile->errorString());
+            return false;
+        }
+    }
+
+    QSqlQuery query(db);
+    // 生成期间不需要崩溃保护，关闭日志和同步写盘
+    query.exec("PRAGMA journal_mode = OFF");
+    query.exec("PRAGMA synchronous = OFF");
+    query.exec("PRAGMA cache_size = -262144");
+    query.exec("PRAGMA temp_store = MEMORY");
+
+    // 先删除passwords表上的二级索引和统计触发器，数据写完后一次性重建，比逐条维护快得多
+    QStringList indexNames;
+    QStringList indexTypes;
+    QStringList indexSql;
+    query.exec("SELECT name, type, sql FROM sqlite_master "
+               "WHERE type IN ('index', 'trigger') AND tbl_name = 'passwords' AND sql IS NOT NULL");
+    while (query.next()) {
+        indexNames.append(query.value(0).toString());
+        indexTypes.append(query.value(1).toString());
+        indexSql.append(query.value(2).toString());
+    }
+    for (int i = 0; i < indexNames.size(); ++i) {
+        query.exec(QString("DROP %1 IF EXISTS \"%2\"").arg(indexTypes[i].toUpper(), indexNames[i]));
+    }
+
+    // 关闭日志后ROLLBACK不能撤销已写入的数据，失败时不依赖回滚：结束事务后清空已写入的表单和密码，
+    // 重建删除的索引和触发器并恢复日志模式，数据库回到结构完整的空库；写了一半的导出文件也删除
+    bool inTransaction = false;
+    auto fail = [&](const QString &message) {
+        *error = message;
+        qDebug() << "生成密码库失败:" << message;
+        if (inTransaction) {
+            db.rollback();
+            inTransaction = false;
+        }
+        QSqlQuery cleanup(db);
+        cleanup.exec("DELETE FROM passwords");
+        cleanup.exec("DELETE FROM forms");
+        for (const QString &sql : indexSql) {
+            cleanup.exec(sql);  // 已经重建过的会因为同名对象已存在而失败，忽略即可
+        }
+        if (db.tables().contains("form_stats")) {
+            Database::rebuildFormStats(db);
+        }
+        cleanup.exec("PRAGMA journal_mode = DELETE");
+        if (csvFile) {
+            csvFile->remove();
+        }
+        if (jsonlFile) {
+            jsonlFile->remove();
+        }
+        return false;
+    };
+
+    if (!db.transaction()) {
+        return fail(QString("无法开始事务: %1").arg(db.lastError().text()));
+    }
+    inTransaction = true;
+    query.exec("DELETE FROM passwords");
+    query.exec("DELETE FROM forms");
+
+    QStringList formNames;
+    query.prepare("INSERT INTO forms (id, name) VALUES (?, ?)");
+    for (int i = 0; i < formCount; ++i) {
+        formNames.append(formName(i));
+        query.addBindValue(i + 1);
+        query.addBindValue(formNames.last());
+        if (!query.exec()) {
+            return fail(QString("写入表单失败: %1").arg(query.lastError().text()));
+        }
+    }
+
+    QSqlQuery batchQuery(db);
+    batchQuery.prepare(insertSql(BATCH_ROWS));
+
+    QVector<GeneratedRow> recent;
+    recent.reserve(RECENT_ROWS);
+    QVector<GeneratedRow> batch;
+    batch.reserve(BATCH_ROWS);
+    qint64 nextId = 1;
+
+    while (nextId <= rows) {
+        batch.clear();
+        const qint64 firstId = nextId;
+        while (batch.size() < BATCH_ROWS && nextId <= rows) {
+            GeneratedRow row;
+            if (!recent.isEmpty() && random.chance(m_options.duplicateRate)) {
+                // 重复组合：同一网站和用户名再出现一次（常见于多个表单或多个账号），密码也相同
+                const GeneratedRow &source = recent.at(random.bounded(recent.size()));
+                row = source;
+                if (random.chance(0.5)) {
+                    row.formId = 1 + forms.sample(random);
+                }
+            } else {
+                row.formId = 1 + forms.sample(random);
+                row.website = siteName(sites.sample(random));
+                row.username = randomUsername(random);
+                row.password = randomPassword(random);
+            }
+            // 账号带上记录ID，保证满足(form_id, website, username, account)唯一约束
+            row.account = QString("acct%1@example.com").arg(nextId);
+            row.notes = randomNotes(random, m_options.longNoteRate);
+
+            if (recent.size() < RECENT_ROWS) {
+                recent.append(row);
+            } else {
+                recent[random.bounded(RECENT_ROWS)] = row;
+            }
+            batch.append(row);
+            nextId++;
+        }
+
+        QSqlQuery tailQuery(db);
+        QSqlQuery &insert = batch.size() == BATCH_ROWS ? batchQuery : tailQuery;
+        if (&insert == &tailQuery) {
+            tailQuery.prepare(insertSql(batch.size()));
+        }
+
+        QByteArray csvText;
+        QByteArray jsonlText;
+        for (int i = 0; i < batch.size(); ++i) {
+            const GeneratedRow &row = batch.at(i);
+            insert.addBindValue(firstId + i);
+            insert.addBindValue(row.formId);
+            insert.addBindValue(row.website);
+            insert.addBindValue(row.username);
+            insert.addBindValue(Encryption::encrypt(row.account));
+            insert.addBindValue(Encryption::encrypt(row.password));
+            insert.addBindValue(row.notes);
+
+            if (csvFile) {
+                csvText += (escapeCSVField(row.website) + ',' + escapeCSVField(row.username) + ','
+                            + escapeCSVField(row.account) + ',' + escapeCSVField(row.password) + ','
+                            + escapeCSVField(row.notes) + '\n').toUtf8();
+            }
+            if (jsonlFile) {
+                QJsonObject record;
+                record.insert("id", firstId + i);
+                record.insert("form_id", row.formId);
+                record.insert("form", formNames.at(row.formId - 1));
+                record.insert("website", row.website);
+                record.insert("username", row.username);
+                record.insert("account", row.account);
+                record.insert("password", row.password);
+                record.insert("notes", row.notes);
+                record.insert("encrypted", false);
+                jsonlText += QJsonDocument(record).toJson(QJsonDocument::Compact);
+                jsonlText += '\n';
+            }
+        }
+
+        if (!insert.exec()) {
+            return fail(QString("写入密码失败: %1").arg(insert.lastError().text()));
+        }
+        if (csvFile && csvFile->write(csvText) != csvText.size()) {
+            return fail(QString("写入CSV文件失败: %1").arg(csvFile->errorString()));
+        }
+        if (jsonlFile && jsonlFile->write(jsonlText) != jsonlText.size()) {
+            return fail(QString("写入JSON Lines文件失败: %1").arg(jsonlFile->errorString()));
+        }
+
+        if (progress && ((nextId - 1) % PROGRESS_INTERVAL < BATCH_ROWS || nextId > rows)) {
+            progress(nextId - 1, rows);
+        }
+    }
+
+    if (!db.commit()) {
+        return fail(QString("提交事务失败: %1").arg(db.lastError().text()));
+    }
+    inTransaction = false;
+
+    for (const QString &sql : indexSql) {
+        if (!query.exec(sql)) {
+            return fail(QString("重建索引失败: %1").arg(query.lastError().text()));
+        }
+    }
+    if (db.tables().contains("form_stats") && !Database::rebuildFormStats(db)) {
+        return fail("重建表单统计失败");
+    }
+    query.exec("PRAGMA journal_mode = DELETE");
+
+    if (csvFile && !csvFile->flush()) {
+        return fail(QString("写入CSV文件失败: %1").arg(csvFile->errorString()));
+    }
+    if (jsonlFile && !jsonlFile->flush()) {
+        return fail(QString("写入JSON Lines文件失败: %1").arg(jsonlFile->errorString()));
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef VAULTGENERATOR_H
+#define VAULTGENERATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <functional>
+
+// 生成测试用密码库的参数
+struct VaultGeneratorOptions {
+    qint64 rows;           // 密码记录数
+    int forms;             // 表单数
+    quint64 seed;          // 随机种子，相同参数和种子生成完全相同的数据
+    double duplicateRate;  // 重复使用已有网站/用户名/密码组合的比例
+    double longNoteRate;   // 长备注的比例
+    QString csvPath;       // 非空时同时写出与数据库内容一致的CSV（未保密版导出格式）
+    QString jsonlPath;     // 非空时同时写出JSON Lines（带表单名称）
+};
+
+// 合成密码库生成器：用批量SQL和固定种子的伪随机数直接写数据库，不经过界面导入
+// 数据特征接近真实使用：网站和表单按Zipf分布倾斜，含中文文本、长备注和重复组合
+class VaultGenerator
+{
+public:
+    typedef std::function<void(qint64 done, qint64 total)> ProgressCallback;
+
+    explicit VaultGenerator(const VaultGeneratorOptions &options);
+
+    static VaultGeneratorOptions defaultOptions(qint64 rows);
+
+    // 在已经建好表的连接上生成数据，原有的表单和密码会被清空；失败时留下结构完整的空库
+    bool generate(QSqlDatabase db, const ProgressCallback &progress, QString *error);
+
+private:
+    VaultGeneratorOptions m_options;
+};
+
+#endif // VAULTGENERATOR_H
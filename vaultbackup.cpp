@@ -0,0 +1,515 @@
+#include "vaultbackup.h"
+#include "database.h"
+#include "sqlitebackend.h"
+#include <QFile>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QtEndian>
+#include <QDebug>
+#ifdef PM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static const char FILE_MAGIC[8] = { 'P', 'M', 'V', 'A', 'U', 'L', 'T', '\0' };
+static const char INDEX_MAGIC[8] = { 'P', 'M', 'V', 'I', 'D', 'X', '\0', '\0' };
+static const int HEADER_SIZE = 32;
+static const int BLOCK_HEADER_SIZE = 13;
+static const int TRAILER_SIZE = 16;
+static const int INDEX_ENTRY_SIZE = 28;
+static const quint32 BLOCK_RECORDS = 4096;
+static const quint32 MAX_PAYLOAD_SIZE = 256 * 1024 * 1024;  // 防止损坏的长度字段导致超大内存分配
+
+static const quint16 FLAG_HAS_INDEX = 0x0001;
+
+enum BlockType {
+    FormsBlock = 1,
+    PasswordsBlock = 2,
+    IndexBlock = 3
+};
+
+// ---------- 编码 ----------
+
+static void putU8(QByteArray &out, quint8 value)
+{
+    out.append(static_cast<char>(value));
+}
+
+static void putU16(QByteArray &out, quint16 value)
+{
+    char buffer[2];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 2);
+}
+
+static void putU32(QByteArray &out, quint32 value)
+{
+    char buffer[4];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 4);
+}
+
+static void putU64(QByteArray &out, quint64 value)
+{
+    char buffer[8];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, 8);
+}
+
+static void putString(QByteArray &out, const QString &value)
+{
+    QByteArray utf8 = value.toUtf8();
+    putU32(out, static_cast<quint32>(utf8.size()));
+    out.append(utf8);
+}
+
+// CRC-32（与zlib的crc32相同，备份文件在有无zlib的构建之间通用）
+static quint32 checksum(const QByteArray &data)
+{
+#ifdef PM_HAVE_ZLIB
+    return static_cast<quint32>(crc32(0L, reinterpret_cast<const Bytef *>(data.constData()),
+                                      static_cast<uInt>(data.size())));
+#else
+    struct CrcTable {
+        quint32 entries[256];
+        CrcTable()
+        {
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                entries[i] = c;
+            }
+        }
+    };
+    static const CrcTable table;  // 局部静态变量的初始化是线程安全的
+    quint32 crc = 0xFFFFFFFFu;
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    for (int i = 0; i < data.size(); ++i) {
+        crc = table.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+#endif
+}
+
+static bool writeBlock(QFile &file, BlockType type, quint32 recordCount, const QByteArray &payload)
+{
+    QByteArray block;
+    block.reserve(BLOCK_HEADER_SIZE + payload.size());
+    putU8(block, static_cast<quint8>(type));
+    putU32(block, recordCount);
+    putU32(block, static_cast<quint32>(payload.size()));
+    putU32(block, checksum(payload));
+    block.append(payload);
+    return file.write(block) == block.size();
+}
+
+// ---------- 解码 ----------
+
+// 在负载范围内顺序读取字段，越界时置错误标志而不是越界访问
+class PayloadReader
+{
+public:
+    explicit PayloadReader(const QByteArray &data) : m_data(data), m_pos(0), m_ok(true) {}
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_pos >= m_data.size(); }
+
+    quint64 u64()
+    {
+        if (!require(8)) return 0;
+        quint64 value = qFromLittleEndian<quint64>(m_data.constData() + m_pos);
+        m_pos += 8;
+        return value;
+    }
+
+    QString string()
+    {
+        if (!require(4)) return QString();
+        quint32 size = qFromLittleEndian<quint32>(m_data.constData() + m_pos);
+        m_pos += 4;
+        if (!require(static_cast<qint64>(size))) return QString();
+        QString value = QString::fromUtf8(m_data.constData() + m_pos, static_cast<int>(size));
+        m_pos += static_cast<int>(size);
+        return value;
+    }
+
+private:
+    bool require(qint64 size)
+    {
+        if (!m_ok || m_pos + size > m_data.size()) {
+            m_ok = false;
+        }
+        return m_ok;
+    }
+
+    const QByteArray &m_data;
+    int m_pos;
+    bool m_ok;
+};
+
+static void setError(QString *error, const QString &message)
+{
+    if (error) {
+        *error = message;
+    }
+    qDebug() << "备份/恢复错误:" << message;
+}
+
+// ---------- 备份 ----------
+
+bool VaultBackup::backup(QSqlDatabase db, const QString &filename, bool writeIndex,
+                         const ProgressCallback &progress, QString *error)
+{
+    if (!db.isOpen()) {
+        setError(error, "数据库未打开");
+        return false;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        setError(error, QString("无法创建文件: %1").arg(file.errorString()));
+        return false;
+    }
+
+    // 在一个读事务中完成，保证表单和密码来自同一个一致的快照
+    SqliteBackend storage(db);
+    Database::Transaction transaction(&storage);
+    if (!transaction.isActive()) {
+        setError(error, QString("开始事务失败: %1").arg(db.lastError().text()));
+        file.close();
+        QFile::remove(filename);
+        return false;
+    }
+
+    QSqlQuery query(db);
+    quint64 formCount = 0;
+    quint64 passwordCount = 0;
+    if (query.exec("SELECT (SELECT COUNT(*) FROM forms), (SELECT COUNT(*) FROM passwords)") && query.next()) {
+        formCount = query.value(0).toULongLong();
+        passwordCount = query.value(1).toULongLong();
+    }
+
+    QByteArray header;
+    header.append(FILE_MAGIC, 8);
+    putU16(header, FORMAT_VERSION);
+    putU16(header, writeIndex ? FLAG_HAS_INDEX : 0);
+    putU32(header, BLOCK_RECORDS);
+    putU64(header, formCount);
+    putU64(header, passwordCount);
+
+    bool ok = file.write(header) == header.size();
+
+    // 表单数量很少，整体作为一个块写出
+    if (ok) {
+        QByteArray payload;
+        quint32 count = 0;
+        ok = query.exec("SELECT id, name, created_at FROM forms ORDER BY id ASC");
+        while (ok && query.next()) {
+            putU64(payload, static_cast<quint64>(query.value(0).toLongLong()));
+            putString(payload, query.value(1).toString());
+            putString(payload, query.value(2).toString());
+            count++;
+        }
+        ok = ok && writeBlock(file, FormsBlock, count, payload);
+    }
+
+    // 密码按ID游标分块读取，每块一次写出
+    QList<VaultBackupIndexEntry> index;
+    qint64 lastId = 0;
+    qint64 written = 0;
+    query.prepare("SELECT id, form_id, website, username, account, password, notes, created_at "
+                  "FROM passwords WHERE id > :after_id ORDER BY id ASC LIMIT :limit");
+
+    while (ok) {
+        query.bindValue(":after_id", lastId);
+        query.bindValue(":limit", BLOCK_RECORDS);
+        if (!query.exec()) {
+            setError(error, QString("读取密码失败: %1").arg(query.lastError().text()));
+            ok = false;
+            break;
+        }
+
+        QByteArray payload;
+        VaultBackupIndexEntry entry;
+        entry.offset = static_cast<quint64>(file.pos());
+        entry.recordCount = 0;
+        entry.firstId = 0;
+
+        while (query.next()) {
+            qint64 id = query.value(0).toLongLong();
+            if (entry.recordCount == 0) {
+                entry.firstId = id;
+            }
+            putU64(payload, static_cast<quint64>(id));
+            putU64(payload, static_cast<quint64>(query.value(1).toLongLong()));
+            for (int column = 2; column <= 7; ++column) {
+                putString(payload, query.value(column).toString());
+            }
+            lastId = id;
+            entry.recordCount++;
+        }
+
+        if (entry.recordCount == 0) {
+            break;
+        }
+
+        entry.lastId = lastId;
+        if (!writeBlock(file, PasswordsBlock, entry.recordCount, payload)) {
+            setError(error, QString("写入文件失败: %1").arg(file.errorString()));
+            ok = false;
+            break;
+        }
+        index.append(entry);
+
+        written += entry.recordCount;
+        if (progress && !progress(written, static_cast<qint64>(passwordCount))) {
+            setError(error, "操作已取消");
+            ok = false;
+        }
+    }
+
+    transaction.rollback();  // 只读事务，结束快照即可
+
+    // 定长索引放在文件末尾，文件尾记录索引位置，可以直接mmap后二分查找
+    if (ok && writeIndex) {
+        quint64 indexOffset = static_cast<quint64>(file.pos());
+        QByteArray payload;
+        payload.reserve(index.size() * INDEX_ENTRY_SIZE);
+        for (const auto &entry : index) {
+            putU64(payload, entry.offset);
+            putU64(payload, static_cast<quint64>(entry.firstId));
+            putU64(payload, static_cast<quint64>(entry.lastId));
+            putU32(payload, entry.recordCount);
+        }
+
+        QByteArray trailer;
+        putU64(trailer, indexOffset);
+        trailer.append(INDEX_MAGIC, 8);
+
+        ok = writeBlock(file, IndexBlock, static_cast<quint32>(index.size()), payload)
+             && file.write(trailer) == trailer.size();
+    }
+
+    if (ok && !file.flush()) {
+        ok = false;
+    }
+    if (!ok && error && error->isEmpty()) {
+        setError(error, QString("写入文件失败: %1").arg(file.errorString()));
+    }
+
+    file.close();
+    if (!ok) {
+        QFile::remove(filename);
+    }
+    return ok;
+}
+
+// ---------- 恢复 ----------
+
+bool VaultBackup::restore(QSqlDatabase db, const QString &filename,
+                          const ProgressCallback &progress, QString *error)
+{
+    if (!db.isOpen()) {
+        setError(error, "数据库未打开");
+        return false;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, QString("无法打开文件: %1").arg(file.errorString()));
+        return false;
+    }
+
+    QByteArray header = file.read(HEADER_SIZE);
+    if (header.size() != HEADER_SIZE || !header.startsWith(QByteArray(FILE_MAGIC, 8))) {
+        setError(error, "不是有效的密码库备份文件");
+        return false;
+    }
+
+    quint16 version = qFromLittleEndian<quint16>(header.constData() + 8);
+    if (version > FORMAT_VERSION) {
+        setError(error, QString("备份文件版本(%1)高于当前程序支持的版本(%2)").arg(version).arg(FORMAT_VERSION));
+        return false;
+    }
+    quint64 expectedForms = qFromLittleEndian<quint64>(header.constData() + 16);
+    quint64 expectedPasswords = qFromLittleEndian<quint64>(header.constData() + 24);
+    qint64 fileSize = file.size();
+
+    // 整个恢复在一个事务中完成：先清空，再用预编译语句直接批量插入
+    SqliteBackend storage(db);
+    Database::Transaction transaction(&storage);
+    if (!transaction.isActive()) {
+        setError(error, QString("开始事务失败: %1").arg(db.lastError().text()));
+        return false;
+    }
+
+    QSqlQuery query(db);
+    bool ok = query.exec("DELETE FROM passwords") && query.exec("DELETE FROM forms");
+    if (!ok) {
+        setError(error, QString("清空数据失败: %1").arg(query.lastError().text()));
+    }
+
+    QSqlQuery insertForm(db);
+    insertForm.prepare("INSERT INTO forms (id, name, created_at) VALUES (?, ?, ?)");
+    QSqlQuery insertPassword(db);
+    insertPassword.prepare("INSERT INTO passwords (id, form_id, website, username, account, password, notes, created_at) "
+                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+
+    quint64 restoredForms = 0;
+    quint64 restoredPasswords = 0;
+
+    while (ok) {
+        QByteArray blockHeader = file.read(BLOCK_HEADER_SIZE);
+        if (blockHeader.isEmpty()) {
+            break;  // 没有索引的文件在最后一个数据块后结束
+        }
+        if (blockHeader.size() != BLOCK_HEADER_SIZE) {
+            setError(error, "备份文件不完整");
+            ok = false;
+            break;
+        }
+
+        quint8 type = static_cast<quint8>(blockHeader.at(0));
+        quint32 recordCount = qFromLittleEndian<quint32>(blockHeader.constData() + 1);
+        quint32 payloadSize = qFromLittleEndian<quint32>(blockHeader.constData() + 5);
+        quint32 expectedCrc = qFromLittleEndian<quint32>(blockHeader.constData() + 9);
+
+        if (type == IndexBlock) {
+            break;  // 索引只用于定位，恢复时不需要
+        }
+        if (payloadSize > MAX_PAYLOAD_SIZE) {
+            setError(error, "备份文件数据块长度异常，文件可能已损坏");
+            ok = false;
+            break;
+        }
+
+        QByteArray payload = file.read(payloadSize);
+        if (payload.size() != static_cast<int>(payloadSize) || checksum(payload) != expectedCrc) {
+            setError(error, QString("备份文件数据块校验失败（偏移 %1），文件可能已损坏")
+                                .arg(file.pos() - payload.size() - BLOCK_HEADER_SIZE));
+            ok = false;
+            break;
+        }
+
+        PayloadReader reader(payload);
+        for (quint32 i = 0; ok && i < recordCount; ++i) {
+            if (type == FormsBlock) {
+                insertForm.addBindValue(static_cast<qint64>(reader.u64()));
+                insertForm.addBindValue(reader.string());
+                insertForm.addBindValue(reader.string());
+                ok = reader.ok() && insertForm.exec();
+                if (!ok && reader.ok()) {
+                    setError(error, QString("恢复表单失败: %1").arg(insertForm.lastError().text()));
+                }
+                restoredForms++;
+            } else if (type == PasswordsBlock) {
+                insertPassword.addBindValue(static_cast<qint64>(reader.u64()));
+                insertPassword.addBindValue(static_cast<qint64>(reader.u64()));
+                for (int column = 0; column < 6; ++column) {
+                    insertPassword.addBindValue(reader.string());
+                }
+                ok = reader.ok() && insertPassword.exec();
+                if (!ok && reader.ok()) {
+                    setError(error, QString("恢复密码失败: %1").arg(insertPassword.lastError().text()));
+                }
+                restoredPasswords++;
+            }
+        }
+
+        if (ok && (!reader.ok() || !reader.atEnd())) {
+            ok = false;
+        }
+        if (!ok && error && error->isEmpty()) {
+            setError(error, "备份文件记录格式错误");
+        }
+
+        if (ok && progress && !progress(file.pos(), fileSize)) {
+            setError(error, "操作已取消");
+            ok = false;
+        }
+    }
+
+    if (ok && (restoredForms != expectedForms || restoredPasswords != expectedPasswords)) {
+        setError(error, QString("备份文件记录数不符（表单 %1/%2，密码 %3/%4）")
+                            .arg(restoredForms).arg(expectedForms)
+                            .arg(restoredPasswords).arg(expectedPasswords));
+        ok = false;
+    }
+
+    if (ok) {
+        ok = transaction.commit();
+        if (!ok) {
+            setError(error, QString("提交事务失败: %1").arg(db.lastError().text()));
+        }
+    }
+    if (!ok) {
+        transaction.rollback();
+    }
+
+    qDebug() << "恢复完成:" << ok << "表单" << restoredForms << "密码" << restoredPasswords;
+    return ok;
+}
+
+bool VaultBackup::readIndex(const QString &filename, QList<VaultBackupIndexEntry> &index, QString *error)
+{
+    index.clear();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, QString("无法打开文件: %1").arg(file.errorString()));
+        return false;
+    }
+
+    QByteArray header = file.read(HEADER_SIZE);
+    if (header.size() != HEADER_SIZE || !header.startsWith(QByteArray(FILE_MAGIC, 8))) {
+        setError(error, "不是有效的密码库备份文件");
+        return false;
+    }
+    if (!(qFromLittleEndian<quint16>(header.constData() + 10) & FLAG_HAS_INDEX)) {
+        setError(error, "备份文件不含索引");
+        return false;
+    }
+
+    if (!file.seek(file.size() - TRAILER_SIZE)) {
+        setError(error, "备份文件不完整");
+        return false;
+    }
+    QByteArray trailer = file.read(TRAILER_SIZE);
+    if (trailer.size() != TRAILER_SIZE || trailer.mid(8) != QByteArray(INDEX_MAGIC, 8)) {
+        setError(error, "备份文件索引已损坏");
+        return false;
+    }
+
+    quint64 indexOffset = qFromLittleEndian<quint64>(trailer.constData());
+    if (!file.seek(static_cast<qint64>(indexOffset))) {
+        setError(error, "备份文件索引已损坏");
+        return false;
+    }
+
+    QByteArray blockHeader = file.read(BLOCK_HEADER_SIZE);
+    if (blockHeader.size() != BLOCK_HEADER_SIZE || static_cast<quint8>(blockHeader.at(0)) != IndexBlock) {
+        setError(error, "备份文件索引已损坏");
+        return false;
+    }
+    quint32 count = qFromLittleEndian<quint32>(blockHeader.constData() + 1);
+    quint32 payloadSize = qFromLittleEndian<quint32>(blockHeader.constData() + 5);
+    QByteArray payload = file.read(payloadSize);
+    if (payloadSize != count * INDEX_ENTRY_SIZE || payload.size() != static_cast<int>(payloadSize)
+        || checksum(payload) != qFromLittleEndian<quint32>(blockHeader.constData() + 9)) {
+        setError(error, "备份文件索引校验失败");
+        return false;
+    }
+
+    const char *data = payload.constData();
+    for (quint32 i = 0; i < count; ++i, data += INDEX_ENTRY_SIZE) {
+        VaultBackupIndexEntry entry;
+        entry.offset = qFromLittleEndian<quint64>(data);
+        entry.firstId = static_cast<qint64>(qFromLittleEndian<quint64>(data + 8));
+        entry.lastId = static_cast<qint64>(qFromLittleEndian<quint64>(data + 16));
+        entry.recordCount = qFromLittleEndian<quint32>(data + 24);
+        index.append(entry);
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef VAULTBACKUP_H
+#define VAULTBACKUP_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QList>
+#include <functional>
+
+// 二进制备份文件格式（所有整数均为小端序）：
+//
+//   文件头（32字节）：
+//     magic[8] = "PMVAULT\0"，quint16 版本号，quint16 标志位（bit0：含索引），
+//     quint32 每块最大记录数，quint64 表单数，quint64 密码数
+//   数据块（重复）：
+//     quint8 类型，quint32 记录数，quint32 负载长度，quint32 负载CRC32，负载
+//     表单记录：qint64 id，字符串 name，字符串 created_at
+//     密码记录：qint64 id，qint64 form_id，字符串 website/username/account/password/notes/created_at
+//     字符串 = quint32 UTF-8字节数 + UTF-8字节
+//   索引块（可选，类型为索引）：每个密码块一条定长记录
+//     quint64 块在文件中的偏移，qint64 首条记录ID，qint64 末条记录ID，quint32 记录数
+//   文件尾（仅含索引时，16字节）：quint64 索引块偏移，magic[8] = "PMVIDX\0\0"
+//
+// 账号和密码按数据库中的加密形式原样保存，恢复时不做解密/加密
+struct VaultBackupIndexEntry {
+    quint64 offset;
+    qint64 firstId;
+    qint64 lastId;
+    quint32 recordCount;
+};
+
+class VaultBackup
+{
+public:
+    // 进度回调：已处理量、总量，返回false表示取消
+    typedef std::function<bool(qint64 done, qint64 total)> ProgressCallback;
+
+    static const quint16 FORMAT_VERSION = 1;
+
+    static bool backup(QSqlDatabase db, const QString &filename, bool writeIndex,
+                       const ProgressCallback &progress, QString *error);
+    // 用备份文件替换当前所有表单和密码，任何错误都会回滚整个恢复过程
+    static bool restore(QSqlDatabase db, const QString &filename,
+                        const ProgressCallback &progress, QString *error);
+    // 读取文件尾部的块索引，便于按ID直接定位数据块
+    static bool readIndex(const QString &filename, QList<VaultBackupIndexEntry> &index, QString *error);
+};
+
+#endif // VAULTBACKUP_H